@@ -1,27 +1,13 @@
-#include <QMutex>
 #include <QObject>
 #include <QThreadPool>
 
+#include "HexDump.h"
+
 namespace dispar {
 
 class Section;
 
-class AddrHexAsciiEncoderTask : public QObject, public QRunnable {
-  Q_OBJECT
-
-public:
-  AddrHexAsciiEncoderTask(const QByteArray &data, quint64 address, quint64 index, quint64 size);
-
-  void run() override;
-
-signals:
-  void result(quint64 index, const QString &data);
-
-private:
-  const QByteArray &data;
-  const quint64 address, index, size;
-};
-
+/// Renders the data of a section as a hex dump, optionally in the background.
 class AddrHexAsciiEncoder : public QObject {
   Q_OBJECT
 
@@ -31,25 +17,19 @@ public:
   void start(bool blocking = false);
   QString result() const;
 
+  /// Lines of the result, so they don't have to be parsed.
+  [[nodiscard]] const HexDump &dump() const;
+
 signals:
   void finished();
 
-private slots:
-  void addResult(quint64 index, const QString &result);
-
 private:
   const Section *section;
 
+  HexDump dump_;
+
+  /// Declared last so it's destroyed first, which waits for rendering into dump_ to finish.
   QThreadPool pool;
-  QString result_;
-  int tasks = 0;
-
-  struct Result {
-    quint64 index;
-    QString data;
-  };
-  QList<Result> results;
-  QMutex mutex;
 };
 
 } // namespace dispar
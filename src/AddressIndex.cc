@@ -0,0 +1,122 @@
+#include "AddressIndex.h"
+#include "BinaryObject.h"
+#include "Section.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace dispar {
+
+namespace {
+
+/// Position of the closest value at or before \p value in sorted \p values.
+std::optional<size_t> atOrBefore(const std::vector<quint64> &values, quint64 value)
+{
+  const auto it = std::upper_bound(values.cbegin(), values.cend(), value);
+  if (it == values.cbegin()) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(std::distance(values.cbegin(), it) - 1);
+}
+
+} // namespace
+
+AddressIndex::AddressIndex(const BinaryObject &object)
+{
+  // Split the address space at every section boundary and let the smallest section containing an
+  // interval own it.
+  const auto sections = object.sections();
+  std::vector<quint64> bounds;
+  for (const auto *section : sections) {
+    if (section->size() == 0) continue;
+    bounds.push_back(section->address());
+    bounds.push_back(section->address() +
+                     std::min(section->size(), std::numeric_limits<quint64>::max() -
+                                                 section->address()));
+  }
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+  for (size_t i = 0; i < bounds.size(); i++) {
+    const Section *owner = nullptr;
+    if (i + 1 < bounds.size()) {
+      for (const auto *section : sections) {
+        if (section->size() > 0 && section->hasAddress(bounds[i]) &&
+            (owner == nullptr || section->size() < owner->size())) {
+          owner = section;
+        }
+      }
+    }
+    if (!sectionOwners.empty() && sectionOwners.back() == owner) continue;
+    sectionStarts.push_back(bounds[i]);
+    sectionOwners.push_back(owner);
+  }
+
+  // Named symbols ordered by address, where the first of the symbol table wins over later ones.
+  std::vector<const SymbolEntry *> symbols;
+  for (const auto *table : {&object.symbolTable(), &object.dynSymbolTable()}) {
+    for (const auto &symbol : table->symbols()) {
+      if (!symbol.string().isEmpty()) {
+        symbols.push_back(&symbol);
+      }
+    }
+  }
+  std::stable_sort(symbols.begin(), symbols.end(),
+                   [](const auto *a, const auto *b) { return a->value() < b->value(); });
+  symbolAddresses.reserve(symbols.size());
+  symbolNames.reserve(symbols.size());
+  for (const auto *symbol : symbols) {
+    if (!symbolAddresses.empty() && symbolAddresses.back() == symbol->value()) continue;
+    symbolAddresses.push_back(symbol->value());
+    symbolNames.push_back(symbol->string());
+  }
+
+  functionStarts = object.functionStarts();
+}
+
+const Section *AddressIndex::section(quint64 address) const
+{
+  const auto pos = atOrBefore(sectionStarts, address);
+  return pos ? sectionOwners[*pos] : nullptr;
+}
+
+std::optional<QString> AddressIndex::symbol(quint64 address) const
+{
+  const auto it = std::lower_bound(symbolAddresses.cbegin(), symbolAddresses.cend(), address);
+  if (it == symbolAddresses.cend() || *it != address) {
+    return std::nullopt;
+  }
+  return symbolNames[std::distance(symbolAddresses.cbegin(), it)];
+}
+
+std::optional<quint64> AddressIndex::symbolAtOrBefore(quint64 address) const
+{
+  const auto pos = atOrBefore(symbolAddresses, address);
+  return pos ? std::optional<quint64>(symbolAddresses[*pos]) : std::nullopt;
+}
+
+std::optional<quint64> AddressIndex::functionStart(quint64 address) const
+{
+  const auto pos = atOrBefore(functionStarts, address);
+  return pos ? std::optional<quint64>(functionStarts[*pos]) : std::nullopt;
+}
+
+std::vector<quint64> AddressIndex::starts(quint64 begin, quint64 end) const
+{
+  const auto range = [begin, end](const std::vector<quint64> &values) {
+    return std::make_pair(std::lower_bound(values.cbegin(), values.cend(), begin),
+                          std::lower_bound(values.cbegin(), values.cend(), end));
+  };
+  const auto symbols = range(symbolAddresses);
+  const auto functions = range(functionStarts);
+
+  std::vector<quint64> res;
+  res.reserve(std::distance(symbols.first, symbols.second) +
+              std::distance(functions.first, functions.second));
+  std::set_union(symbols.first, symbols.second, functions.first, functions.second,
+                 std::back_inserter(res));
+  return res;
+}
+
+} // namespace dispar
@@ -0,0 +1,51 @@
+#ifndef DISPAR_ADDRESS_INDEX_H
+#define DISPAR_ADDRESS_INDEX_H
+
+#include <QString>
+
+#include <optional>
+#include <vector>
+
+namespace dispar {
+
+class BinaryObject;
+class Section;
+
+/// Immutable index of the sections, symbols, and function starts of a binary object by address.
+/** Each kind is kept in its own sorted array of addresses, next to an array of what they map to,
+    such that lookups are binary searches over contiguous addresses only. Overlapping sections, like
+    segments containing sections, are split into disjoint intervals of the innermost section. */
+class AddressIndex {
+public:
+  AddressIndex(const BinaryObject &object);
+
+  /// Innermost section containing \p address.
+  /** Returns \p nullptr if no section contains it. */
+  [[nodiscard]] const Section *section(quint64 address) const;
+
+  /// Name of the symbol at exactly \p address, preferring the symbol table over the dynamic one.
+  [[nodiscard]] std::optional<QString> symbol(quint64 address) const;
+
+  /// Address of the closest symbol at or before \p address.
+  [[nodiscard]] std::optional<quint64> symbolAtOrBefore(quint64 address) const;
+
+  /// Start of the function containing \p address, which is the closest start at or before it.
+  [[nodiscard]] std::optional<quint64> functionStart(quint64 address) const;
+
+  /// Addresses of symbols and function starts in [\p begin, \p end), sorted and without duplicates.
+  /** They are known to start instructions if in code. */
+  [[nodiscard]] std::vector<quint64> starts(quint64 begin, quint64 end) const;
+
+private:
+  std::vector<quint64> sectionStarts;
+  std::vector<const Section *> sectionOwners; ///< nullptr for gaps between sections.
+
+  std::vector<quint64> symbolAddresses;
+  std::vector<QString> symbolNames;
+
+  std::vector<quint64> functionStarts;
+};
+
+} // namespace dispar
+
+#endif // DISPAR_ADDRESS_INDEX_H
@@ -0,0 +1,385 @@
+#include "AnalysisCache.h"
+#include "BinaryObject.h"
+#include "MappedFile.h"
+#include "Reader.h"
+#include "cxx.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <optional>
+
+namespace dispar {
+
+namespace {
+
+constexpr char magic[] = "DISPARC"; // Including null terminator.
+constexpr quint32 version = 3; // Segments only cover what no other section does since 3.
+
+// Sizes of the records of the cache file.
+constexpr qint64 headerSize = 64;
+constexpr qint64 sectionSize = 40;
+constexpr qint64 symbolSize = 16;
+constexpr qint64 demangledSize = 8;
+
+void putUInt32(QByteArray &dest, quint32 value)
+{
+  const auto le = qToLittleEndian(value);
+  dest.append(reinterpret_cast<const char *>(&le), sizeof(le)); // NOLINT
+}
+
+void putUInt64(QByteArray &dest, quint64 value)
+{
+  const auto le = qToLittleEndian(value);
+  dest.append(reinterpret_cast<const char *>(&le), sizeof(le)); // NOLINT
+}
+
+/// Pool of unique strings, each stored as its size followed by the UTF-8 bytes.
+class StringPool {
+public:
+  /// Adds \p str, if not already present, and returns its offset in the pool.
+  quint32 add(const QString &str)
+  {
+    const auto it = offsets.constFind(str);
+    if (it != offsets.constEnd()) {
+      return it.value();
+    }
+
+    const auto offset = static_cast<quint32>(data_.size());
+    const auto utf8 = str.toUtf8();
+    putUInt32(data_, static_cast<quint32>(utf8.size()));
+    data_.append(utf8);
+    offsets.insert(str, offset);
+    return offset;
+  }
+
+  [[nodiscard]] const QByteArray &data() const
+  {
+    return data_;
+  }
+
+private:
+  QByteArray data_;
+  QHash<QString, quint32> offsets;
+};
+
+/// Reads a string of the string pool at \p offset.
+/** Returns std::nullopt if outside the pool. */
+std::optional<QString> poolString(const Reader::LittleRecord &pool, quint32 offset)
+{
+  if (qint64(offset) + 4 > pool.size()) {
+    return std::nullopt;
+  }
+  const auto size = pool.get<quint32>(offset);
+  if (qint64(offset) + 4 + size > pool.size()) {
+    return std::nullopt;
+  }
+  return QString::fromUtf8(pool.bytes(offset + 4, static_cast<int>(size)));
+}
+
+} // namespace
+
+AnalysisCache::AnalysisCache(const QString &dir, qint64 maxSize) : dir_(dir), maxSize_(maxSize)
+{
+}
+
+QString AnalysisCache::defaultDir()
+{
+  return QDir::home().absoluteFilePath(".dispar.cache");
+}
+
+QString AnalysisCache::dir() const
+{
+  return dir_;
+}
+
+qint64 AnalysisCache::maxSize() const
+{
+  return maxSize_;
+}
+
+QString AnalysisCache::path(const QByteArray &fingerprint, quint64 offset) const
+{
+  return QDir(dir_).absoluteFilePath(
+    QString("%1-%2.cache").arg(QString::fromLatin1(fingerprint)).arg(offset, 0, 16));
+}
+
+bool AnalysisCache::contains(const QByteArray &fingerprint, quint64 offset) const
+{
+  return !fingerprint.isEmpty() && QFile::exists(path(fingerprint, offset));
+}
+
+std::unique_ptr<BinaryObject>
+AnalysisCache::load(const QByteArray &fingerprint, quint64 offset,
+                    const std::shared_ptr<const MappedFile> &mapping) const
+{
+  if (!contains(fingerprint, offset)) {
+    return nullptr;
+  }
+
+  const auto filePath = path(fingerprint, offset);
+  const auto file = MappedFile::open(filePath);
+  if (!file) {
+    return nullptr;
+  }
+
+  // Mark as recently used so it is evicted last.
+  QFile touched(filePath);
+  if (touched.open(QIODevice::ReadWrite)) {
+    touched.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+  }
+
+  Reader r(*file);
+
+  Reader::LittleRecord header;
+  if (!r.getRecord(headerSize, header)) return nullptr;
+  if (header.bytes(0, sizeof(magic)) != QByteArray(magic, sizeof(magic)) ||
+      header.get<quint32>(8) != version) {
+    qWarning() << "Invalid analysis cache:" << file->fileName();
+    return nullptr;
+  }
+
+  // Enum values are trusted by the rest of the code, so reject any the enums don't define.
+  const auto cpuType = header.get<quint32>(12);
+  const auto cpuSubType = header.get<quint32>(16);
+  const auto endianness = header.get<quint32>(20);
+  const auto fileType = header.get<quint32>(28);
+  if (cpuType > quint32(CpuType::XEON_MP) || cpuSubType > quint32(CpuType::XEON_MP) ||
+      endianness > quint32(Constants::Endianness::Big) || fileType > quint32(FileType::BUNDLE)) {
+    qWarning() << "Invalid analysis cache:" << file->fileName();
+    return nullptr;
+  }
+
+  auto object = std::make_unique<BinaryObject>(
+    static_cast<CpuType>(cpuType), static_cast<CpuType>(cpuSubType),
+    static_cast<Constants::Endianness>(endianness), static_cast<int>(header.get<quint32>(24)),
+    static_cast<FileType>(fileType));
+
+  // Set bits again in case the CPU type implied something else.
+  object->setSystemBits(static_cast<int>(header.get<quint32>(24)));
+
+  const auto nsections = header.get<quint32>(32);
+  const auto nsymbols = header.get<quint32>(36);
+  const auto ndynsymbols = header.get<quint32>(40);
+  const auto ndemangled = header.get<quint32>(44);
+  const auto stringsSize = header.get<quint32>(48);
+  const auto noffsets = header.get<quint32>(52);
+  const auto nfunctionStarts = header.get<quint32>(56);
+
+  // Read all tables before the string pool at the end.
+  Reader::LittleRecord sections, symbols, dynsymbols, demangled;
+  if (!r.getRecord(qint64(nsections) * sectionSize, sections) ||
+      !r.getRecord(qint64(nsymbols) * symbolSize, symbols) ||
+      !r.getRecord(qint64(ndynsymbols) * symbolSize, dynsymbols) ||
+      !r.getRecord(qint64(ndemangled) * demangledSize, demangled)) {
+    return nullptr;
+  }
+
+  bool ok = false;
+  const auto offsets = r.getUInt32Array(noffsets, &ok);
+  if (!ok) return nullptr;
+
+  auto functionStarts = r.getUInt64Array(nfunctionStarts, &ok);
+  if (!ok) return nullptr;
+
+  Reader::LittleRecord pool;
+  if (!r.getRecord(stringsSize, pool)) return nullptr;
+
+  for (quint32 i = 0; i < nsections; i++) {
+    const auto base = qint64(i) * sectionSize;
+    const auto name = poolString(pool, sections.get<quint32>(base + 4));
+    const auto type = sections.get<quint32>(base);
+    const auto size = sections.get<quint64>(base + 16);
+    const auto sectionOffset = sections.get<quint32>(base + 24);
+    const auto firstOffset = sections.get<quint32>(base + 28);
+    const auto numOffsets = sections.get<quint32>(base + 32);
+    if (!name || type > quint32(Section::Type::SEGMENT) ||
+        qint64(firstOffset) + numOffsets > qint64(offsets.size())) {
+      qWarning() << "Invalid analysis cache:" << file->fileName();
+      return nullptr;
+    }
+
+    // Flags: mapped (1).
+    const bool mapped = (sections.get<quint32>(base + 36) & 1) != 0;
+    if (mapped && (!mapping || size > quint64(mapping->size()) ||
+                   sectionOffset > quint64(mapping->size()) - size)) {
+      qWarning() << "Invalid analysis cache:" << file->fileName();
+      return nullptr;
+    }
+
+    auto section = std::make_unique<Section>(static_cast<Section::Type>(type), *name,
+                                             sections.get<quint64>(base + 8), size, sectionOffset);
+    if (mapped) {
+      section->mapData(mapping);
+    }
+
+    if (numOffsets > 0) {
+      const auto begin = offsets.cbegin() + firstOffset;
+      section->setInstructionOffsets(std::vector<quint32>(begin, begin + numOffsets));
+    }
+
+    object->addSection(std::move(section));
+  }
+
+  const auto readSymbols = [&pool](const Reader::LittleRecord &records, quint32 num,
+                                   SymbolTable &table) {
+    auto &entries = table.symbols();
+    entries.reserve(num);
+    for (quint32 i = 0; i < num; i++) {
+      const auto base = qint64(i) * symbolSize;
+      const auto str = poolString(pool, records.get<quint32>(base + 4));
+      if (!str) return false;
+      entries.emplace_back(records.get<quint32>(base), records.get<quint64>(base + 8), *str);
+    }
+    return true;
+  };
+
+  SymbolTable symTable, dynsymTable;
+  if (!readSymbols(symbols, nsymbols, symTable) ||
+      !readSymbols(dynsymbols, ndynsymbols, dynsymTable)) {
+    return nullptr;
+  }
+  object->setSymbolTable(std::move(symTable));
+  object->setDynSymbolTable(std::move(dynsymTable));
+
+  QHash<QString, QString> demangledNames;
+  demangledNames.reserve(static_cast<int>(ndemangled));
+  for (quint32 i = 0; i < ndemangled; i++) {
+    const auto base = qint64(i) * demangledSize;
+    const auto mangled = poolString(pool, demangled.get<quint32>(base));
+    const auto name = poolString(pool, demangled.get<quint32>(base + 4));
+    if (!mangled || !name) return nullptr;
+    demangledNames.insert(*mangled, *name);
+  }
+  object->setDemangledNames(std::move(demangledNames));
+  object->setFunctionStarts(std::move(functionStarts));
+
+  return object;
+}
+
+bool AnalysisCache::store(const QByteArray &fingerprint, quint64 offset,
+                          const BinaryObject &object) const
+{
+  if (fingerprint.isEmpty()) {
+    return false;
+  }
+
+  const auto sections = object.sections();
+  if (cxx::any_of(sections, [](const auto *section) { return section->isModified(); })) {
+    return false;
+  }
+
+  StringPool strings;
+  QByteArray sectionData, symbolData, dynsymbolData, demangledData, offsetData, functionStartData;
+
+  quint32 numOffsets = 0;
+  for (const auto *section : sections) {
+    // Prefer the offsets of the actual disassembly.
+    std::vector<quint32> offsets;
+    if (const auto *disasm = section->disassembly(); disasm != nullptr) {
+      offsets.reserve(disasm->count());
+      for (std::size_t i = 0; i < disasm->count(); i++) {
+        offsets.push_back(disasm->offset(i));
+      }
+    }
+    else {
+      offsets = section->instructionOffsets();
+    }
+
+    putUInt32(sectionData, static_cast<quint32>(section->type()));
+    putUInt32(sectionData, strings.add(section->name()));
+    putUInt64(sectionData, section->address());
+    putUInt64(sectionData, section->size());
+    putUInt32(sectionData, section->offset());
+    putUInt32(sectionData, numOffsets);
+    putUInt32(sectionData, static_cast<quint32>(offsets.size()));
+    putUInt32(sectionData, section->isMapped() ? 1 : 0);
+
+    for (const auto off : offsets) {
+      putUInt32(offsetData, off);
+    }
+    numOffsets += static_cast<quint32>(offsets.size());
+  }
+
+  const auto writeSymbols = [&strings](const SymbolTable &table, QByteArray &dest) {
+    for (const auto &symbol : table.symbols()) {
+      putUInt32(dest, symbol.index());
+      putUInt32(dest, strings.add(symbol.string()));
+      putUInt64(dest, symbol.value());
+    }
+  };
+  writeSymbols(object.symbolTable(), symbolData);
+  writeSymbols(object.dynSymbolTable(), dynsymbolData);
+
+  const auto &demangledNames = object.demangledNames();
+  for (auto it = demangledNames.cbegin(); it != demangledNames.cend(); ++it) {
+    putUInt32(demangledData, strings.add(it.key()));
+    putUInt32(demangledData, strings.add(it.value()));
+  }
+
+  const auto &functionStarts = object.functionStarts();
+  for (const auto start : functionStarts) {
+    putUInt64(functionStartData, start);
+  }
+
+  QByteArray header(magic, sizeof(magic));
+  putUInt32(header, version);
+  putUInt32(header, static_cast<quint32>(object.cpuType()));
+  putUInt32(header, static_cast<quint32>(object.cpuSubType()));
+  putUInt32(header, static_cast<quint32>(object.endianness()));
+  putUInt32(header, static_cast<quint32>(object.systemBits()));
+  putUInt32(header, static_cast<quint32>(object.fileType()));
+  putUInt32(header, static_cast<quint32>(sections.size()));
+  putUInt32(header, static_cast<quint32>(object.symbolTable().symbols().size()));
+  putUInt32(header, static_cast<quint32>(object.dynSymbolTable().symbols().size()));
+  putUInt32(header, static_cast<quint32>(demangledNames.size()));
+  putUInt32(header, static_cast<quint32>(strings.data().size()));
+  putUInt32(header, numOffsets);
+  putUInt32(header, static_cast<quint32>(functionStarts.size()));
+  header.append(headerSize - header.size(), '\0'); // Reserved.
+
+  if (!QDir().mkpath(dir_)) {
+    qWarning() << "Could not create analysis cache directory:" << dir_;
+    return false;
+  }
+
+  // Write to a temporary file that replaces the cache file when done, such that readers never see
+  // partial files.
+  QSaveFile file(path(fingerprint, offset));
+  if (!file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  for (const auto *data : {&header, &sectionData, &symbolData, &dynsymbolData, &demangledData,
+                           &offsetData, &functionStartData, &strings.data()}) {
+    if (file.write(*data) != data->size()) {
+      file.cancelWriting();
+      return false;
+    }
+  }
+  if (!file.commit()) {
+    return false;
+  }
+
+  evict();
+  return true;
+}
+
+void AnalysisCache::evict() const
+{
+  // Most recently used first.
+  const auto files = QDir(dir_).entryInfoList({"*.cache"}, QDir::Files, QDir::Time);
+  qint64 total = 0;
+  for (const auto &info : files) {
+    total += info.size();
+    if (total > maxSize_) {
+      qDebug() << "Evicting analysis cache:" << info.fileName();
+      QFile::remove(info.absoluteFilePath());
+    }
+  }
+}
+
+} // namespace dispar
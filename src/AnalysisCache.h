@@ -0,0 +1,64 @@
+#ifndef DISPAR_ANALYSIS_CACHE_H
+#define DISPAR_ANALYSIS_CACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+
+#include "Constants.h"
+
+namespace dispar {
+
+class BinaryObject;
+class MappedFile;
+
+/// On-disk cache of parsed and analyzed binary objects keyed by the fingerprint of the binary.
+/** Each object is stored in its own file of fixed-size little-endian records followed by a string
+    pool, such that it is read directly from a mapping of the cache file. It contains the section
+    table, symbol tables, demangled names, function starts, and instruction offsets of disassembled
+    sections. Section data isn't stored but deferred to the mapping of the binary itself when
+    loading.
+
+    The total size of the cache files is kept within a maximum by removing the least recently used
+    files when storing, where loading a file marks it as used. */
+class AnalysisCache {
+public:
+  /// \p maxSize is in bytes.
+  AnalysisCache(const QString &dir, qint64 maxSize = defaultMaxSize);
+
+  static constexpr qint64 defaultMaxSize = qint64(Constants::Cache::DEFAULT_MAX_SIZE) << 20;
+
+  /// Default cache directory: ~/.dispar.cache
+  static QString defaultDir();
+
+  [[nodiscard]] QString dir() const;
+  [[nodiscard]] qint64 maxSize() const;
+
+  /// Path of the cache file of the object at \p offset of the binary with \p fingerprint.
+  [[nodiscard]] QString path(const QByteArray &fingerprint, quint64 offset) const;
+
+  [[nodiscard]] bool contains(const QByteArray &fingerprint, quint64 offset) const;
+
+  /// Loads the object at \p offset of the binary with \p fingerprint.
+  /** Data of sections is deferred to \p mapping of the binary. Returns nullptr if not cached or the
+      cache file is invalid. */
+  [[nodiscard]] std::unique_ptr<BinaryObject>
+  load(const QByteArray &fingerprint, quint64 offset,
+       const std::shared_ptr<const MappedFile> &mapping) const;
+
+  /// Stores \p object found at \p offset of the binary with \p fingerprint.
+  /** Objects with modified sections aren't stored since they no longer match the binary. */
+  bool store(const QByteArray &fingerprint, quint64 offset, const BinaryObject &object) const;
+
+  /// Removes the least recently used cache files until their total size is within the maximum.
+  void evict() const;
+
+private:
+  QString dir_;
+  qint64 maxSize_;
+};
+
+} // namespace dispar
+
+#endif // DISPAR_ANALYSIS_CACHE_H
@@ -1,8 +1,14 @@
 #include "BinaryObject.h"
 #include "Constants.h"
 #include "CpuType.h"
+#include "Util.h"
 #include "cxx.h"
 
+#include <QSet>
+
+#include <algorithm>
+#include <iterator>
+
 namespace dispar {
 
 BinaryObject::BinaryObject(CpuType cpuType, CpuType cpuSubType, Constants::Endianness endianness_,
@@ -120,16 +126,19 @@ Section *BinaryObject::section(Section::Type type) const
 void BinaryObject::addSection(std::unique_ptr<Section> section)
 {
   sections_.emplace_back(std::move(section));
+  invalidateAddressIndex();
 }
 
 void BinaryObject::setSymbolTable(const SymbolTable &table)
 {
   symTable = table;
+  invalidateAddressIndex();
 }
 
 void BinaryObject::setSymbolTable(SymbolTable &&table)
 {
   symTable = std::move(table);
+  invalidateAddressIndex();
 }
 
 const SymbolTable &BinaryObject::symbolTable() const
@@ -140,11 +149,13 @@ const SymbolTable &BinaryObject::symbolTable() const
 void BinaryObject::setDynSymbolTable(const SymbolTable &table)
 {
   dynsymTable = table;
+  invalidateAddressIndex();
 }
 
 void BinaryObject::setDynSymbolTable(SymbolTable &&table)
 {
   dynsymTable = std::move(table);
+  invalidateAddressIndex();
 }
 
 const SymbolTable &BinaryObject::dynSymbolTable() const
@@ -152,4 +163,107 @@ const SymbolTable &BinaryObject::dynSymbolTable() const
   return dynsymTable;
 }
 
+void BinaryObject::setDemangledNames(QHash<QString, QString> names)
+{
+  demangledNames_ = std::move(names);
+}
+
+const QHash<QString, QString> &BinaryObject::demangledNames() const
+{
+  return demangledNames_;
+}
+
+void BinaryObject::demangleSymbols()
+{
+  std::vector<QString> names;
+  QSet<QString> seen;
+  for (const auto *table : {&symTable, &dynsymTable}) {
+    for (const auto &symbol : table->symbols()) {
+      const auto &name = symbol.string();
+      if (name.isEmpty() || demangledNames_.contains(name) || seen.contains(name)) continue;
+      seen.insert(name);
+      names.push_back(name);
+    }
+  }
+  if (names.empty()) return;
+
+  const auto demangled = Util::demangleAll(names);
+  demangledNames_.reserve(demangledNames_.size() + static_cast<int>(names.size()));
+  for (std::size_t i = 0; i < names.size(); i++) {
+    demangledNames_.insert(names[i], demangled[i]);
+  }
+}
+
+QString BinaryObject::demangledName(const QString &name) const
+{
+  const auto it = demangledNames_.constFind(name);
+  return it != demangledNames_.cend() ? *it : Util::demangle(name);
+}
+
+void BinaryObject::setFunctionStarts(std::vector<quint64> starts)
+{
+  std::sort(starts.begin(), starts.end());
+  starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+  functionStarts_ = std::move(starts);
+  invalidateAddressIndex();
+}
+
+const std::vector<quint64> &BinaryObject::functionStarts() const
+{
+  return functionStarts_;
+}
+
+std::optional<quint64> BinaryObject::functionStart(quint64 address) const
+{
+  const auto it = std::upper_bound(functionStarts_.cbegin(), functionStarts_.cend(), address);
+  if (it == functionStarts_.cbegin()) {
+    return std::nullopt;
+  }
+  return *std::prev(it);
+}
+
+std::shared_ptr<const AddressIndex> BinaryObject::addressIndex() const
+{
+  QMutexLocker locker(&addressIndexMutex);
+  if (!addressIndex_) {
+    addressIndex_ = std::make_shared<const AddressIndex>(*this);
+  }
+  return addressIndex_;
+}
+
+void BinaryObject::invalidateAddressIndex()
+{
+  QMutexLocker locker(&addressIndexMutex);
+  addressIndex_.reset();
+}
+
+QList<Section *> BinaryObject::reuseAnalysis(BinaryObject &previous)
+{
+  QList<Section *> changed;
+  const auto previousSections = previous.sections();
+  for (auto &section : sections_) {
+    const auto match = cxx::find_if(previousSections, [&section](const auto *prev) {
+      return prev->type() == section->type() && prev->name() == section->name() &&
+             prev->address() == section->address() && prev->size() == section->size();
+    });
+    if (match == previousSections.cend() || (*match)->disassembly() == nullptr ||
+        (*match)->isModified() || (*match)->hash() != section->hash()) {
+      changed << section.get();
+      continue;
+    }
+
+    if (!section->disassembly()) {
+      section->setDisassembly((*match)->takeDisassembly());
+    }
+  }
+
+  for (auto it = previous.demangledNames_.cbegin(); it != previous.demangledNames_.cend(); ++it) {
+    if (!demangledNames_.contains(it.key())) {
+      demangledNames_.insert(it.key(), it.value());
+    }
+  }
+
+  return changed;
+}
+
 } // namespace dispar
@@ -1,11 +1,16 @@
 #ifndef DISPAR_BINARY_OBJECT_H
 #define DISPAR_BINARY_OBJECT_H
 
+#include <QHash>
 #include <QList>
+#include <QMutex>
+#include <QString>
 
 #include <memory>
+#include <optional>
 #include <vector>
 
+#include "AddressIndex.h"
 #include "Constants.h"
 #include "CpuType.h"
 #include "FileType.h"
@@ -57,13 +62,54 @@ public:
   void setDynSymbolTable(SymbolTable &&table);
   [[nodiscard]] const SymbolTable &dynSymbolTable() const;
 
+  /// Demangled names of symbols keyed by their mangled names.
+  void setDemangledNames(QHash<QString, QString> names);
+  [[nodiscard]] const QHash<QString, QString> &demangledNames() const;
+
+  /// Demangles the names of both symbol tables that aren't known yet, concurrently.
+  void demangleSymbols();
+
+  /// Demangled \p name, which is only demangled now if not known already.
+  [[nodiscard]] QString demangledName(const QString &name) const;
+
+  /// Addresses where functions start, like those of LC_FUNCTION_STARTS, even if stripped.
+  /** They are sorted and duplicates are removed. */
+  void setFunctionStarts(std::vector<quint64> starts);
+  [[nodiscard]] const std::vector<quint64> &functionStarts() const;
+
+  /// Start of the function containing \p address, which is the closest start at or before it.
+  /** Returns std::nullopt if no function starts before \p address. */
+  [[nodiscard]] std::optional<quint64> functionStart(quint64 address) const;
+
+  /// Index of sections, symbols, and function starts by address.
+  /** It is built on first use and rebuilt after any of them change, while those already returned
+      stay valid as they are. */
+  [[nodiscard]] std::shared_ptr<const AddressIndex> addressIndex() const;
+
+  /// Moves analysis of \p previous, a prior version of this object, that still applies.
+  /** Sections are matched by type, name, address, and size, and the disassembly of a matched
+      section is moved if their hashes are equal. Hashes are of the data in the file, so those of
+      \p previous must have been computed before the file changed, and modified sections of
+      \p previous aren't reused since their disassembly no longer matches the file. Only
+      sections with disassembly to move are hashed. Known demangled names are copied, too.
+
+      Returns the sections that changed, are new, or had nothing to reuse. */
+  QList<Section *> reuseAnalysis(BinaryObject &previous);
+
 private:
+  void invalidateAddressIndex();
+
   CpuType cpuType_, cpuSubType_;
   Constants::Endianness endianness_;
   int systemBits_;
   FileType fileType_;
   std::vector<std::unique_ptr<Section>> sections_;
   SymbolTable symTable, dynsymTable;
+  QHash<QString, QString> demangledNames_;
+  std::vector<quint64> functionStarts_;
+
+  mutable QMutex addressIndexMutex;
+  mutable std::shared_ptr<const AddressIndex> addressIndex_;
 };
 
 } // namespace dispar
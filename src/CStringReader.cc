@@ -1,53 +1,41 @@
 #include "CStringReader.h"
 
 #include <QByteArray>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
 
 namespace dispar {
 
-CStringReader::CStringReader(const QByteArray &data_) : data(data_), pos(0), offset_(0)
+bool CStringReader::Entry::operator==(const Entry &rhs) const
 {
+  return offset == rhs.offset && size == rhs.size;
 }
 
-bool CStringReader::next()
+CStringReader::CStringReader(const QByteArray &data_) : data(data_)
 {
-  // Clear when trying to read next string, and jump over the \0.
-  if (!string_.isEmpty()) {
-    string_.clear();
-    pos++;
-    offset_ = pos;
-  }
-
-  // Don't change `auto it` into `const auto *it` because it would yield
-  // cppcoreguidelines-pro-bounds-pointer-arithmetic wrt `it++` in the for-loop beneath.
-  // NOLINTNEXTLINE(readability-qualified-auto)
-  auto it = data.cbegin() + offset_;
-  if (it >= data.cend()) return false;
-
-  // Read until null byte but skip for empty strings until at least one character is read or the end
-  // is reached.
-  for (; it != data.cend(); it++, pos++) {
-    const auto ch = *it;
-    if (ch == 0) {
-      if (!string_.isEmpty()) {
-        break;
-      }
-    }
-    else {
-      string_ += ch;
-    }
-  }
+}
 
-  return !string_.isEmpty();
+bool CStringReader::next()
+{
+  // Continue after the null terminator of the previous string, if any.
+  const auto pos = entry.size > 0 ? entry.offset + entry.size + 1 : entry.offset;
+  entry = find(data, static_cast<int>(std::min<quint32>(pos, data.size())), data.size());
+  return entry.size > 0;
 }
 
 QString CStringReader::string() const
 {
-  return string_;
+  return string(data, entry);
 }
 
 quint64 CStringReader::offset() const
 {
-  return offset_;
+  return entry.offset;
 }
 
 QStringList CStringReader::readAll()
@@ -59,4 +47,87 @@ QStringList CStringReader::readAll()
   return res;
 }
 
+std::vector<CStringReader::Entry> CStringReader::scan(const QByteArray &data)
+{
+  const auto size = data.size();
+  const int threads = QThread::idealThreadCount();
+
+  // Split into chunks right after null bytes, so no string crosses chunks.
+  const auto chunkSize = std::max(minChunkSize, size / (std::max(threads, 1) * 4));
+  std::vector<std::pair<int, int>> chunks; // [start, end)
+  int start = 0;
+  while (size - start >= 2 * chunkSize) {
+    const auto *nul = static_cast<const char *>(
+      std::memchr(data.constData() + start + chunkSize, 0, size - start - chunkSize)); // NOLINT
+    if (nul == nullptr) break;
+    const auto end = static_cast<int>(nul - data.constData()) + 1;
+    chunks.emplace_back(start, end);
+    start = end;
+  }
+  chunks.emplace_back(start, size);
+
+  std::vector<std::vector<Entry>> results(chunks.size());
+  std::atomic_size_t next{0};
+  const auto work = [&data, &chunks, &results, &next] {
+    for (auto i = next++; i < chunks.size(); i = next++) {
+      auto [pos, end] = chunks[i];
+      for (auto entry = find(data, pos, end); entry.size > 0;
+           entry = find(data, static_cast<int>(entry.offset + entry.size), end)) {
+        results[i].push_back(entry);
+      }
+    }
+  };
+
+  if (chunks.size() == 1 || threads < 2) {
+    work();
+  }
+  else {
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::min(threads, static_cast<int>(chunks.size())));
+    for (int i = 0; i < pool.maxThreadCount(); i++) {
+      pool.start(work);
+    }
+    pool.waitForDone();
+  }
+
+  std::vector<Entry> res;
+  if (results.size() == 1) {
+    res = std::move(results.front());
+  }
+  else {
+    size_t count = 0;
+    for (const auto &result : results) {
+      count += result.size();
+    }
+    res.reserve(count);
+    for (const auto &result : results) {
+      res.insert(res.end(), result.cbegin(), result.cend());
+    }
+  }
+  return res;
+}
+
+QString CStringReader::string(const QByteArray &data, const Entry &entry)
+{
+  return QString::fromLatin1(data.constData() + entry.offset, // NOLINT
+                             static_cast<int>(entry.size));
+}
+
+CStringReader::Entry CStringReader::find(const QByteArray &data, int pos, int end)
+{
+  const auto *bytes = data.constData();
+
+  // Skip null bytes of empty strings and padding.
+  while (pos < end && bytes[pos] == 0) { // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    pos++;
+  }
+  if (pos >= end) {
+    return {static_cast<quint32>(end), 0};
+  }
+
+  const auto *nul = static_cast<const char *>(std::memchr(bytes + pos, 0, end - pos)); // NOLINT
+  const auto stringEnd = nul != nullptr ? static_cast<int>(nul - bytes) : end;
+  return {static_cast<quint32>(pos), static_cast<quint32>(stringEnd - pos)};
+}
+
 } // namespace dispar
@@ -4,12 +4,26 @@
 #include <QString>
 #include <QStringList>
 
+#include <vector>
+
 class QByteArray;
 
 namespace dispar {
 
+/// Reads null-terminated strings of a data block, skipping empty ones.
+/** Strings are located with memchr() and only converted from Latin-1 when retrieved. */
 class CStringReader {
 public:
+  /// Location of a string in the data block, excluding the null terminator.
+  struct Entry {
+    quint32 offset = 0, size = 0;
+
+    bool operator==(const Entry &rhs) const;
+  };
+
+  /// Data blocks smaller than this are always scanned by one thread.
+  static constexpr int minChunkSize = 256 * 1024;
+
   CStringReader(const QByteArray &data);
 
   /// Tries to read a string.
@@ -24,11 +38,19 @@ public:
   /// Read all strings of data.
   QStringList readAll();
 
+  /// Locates all strings of \p data, where large data is split into chunks scanned concurrently.
+  static std::vector<Entry> scan(const QByteArray &data);
+
+  /// String of \p entry in \p data.
+  static QString string(const QByteArray &data, const Entry &entry);
+
 private:
+  /// Locates the first string in [\p pos, \p end) of \p data.
+  /** Returns an entry of size 0 if there are none. */
+  static Entry find(const QByteArray &data, int pos, int end);
+
   const QByteArray &data;
-  int pos;
-  QString string_;
-  quint64 offset_;
+  Entry entry;
 };
 
 } // namespace dispar
@@ -21,6 +21,46 @@ static const int MAX_LIMIT = 100000;
 
 } // namespace Omni
 
+namespace Strings {
+
+/// Characters that runs of printable characters need to be extracted as strings.
+static constexpr int DEFAULT_MIN_LENGTH = 4;
+static constexpr int MIN_MIN_LENGTH = 2;
+static constexpr int MAX_MIN_LENGTH = 256;
+
+/// Strings extracted outside of string sections that are listed at most.
+static constexpr int MAX_EXTRACTED = 100000;
+
+/// Extracted strings added to the list at a time, so the UI stays responsive meanwhile.
+static constexpr int EXTRACTED_BATCH = 5000;
+
+} // namespace Strings
+
+namespace Disassembly {
+
+/// Code sections larger than this are disassembled while scrolling, if enabled.
+static constexpr int LAZY_THRESHOLD = 1024 * 1024;
+
+/// Bytes of code decoded at a time when disassembling lazily.
+static constexpr int WINDOW_SIZE = 16 * 1024;
+
+/// Decoded windows kept in memory, and shown in the binary view, per section.
+static constexpr int CACHED_WINDOWS = 64;
+
+/// Windows decoded ahead of what is shown.
+static constexpr int READ_AHEAD_WINDOWS = 2;
+
+} // namespace Disassembly
+
+namespace Cache {
+
+/// Maximum total size of the analysis cache in MB.
+static constexpr int DEFAULT_MAX_SIZE = 512;
+static constexpr int MIN_MAX_SIZE = 16;
+static constexpr int MAX_MAX_SIZE = 64 * 1024;
+
+} // namespace Cache
+
 namespace Log {
 
 enum {
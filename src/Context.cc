@@ -1,5 +1,7 @@
 #include "Context.h"
+#include "AnalysisCache.h"
 #include "Constants.h"
+#include "DisassemblerPool.h"
 #include "Project.h"
 #include "cxx.h"
 #include "formats/Format.h"
@@ -33,7 +35,7 @@ bool initialized = false;
 
 Context::Context()
   : showMachineCode_(true), disassemblerSyntax_(Disassembler::Syntax::INTEL), backupEnabled_(true),
-    backupAmount_(5), project_(nullptr)
+    backupAmount_(5), project_(nullptr), disassemblerPool_(std::make_unique<DisassemblerPool>())
 {
   ASSERT_X(!instance, "Only one Context can be live at any one time");
   instance = this;
@@ -67,6 +69,7 @@ void Context::init()
 
   logHandler_ = std::make_unique<LogHandler>(*this);
   loadSettings();
+  setAnalysisCacheMaxSize(analysisCacheMaxSize_);
 }
 
 void Context::setVerbose(bool verbose)
@@ -100,7 +103,21 @@ Disassembler::Syntax Context::disassemblerSyntax() const
 
 void Context::setDisassemblerSyntax(Disassembler::Syntax syntax)
 {
+  bool changed = (syntax != disassemblerSyntax_);
   disassemblerSyntax_ = syntax;
+  if (changed) {
+    emit disassemblerSyntaxChanged(syntax);
+  }
+}
+
+bool Context::lazyDisassembly() const
+{
+  return lazyDisassembly_;
+}
+
+void Context::setLazyDisassembly(bool lazy)
+{
+  lazyDisassembly_ = lazy;
 }
 
 bool Context::backupEnabled() const
@@ -223,6 +240,10 @@ void Context::loadSettings()
       obj["disassemblerSyntax"].toInt(static_cast<int>(Disassembler::Syntax::INTEL)));
   }
 
+  if (obj.contains("lazyDisassembly")) {
+    lazyDisassembly_ = obj["lazyDisassembly"].toBool(true);
+  }
+
   if (obj.contains("backup")) {
     const auto backupValue = obj["backup"];
     if (backupValue.isObject()) {
@@ -314,6 +335,48 @@ void Context::loadSettings()
       }
     }
   }
+
+  if (obj.contains("analysisCache")) {
+    const auto cacheValue = obj["analysisCache"];
+    if (cacheValue.isObject()) {
+      const auto cacheObj = cacheValue.toObject();
+      if (cacheObj.contains("enabled")) {
+        analysisCacheEnabled_ = cacheObj["enabled"].toBool(true);
+      }
+
+      if (cacheObj.contains("maxSize")) {
+        using namespace Constants::Cache;
+        const int size = cacheObj["maxSize"].toInt(DEFAULT_MAX_SIZE);
+        if (size >= MIN_MAX_SIZE && size <= MAX_MAX_SIZE) {
+          analysisCacheMaxSize_ = size;
+        }
+      }
+    }
+  }
+
+  if (obj.contains("strings")) {
+    const auto stringsValue = obj["strings"];
+    if (stringsValue.isObject()) {
+      const auto stringsObj = stringsValue.toObject();
+
+      if (stringsObj.contains("minLength")) {
+        using namespace Constants::Strings;
+        const int length = stringsObj["minLength"].toInt(DEFAULT_MIN_LENGTH);
+        if (length >= MIN_MIN_LENGTH && length <= MAX_MIN_LENGTH) {
+          stringsMinLength_ = length;
+        }
+      }
+
+      if (stringsObj.contains("encodings")) {
+        stringsEncodings_ = StringExtractor::Encodings(stringsObj["encodings"].toInt(
+          static_cast<int>(StringExtractor::Encoding::ASCII)));
+      }
+
+      if (stringsObj.contains("scanFile")) {
+        stringsScanFile_ = stringsObj["scanFile"].toBool(false);
+      }
+    }
+  }
 }
 
 void Context::saveSettings()
@@ -339,15 +402,27 @@ void Context::saveSettings()
   QJsonObject omni;
   omni["limit"] = omniSearchLimit_;
 
+  QJsonObject strings;
+  strings["minLength"] = stringsMinLength_;
+  strings["encodings"] = static_cast<int>(stringsEncodings_);
+  strings["scanFile"] = stringsScanFile_;
+
+  QJsonObject cacheObj;
+  cacheObj["enabled"] = analysisCacheEnabled_;
+  cacheObj["maxSize"] = analysisCacheMaxSize_;
+
   QJsonObject obj;
   obj["showMachineCode"] = showMachineCode();
   obj["disassemblerSyntax"] = static_cast<int>(disassemblerSyntax());
+  obj["lazyDisassembly"] = lazyDisassembly();
   obj["backup"] = backupObj;
   obj["recent"] = recentObj;
   obj["values"] = QJsonValue::fromVariant(values);
   obj["debugger"] = debuggerObj;
   obj["logLevel"] = logLevel_;
   obj["omni"] = omni;
+  obj["strings"] = strings;
+  obj["analysisCache"] = cacheObj;
 
   QJsonDocument doc;
   doc.setObject(obj);
@@ -419,4 +494,65 @@ void Context::setOmniSearchLimit(int limit)
   omniSearchLimit_ = limit;
 }
 
+int Context::stringsMinLength() const
+{
+  return stringsMinLength_;
+}
+
+void Context::setStringsMinLength(int length)
+{
+  stringsMinLength_ = length;
+}
+
+StringExtractor::Encodings Context::stringsEncodings() const
+{
+  return stringsEncodings_;
+}
+
+void Context::setStringsEncodings(StringExtractor::Encodings encodings)
+{
+  stringsEncodings_ = encodings;
+}
+
+bool Context::stringsScanFile() const
+{
+  return stringsScanFile_;
+}
+
+void Context::setStringsScanFile(bool scan)
+{
+  stringsScanFile_ = scan;
+}
+
+std::shared_ptr<const AnalysisCache> Context::analysisCache() const
+{
+  return analysisCacheEnabled_ ? analysisCache_ : nullptr;
+}
+
+bool Context::analysisCacheEnabled() const
+{
+  return analysisCacheEnabled_;
+}
+
+void Context::setAnalysisCacheEnabled(bool enabled)
+{
+  analysisCacheEnabled_ = enabled;
+}
+
+int Context::analysisCacheMaxSize() const
+{
+  return analysisCacheMaxSize_;
+}
+
+void Context::setAnalysisCacheMaxSize(int size)
+{
+  analysisCacheMaxSize_ = size;
+  analysisCache_ = std::make_shared<AnalysisCache>(AnalysisCache::defaultDir(), qint64(size) << 20);
+}
+
+DisassemblerPool &Context::disassemblerPool() const
+{
+  return *disassemblerPool_;
+}
+
 } // namespace dispar
@@ -11,9 +11,12 @@
 #include "Debugger.h"
 #include "Disassembler.h"
 #include "LogHandler.h"
+#include "StringExtractor.h"
 
 namespace dispar {
 
+class AnalysisCache;
+class DisassemblerPool;
 class Project;
 
 /// It is required to create an instance once in the beginning of the program.
@@ -47,6 +50,10 @@ public:
   [[nodiscard]] Disassembler::Syntax disassemblerSyntax() const;
   void setDisassemblerSyntax(Disassembler::Syntax syntax);
 
+  /// Whether large code sections are disassembled while scrolling instead of up front.
+  [[nodiscard]] bool lazyDisassembly() const;
+  void setLazyDisassembly(bool lazy);
+
   [[nodiscard]] bool backupEnabled() const;
   void setBackupEnabled(bool enabled);
 
@@ -89,8 +96,36 @@ public:
   [[nodiscard]] int omniSearchLimit() const;
   void setOmniSearchLimit(int limit);
 
+  /// Characters needed for runs to be extracted as strings outside of string sections.
+  [[nodiscard]] int stringsMinLength() const;
+  void setStringsMinLength(int length);
+
+  /// Encodings of strings extracted outside of string sections.
+  [[nodiscard]] StringExtractor::Encodings stringsEncodings() const;
+  void setStringsEncodings(StringExtractor::Encodings encodings);
+
+  /// Whether strings are extracted from the whole binary object as mapped from the file, instead of
+  /// only from the data of its sections.
+  [[nodiscard]] bool stringsScanFile() const;
+  void setStringsScanFile(bool scan);
+
+  /// Cache of analyzed binary objects, or nullptr if disabled.
+  [[nodiscard]] std::shared_ptr<const AnalysisCache> analysisCache() const;
+
+  [[nodiscard]] bool analysisCacheEnabled() const;
+  void setAnalysisCacheEnabled(bool enabled);
+
+  /// Maximum total size of the analysis cache in MB.
+  [[nodiscard]] int analysisCacheMaxSize() const;
+  void setAnalysisCacheMaxSize(int size);
+
+  /// Disassemblers to reuse instead of opening new ones.
+  /** Keeps ownership. */
+  [[nodiscard]] DisassemblerPool &disassemblerPool() const;
+
 signals:
   void showMachineCodeChanged(bool show);
+  void disassemblerSyntaxChanged(Disassembler::Syntax syntax);
   void logLevelChanged(int newLevel);
 
 private:
@@ -98,6 +133,7 @@ private:
 
   bool showMachineCode_;
   Disassembler::Syntax disassemblerSyntax_;
+  bool lazyDisassembly_ = true;
 
   bool backupEnabled_;
   int backupAmount_;
@@ -110,8 +146,17 @@ private:
   int logLevel_ = Constants::Log::DEFAULT_LEVEL;
   int omniSearchLimit_ = Constants::Omni::DEFAULT_LIMIT;
 
+  int stringsMinLength_ = Constants::Strings::DEFAULT_MIN_LENGTH;
+  StringExtractor::Encodings stringsEncodings_ =
+    StringExtractor::Encoding::ASCII | StringExtractor::Encoding::UTF16_LE;
+  bool stringsScanFile_ = false;
+
   std::unique_ptr<Project> project_;
   std::unique_ptr<LogHandler> logHandler_;
+  bool analysisCacheEnabled_ = true;
+  int analysisCacheMaxSize_ = Constants::Cache::DEFAULT_MAX_SIZE;
+  std::shared_ptr<const AnalysisCache> analysisCache_;
+  std::unique_ptr<DisassemblerPool> disassemblerPool_;
 };
 
 } // namespace dispar
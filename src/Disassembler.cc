@@ -1,45 +1,272 @@
 #include "Disassembler.h"
 #include "BinaryObject.h"
 #include "Constants.h"
+#include "DisassemblerPool.h"
+#include "InstructionIndex.h"
 #include "Util.h"
+#include "X86LengthDecoder.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
 
 #include <QByteArray>
 #include <QDebug>
+#include <QThread>
+#include <QThreadPool>
 
 namespace dispar {
 
-Disassembler::Result::Result(cs_insn *insn_, size_t count) : insn(insn_), count_(count)
+namespace {
+
+/// Adds \p range to the sorted \p ranges, merging it with those it overlaps or touches.
+void addRange(std::vector<Disassembler::Result::Range> &ranges, Disassembler::Result::Range range)
+{
+  auto it = std::lower_bound(ranges.begin(), ranges.end(), range);
+  if (it != ranges.begin() && std::prev(it)->second >= range.first) {
+    --it;
+    it->second = std::max(it->second, range.second);
+  }
+  else {
+    it = ranges.insert(it, range);
+  }
+
+  const auto next = std::next(it);
+  auto last = next;
+  while (last != ranges.end() && last->first <= it->second) {
+    it->second = std::max(it->second, last->second);
+    ++last;
+  }
+  ranges.erase(next, last);
+}
+
+/// Replaces \p count values of \p vec at \p pos with \p values, only moving what follows when the
+/// number of values changes.
+template <typename T>
+void splice(std::vector<T> &vec, size_t pos, size_t count, const std::vector<T> &values)
+{
+  const auto common = std::min(count, values.size());
+  std::copy_n(values.begin(), common, vec.begin() + pos);
+  if (count > common) {
+    vec.erase(vec.begin() + pos + common, vec.begin() + pos + count);
+  }
+  else {
+    vec.insert(vec.begin() + pos + common, values.begin() + common, values.end());
+  }
+}
+
+Disassembler::Instruction toInstruction(const cs_insn &insn)
+{
+  Disassembler::Instruction instr;
+  instr.address = insn.address;
+  instr.size = insn.size;
+  instr.bytes = insn.bytes;
+  instr.mnemonic = insn.mnemonic;
+  instr.operands = insn.op_str;
+  return instr;
+}
+
+} // namespace
+
+Disassembler::Result::Result(const QByteArray &code_, quint64 baseAddr_)
+  : code(code_.constData(), code_.size()), baseAddr(baseAddr_), operandArena(1, '\0')
+{
+}
+
+Disassembler::Result::~Result() = default;
+
+void Disassembler::Result::append(const cs_insn &insn)
+{
+  append(toInstruction(insn));
+}
+
+void Disassembler::Result::append(const Instruction &instr)
+{
+  const auto offset = instr.address - baseAddr;
+  assert(offset + instr.size <= quint64(code.size()));
+  offsets.push_back(static_cast<quint32>(offset));
+  sizes.push_back(static_cast<quint8>(instr.size));
+
+  const QByteArray mnemonic(instr.mnemonic);
+  auto it = mnemonicLookup.constFind(mnemonic);
+  if (it == mnemonicLookup.constEnd()) {
+    assert(mnemonics.size() < std::numeric_limits<quint16>::max());
+    it = mnemonicLookup.insert(mnemonic, static_cast<quint16>(mnemonics.size()));
+    mnemonics.push_back(mnemonic);
+  }
+  mnemonicIds.push_back(it.value());
+
+  if (instr.operands[0] == '\0') {
+    operandOffsets.push_back(0);
+  }
+  else {
+    operandOffsets.push_back(static_cast<quint32>(operandArena.size()));
+    operandArena.append(instr.operands, static_cast<int>(std::strlen(instr.operands)) + 1);
+  }
+}
+
+void Disassembler::Result::append(const Result &other)
 {
+  assert(other.baseAddr >= baseAddr);
+  assert(offsets.empty() || other.count() == 0 ||
+         other.baseAddr - baseAddr + other.offsets.front() >= offsets.back());
+  replace(count(), 0, other);
 }
 
-Disassembler::Result::~Result()
+void Disassembler::Result::replace(size_t pos, size_t count_, const Result &other)
 {
-  if (insn != nullptr) {
-    cs_free(insn, count_);
+  assert(pos + count_ <= count());
+  assert(other.baseAddr >= baseAddr);
+  const auto delta = static_cast<quint32>(other.baseAddr - baseAddr);
+
+  // Mnemonic IDs and operand offsets are local to each result.
+  std::vector<quint16> mnemonicMap;
+  mnemonicMap.reserve(other.mnemonics.size());
+  for (const auto &mnemonic : other.mnemonics) {
+    auto it = mnemonicLookup.constFind(mnemonic);
+    if (it == mnemonicLookup.constEnd()) {
+      assert(mnemonics.size() < std::numeric_limits<quint16>::max());
+      it = mnemonicLookup.insert(mnemonic, static_cast<quint16>(mnemonics.size()));
+      mnemonics.push_back(mnemonic);
+    }
+    mnemonicMap.push_back(it.value());
+  }
+
+  // Skip the empty string at the start of the arena of the other result. Operands of replaced
+  // instructions stay in the arena until the result is decoded again.
+  const auto arenaDelta = static_cast<quint32>(operandArena.size() - 1);
+  operandArena.append(other.operandArena.constData() + 1, other.operandArena.size() - 1); // NOLINT
+
+  const auto n = other.count();
+  std::vector<quint32> newOffsets(n), newOperandOffsets(n);
+  std::vector<quint16> newMnemonicIds(n);
+  for (size_t i = 0; i < n; i++) {
+    newOffsets[i] = delta + other.offsets[i];
+    newMnemonicIds[i] = mnemonicMap[other.mnemonicIds[i]];
+    const auto operandOffset = other.operandOffsets[i];
+    newOperandOffsets[i] = (operandOffset == 0 ? 0 : operandOffset + arenaDelta);
   }
+
+  splice(offsets, pos, count_, newOffsets);
+  splice(sizes, pos, count_, other.sizes);
+  splice(mnemonicIds, pos, count_, newMnemonicIds);
+  splice(operandOffsets, pos, count_, newOperandOffsets);
+}
+
+void Disassembler::Result::squeeze()
+{
+  offsets.shrink_to_fit();
+  sizes.shrink_to_fit();
+  mnemonicIds.shrink_to_fit();
+  operandOffsets.shrink_to_fit();
+  operandArena.squeeze();
 }
 
 size_t Disassembler::Result::count() const
 {
-  return count_;
+  return offsets.size();
 }
 
-cs_insn *Disassembler::Result::instructions(size_t pos) const
+Disassembler::Instruction Disassembler::Result::instruction(size_t pos) const
 {
   assert(pos < count());
-  return insn + pos; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+  Instruction res;
+  res.address = baseAddr + offsets[pos];
+  res.size = sizes[pos];
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  res.bytes = reinterpret_cast<const unsigned char *>(code.constData() + offsets[pos]);
+  res.mnemonic = mnemonics[mnemonicIds[pos]].constData();
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  res.operands = operandArena.constData() + operandOffsets[pos];
+  return res;
+}
+
+quint64 Disassembler::Result::baseAddress() const
+{
+  return baseAddr;
+}
+
+quint32 Disassembler::Result::offset(size_t pos) const
+{
+  assert(pos < count());
+  return offsets[pos];
+}
+
+quint64 Disassembler::Result::endAddress() const
+{
+  if (offsets.empty()) {
+    return baseAddr;
+  }
+  return baseAddr + offsets.back() + sizes.back();
+}
+
+Disassembler::Syntax Disassembler::Result::syntax() const
+{
+  return syntax_;
+}
+
+size_t Disassembler::Result::position(quint64 address) const
+{
+  if (address <= baseAddr) {
+    return 0;
+  }
+  const auto offset = address - baseAddr;
+  return static_cast<size_t>(
+    std::lower_bound(offsets.cbegin(), offsets.cend(), offset,
+                     [](quint32 value, quint64 offset_) { return value < offset_; }) -
+    offsets.cbegin());
+}
+
+void Disassembler::Result::patch(quint64 address, const QByteArray &bytes)
+{
+  const auto codeSize = quint64(code.size());
+  if (address < baseAddr || address - baseAddr >= codeSize || bytes.isEmpty()) {
+    return;
+  }
+  const auto offset = address - baseAddr;
+  const auto size = std::min<quint64>(quint64(bytes.size()), codeSize - offset);
+  code.replace(static_cast<int>(offset), static_cast<int>(size), bytes.constData(),
+               static_cast<int>(size));
+  addRange(patched, {address, address + size});
+}
+
+bool Disassembler::Result::isPatched() const
+{
+  return !patched.empty();
+}
+
+std::vector<Disassembler::Result::Range> Disassembler::Result::takeRedecodedRanges()
+{
+  std::vector<Range> res;
+  res.swap(redecoded);
+  return res;
+}
+
+size_t Disassembler::Result::memoryUsage() const
+{
+  size_t res = offsets.capacity() * sizeof(quint32) + sizes.capacity() * sizeof(quint8) +
+               mnemonicIds.capacity() * sizeof(quint16) +
+               operandOffsets.capacity() * sizeof(quint32) + size_t(operandArena.capacity());
+  for (const auto &mnemonic : mnemonics) {
+    res += size_t(mnemonic.capacity());
+  }
+  return res;
 }
 
 QString Disassembler::Result::toString() const
 {
   QStringList lines;
   for (size_t i = 0, n = count(); i < n; ++i) {
-    const auto *instr = instructions(i);
-    const auto addr = instr->address;
-    auto line = QString("%1: %2").arg(addr, 0, 16).arg(instr->mnemonic);
-    const QString opStr(instr->op_str);
+    const auto instr = instruction(i);
+    auto line = QString("%1: %2").arg(instr.address, 0, 16).arg(instr.mnemonic);
+    const QString opStr(instr.operands);
     if (!opStr.isEmpty()) {
       line += " " + opStr;
     }
@@ -48,9 +275,33 @@ QString Disassembler::Result::toString() const
   return lines.join("\n");
 }
 
+template <typename Callback>
+size_t Disassembler::iterate(csh handle, const QByteArray &data, quint64 baseAddr,
+                             Callback &&callback)
+{
+  cs_insn *insn = cs_malloc(handle);
+  if (insn == nullptr) {
+    return 0;
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *code = reinterpret_cast<const uint8_t *>(data.constData());
+  size_t size = data.size();
+  quint64 address = baseAddr;
+  size_t count = 0;
+  while (cs_disasm_iter(handle, &code, &size, &address, insn)) {
+    count++;
+    if (!callback(*insn)) {
+      break;
+    }
+  }
+
+  cs_free(insn, 1);
+  return count;
+}
+
 Disassembler::Disassembler(const BinaryObject &object, Syntax syntax)
 {
-  cs_arch arch = CS_ARCH_ALL;
   switch (object.cpuType()) {
   case CpuType::X86:
   case CpuType::X86_64:
@@ -62,55 +313,307 @@ Disassembler::Disassembler(const BinaryObject &object, Syntax syntax)
     return;
   }
 
-  int mode = (object.systemBits() == 32 ? cs_mode::CS_MODE_32 : cs_mode::CS_MODE_64);
-  mode += (object.endianness() == Constants::Endianness::Little ? cs_mode::CS_MODE_LITTLE_ENDIAN
-                                                                : cs_mode::CS_MODE_BIG_ENDIAN);
+  int modeFlags = (object.systemBits() == 32 ? cs_mode::CS_MODE_32 : cs_mode::CS_MODE_64);
+  modeFlags +=
+    (object.endianness() == Constants::Endianness::Little ? cs_mode::CS_MODE_LITTLE_ENDIAN
+                                                          : cs_mode::CS_MODE_BIG_ENDIAN);
+  mode = static_cast<cs_mode>(modeFlags);
 
-  cs_err err = cs_open(arch, static_cast<cs_mode>(mode), &handle);
-  if (err != 0U) {
-    qCritical() << "Failed to create cs disassembler!" << (int) err;
-    return;
+  syntax_ = syntax;
+  csSyntax = toCsSyntax(syntax);
+
+  valid_ = open(handle);
+  if (valid_) {
+    printInsn = cs_malloc(handle);
   }
+}
 
-  // Don't use CS_OPT_ON because I want to use the 'size' and 'bytes' variables on cs_insn!
-  // valid_ = !cs_option(handle, cs_opt_type::CS_OPT_DETAIL, cs_opt_value::CS_OPT_ON);
+Disassembler::~Disassembler()
+{
+  if (printInsn != nullptr) {
+    cs_free(printInsn, 1);
+  }
+  if (valid()) {
+    cs_close(&handle);
+  }
+}
 
-  cs_opt_value csSyntax = cs_opt_value::CS_OPT_SYNTAX_INTEL;
-  switch (syntax) {
-  case Syntax::ATT:
-    csSyntax = cs_opt_value::CS_OPT_SYNTAX_ATT;
-    break;
+std::unique_ptr<Disassembler::Result> Disassembler::disassemble(const QByteArray &data,
+                                                                quint64 baseAddr) const
+{
+  if (!valid()) {
+    return nullptr;
+  }
 
-  case Syntax::INTEL:
-    csSyntax = cs_opt_value::CS_OPT_SYNTAX_INTEL;
-    break;
+  auto res = disassemble(handle, data, baseAddr);
+  if (res) {
+    res->syntax_ = syntax_;
+    res->squeeze();
+  }
+  return res;
+}
 
-  case Syntax::INTEL_MASM:
-    csSyntax = cs_opt_value::CS_OPT_SYNTAX_MASM;
-    break;
+size_t Disassembler::disassemble(const QByteArray &data, quint64 baseAddr,
+                                 const InstructionCallback &callback) const
+{
+  if (!valid()) {
+    return 0;
   }
 
-  valid_ = (cs_option(handle, cs_opt_type::CS_OPT_SYNTAX, csSyntax) == 0U);
+  return iterate(handle, data, baseAddr,
+                 [&callback](const cs_insn &insn) { return callback(toInstruction(insn)); });
 }
 
-Disassembler::~Disassembler()
+std::unique_ptr<Disassembler::Result>
+Disassembler::disassembleConcurrently(const QByteArray &data, std::vector<quint64> boundaries,
+                                      quint64 baseAddr) const
 {
-  if (valid()) {
-    cs_close(&handle);
+  return disassembleChunks(data, std::move(boundaries), baseAddr, nullptr, nullptr);
+}
+
+std::unique_ptr<Disassembler::Result>
+Disassembler::disassembleConcurrently(const QByteArray &data, std::vector<quint64> boundaries,
+                                      DisassemblerPool &pool, const BinaryObject &object,
+                                      quint64 baseAddr) const
+{
+  return disassembleChunks(data, std::move(boundaries), baseAddr, &pool, &object);
+}
+
+std::unique_ptr<Disassembler::Result>
+Disassembler::disassembleChunks(const QByteArray &data, std::vector<quint64> boundaries,
+                                quint64 baseAddr, DisassemblerPool *pool,
+                                const BinaryObject *object) const
+{
+  const int threads = QThread::idealThreadCount();
+  const qint64 size = data.size();
+
+  // Split into chunks of at least the minimum size but enough to keep all threads busy.
+  const auto chunkSize = std::max(minChunkSize, size / (std::max(threads, 1) * 4));
+  std::sort(boundaries.begin(), boundaries.end());
+  std::vector<std::pair<qint64, qint64>> chunks; // [start, end)
+  qint64 start = 0;
+  for (const auto boundary : boundaries) {
+    const auto pos = static_cast<qint64>(boundary);
+    if (pos - start >= chunkSize && size - pos >= chunkSize) {
+      chunks.emplace_back(start, pos);
+      start = pos;
+    }
+  }
+  chunks.emplace_back(start, size);
+
+  if (chunks.size() == 1 || threads < 2) {
+    return disassemble(data, baseAddr);
+  }
+
+  // Each thread has its own capstone handle and takes the next chunk until none are left.
+  std::vector<std::unique_ptr<Result>> results(chunks.size());
+  std::atomic_size_t next{0};
+  const auto work = [this, &data, &chunks, &results, &next, baseAddr, pool, object] {
+    DisassemblerPool::Handle acquired;
+    csh chunkHandle{};
+    if (pool != nullptr) {
+      acquired = pool->acquire(*object, syntax_);
+      if (!acquired->valid()) return;
+      chunkHandle = acquired->handle;
+    }
+    else if (!open(chunkHandle)) {
+      return;
+    }
+
+    for (auto i = next++; i < chunks.size(); i = next++) {
+      const auto [chunkStart, chunkEnd] = chunks[i];
+      const auto chunk = QByteArray::fromRawData(data.constData() + chunkStart, // NOLINT
+                                                 static_cast<int>(chunkEnd - chunkStart));
+      results[i] = disassemble(chunkHandle, chunk, baseAddr + chunkStart);
+    }
+
+    // Acquired disassemblers are returned to the pool instead.
+    if (!acquired) {
+      cs_close(&chunkHandle);
+    }
+  };
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(std::min(threads, static_cast<int>(chunks.size())));
+  for (int i = 0; i < pool.maxThreadCount(); i++) {
+    pool.start(work);
+  }
+  pool.waitForDone();
+
+  // Stitch results together in order. A chunk that didn't decode right up to the next, because an
+  // instruction crossed the boundary or was invalid, is continued sequentially from where it
+  // actually ended instead, so the result is the same as decoding all of the data at once.
+  auto res = std::make_unique<Result>(data, baseAddr);
+  res->syntax_ = syntax_;
+  auto end = baseAddr;
+  for (std::size_t i = 0; i < chunks.size(); i++) {
+    const auto [chunkStart, chunkEnd] = chunks[i];
+    const auto *result = results[i].get();
+    std::unique_ptr<Result> continued;
+    if (end != baseAddr + chunkStart) {
+      const auto pos = static_cast<qint64>(end - baseAddr);
+      const auto rest = QByteArray::fromRawData(data.constData() + pos, // NOLINT
+                                                static_cast<int>(chunkEnd - pos));
+      continued = disassemble(handle, rest, end);
+      result = continued.get();
+    }
+
+    // Decoding stops at the first invalid instruction.
+    if (!result) break;
+
+    res->append(*result);
+    end = result->endAddress();
+  }
+  if (res->count() == 0) {
+    return nullptr;
+  }
+  res->squeeze();
+  return res;
+}
+
+std::unique_ptr<InstructionIndex> Disassembler::index(const QByteArray &data) const
+{
+  if (arch != CS_ARCH_X86) {
+    return nullptr;
   }
+  return std::make_unique<InstructionIndex>(data, (mode & CS_MODE_64) != 0);
 }
 
 std::unique_ptr<Disassembler::Result> Disassembler::disassemble(const QByteArray &data,
+                                                                const InstructionIndex &index,
+                                                                quint32 offset, quint32 size,
                                                                 quint64 baseAddr) const
 {
-  const void *code = data.constData();
-  cs_insn *insn = nullptr;
-  size_t count =
-    cs_disasm(handle, static_cast<const unsigned char *>(code), data.size(), baseAddr, 0, &insn);
-  if (count == 0) {
+  if (!valid()) {
+    return nullptr;
+  }
+
+  const auto end = static_cast<quint32>(std::min<qint64>(qint64(offset) + size, data.size()));
+  auto start = index.boundaryAtOrBefore(offset);
+  if (!start) {
+    start = index.boundaryAtOrAfter(offset);
+  }
+  if (!start || *start >= end) {
     return nullptr;
   }
-  return std::make_unique<Result>(insn, count);
+
+  // The last instruction may extend beyond the end of the range.
+  const auto codeEnd = std::min<qint64>(qint64(end) + X86LengthDecoder::maxLength, data.size());
+  const auto code = QByteArray::fromRawData(data.constData() + *start, // NOLINT
+                                            static_cast<int>(codeEnd - *start));
+  auto res = std::make_unique<Result>(code, baseAddr + *start);
+  res->syntax_ = syntax_;
+
+  auto pos = *start;
+  while (pos < end) {
+    const auto skip = static_cast<int>(pos - *start);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const auto rest = QByteArray::fromRawData(code.constData() + skip, code.size() - skip);
+    iterate(handle, rest, baseAddr + pos, [&](const cs_insn &insn) {
+      const auto instrOffset = static_cast<quint32>(insn.address - baseAddr);
+      if (instrOffset >= end) {
+        pos = instrOffset;
+        return false;
+      }
+      if (instrOffset + insn.size > offset) {
+        res->append(insn);
+      }
+      pos = instrOffset + insn.size;
+      return true;
+    });
+
+    // Stopped at an invalid instruction.
+    if (pos < end) {
+      const auto next = index.boundaryAtOrAfter(pos + 1);
+      if (!next) break;
+      pos = *next;
+    }
+  }
+
+  if (res->count() == 0) {
+    return nullptr;
+  }
+  res->squeeze();
+  return res;
+}
+
+void Disassembler::redisassemble(Result &result) const
+{
+  if (!valid()) {
+    return;
+  }
+
+  // Decode in the syntax of the result so all of its text is in the same syntax.
+  const bool otherSyntax = result.syntax_ != syntax_;
+  if (otherSyntax) {
+    cs_option(handle, cs_opt_type::CS_OPT_SYNTAX, toCsSyntax(result.syntax_));
+  }
+
+  const auto &patched = result.patched;
+  const auto base = result.baseAddr;
+  const auto codeEnd = base + quint64(result.code.size());
+  const auto isBoundary = [&result](quint64 address) {
+    const auto pos = result.position(address);
+    return pos < result.count() && result.baseAddr + result.offsets[pos] == address;
+  };
+  const auto codeFrom = [&result](quint64 begin, quint64 end) {
+    const auto offset = static_cast<int>(begin - result.baseAddr);
+    return QByteArray::fromRawData(result.code.constData() + offset, // NOLINT
+                                   static_cast<int>(end - begin));
+  };
+
+  size_t next = 0;
+  while (next < patched.size()) {
+    const auto patchBegin = patched[next].first;
+    auto patchEnd = patched[next++].second;
+
+    // Start at the instruction overlapping the start of the patch, if any.
+    auto pos = result.position(patchBegin);
+    if (pos > 0 && base + result.offsets[pos - 1] + result.sizes[pos - 1] > patchBegin) {
+      pos--;
+    }
+    const auto begin = (pos < result.count() ? base + result.offsets[pos] : result.endAddress());
+
+    // Decode until an instruction starts where one did before and after all patches reached.
+    std::optional<quint64> resync;
+    auto stop = begin;
+    iterate(handle, codeFrom(begin, codeEnd), begin, [&](const cs_insn &insn) {
+      while (next < patched.size() && patched[next].first < insn.address + insn.size) {
+        patchEnd = std::max(patchEnd, patched[next++].second);
+      }
+      if (insn.address >= patchEnd && isBoundary(insn.address)) {
+        resync = insn.address;
+        return false;
+      }
+      stop = insn.address + insn.size;
+      return true;
+    });
+
+    // Without resynchronizing, drop previous instructions up to the next one that isn't stale.
+    auto end = stop;
+    if (!resync) {
+      const auto endPos = result.position(std::max(stop, patchEnd));
+      end = (endPos < result.count() ? base + result.offsets[endPos] : result.endAddress());
+      end = std::max(end, stop);
+    }
+    if (end == begin) {
+      continue;
+    }
+
+    Result replacement(codeFrom(begin, stop), begin);
+    iterate(handle, codeFrom(begin, stop), begin, [&replacement](const cs_insn &insn) {
+      replacement.append(insn);
+      return true;
+    });
+    result.replace(pos, result.position(end) - pos, replacement);
+    addRange(result.redecoded, {begin, end});
+  }
+
+  result.patched.clear();
+
+  if (otherSyntax) {
+    cs_option(handle, cs_opt_type::CS_OPT_SYNTAX, csSyntax);
+  }
 }
 
 std::unique_ptr<Disassembler::Result> Disassembler::disassemble(const QString &text,
@@ -120,9 +623,106 @@ std::unique_ptr<Disassembler::Result> Disassembler::disassemble(const QString &t
   return disassemble(input, baseAddr);
 }
 
+Disassembler::Syntax Disassembler::syntax() const
+{
+  return syntax_;
+}
+
+bool Disassembler::setSyntax(Syntax syntax)
+{
+  if (!valid()) {
+    return false;
+  }
+
+  const auto value = toCsSyntax(syntax);
+  if (cs_option(handle, cs_opt_type::CS_OPT_SYNTAX, value) != 0U) {
+    return false;
+  }
+  syntax_ = syntax;
+  csSyntax = value;
+  return true;
+}
+
+Disassembler::Instruction Disassembler::print(const unsigned char *bytes, size_t size,
+                                              quint64 address) const
+{
+  if (printInsn == nullptr) {
+    return {};
+  }
+
+  const uint8_t *code = bytes;
+  if (!cs_disasm_iter(handle, &code, &size, &address, printInsn)) {
+    return {};
+  }
+  return toInstruction(*printInsn);
+}
+
+Disassembler::Instruction Disassembler::instruction(const Result &result, size_t pos) const
+{
+  auto instr = result.instruction(pos);
+  if (result.syntax() == syntax_) {
+    return instr;
+  }
+
+  const auto printed = print(instr.bytes, size_t(instr.size), instr.address);
+  return printed.size == instr.size ? printed : instr;
+}
+
 bool Disassembler::valid() const
 {
   return valid_;
 }
 
+cs_opt_value Disassembler::toCsSyntax(Syntax syntax)
+{
+  switch (syntax) {
+  case Syntax::ATT:
+    return cs_opt_value::CS_OPT_SYNTAX_ATT;
+
+  case Syntax::INTEL_MASM:
+    return cs_opt_value::CS_OPT_SYNTAX_MASM;
+
+  case Syntax::INTEL:
+  default:
+    return cs_opt_value::CS_OPT_SYNTAX_INTEL;
+  }
+}
+
+bool Disassembler::open(csh &handle) const
+{
+  if (arch == CS_ARCH_ALL) {
+    return false;
+  }
+
+  cs_err err = cs_open(arch, mode, &handle);
+  if (err != 0U) {
+    qCritical() << "Failed to create cs disassembler!" << (int) err;
+    return false;
+  }
+
+  // Don't use CS_OPT_ON because I want to use the 'size' and 'bytes' variables on cs_insn!
+  // valid_ = !cs_option(handle, cs_opt_type::CS_OPT_DETAIL, cs_opt_value::CS_OPT_ON);
+
+  if (cs_option(handle, cs_opt_type::CS_OPT_SYNTAX, csSyntax) != 0U) {
+    cs_close(&handle);
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<Disassembler::Result>
+Disassembler::disassemble(csh handle, const QByteArray &data, quint64 baseAddr)
+{
+  // Append directly to the compact store instead of having capstone grow an array of all cs_insn.
+  auto res = std::make_unique<Result>(data, baseAddr);
+  const auto count = iterate(handle, data, baseAddr, [&res](const cs_insn &insn) {
+    res->append(insn);
+    return true;
+  });
+  if (count == 0) {
+    return nullptr;
+  }
+  return res;
+}
+
 } // namespace dispar
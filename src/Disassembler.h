@@ -1,25 +1,50 @@
 #ifndef DISPAR_DISASSEMBLER_H
 #define DISPAR_DISASSEMBLER_H
 
+#include <QByteArray>
+#include <QHash>
 #include <QtGlobal>
 
+#include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <capstone/capstone.h>
 
-class QByteArray;
-
 namespace dispar {
 
 class BinaryObject;
+class DisassemblerPool;
+class InstructionIndex;
 
 class Disassembler {
 public:
   enum class Syntax { ATT, INTEL, INTEL_MASM };
 
+  /// Instruction of a Result, with text pointing into the result's storage.
+  struct Instruction {
+    quint64 address = 0;
+    int size = 0;
+    const unsigned char *bytes = nullptr;
+    const char *mnemonic = "";
+    const char *operands = "";
+  };
+
+  /// Decoded instructions in a compact structure-of-arrays form.
+  /** Instead of keeping cs_insn, which is over 200 bytes each, every instruction is stored as its
+      offset from the base address, its size, an interned mnemonic, and an offset into a shared
+      arena of operand strings. Instructions are materialized when asked for. */
   class Result {
+    friend class Disassembler;
+
   public:
-    Result(cs_insn *insn, size_t count);
+    /// Address range [first, second).
+    using Range = std::pair<quint64, quint64>;
+
+    /// Instructions are decoded from \p code starting at \p baseAddr.
+    /** The code is copied such that the result doesn't depend on the lifetime of its source. */
+    Result(const QByteArray &code, quint64 baseAddr = 0);
     virtual ~Result();
 
     Result(const Result &other) = delete;
@@ -28,15 +53,72 @@ public:
     Result(Result &&other) = delete;
     Result &operator=(Result &&rhs) = delete;
 
+    /// Appends \p insn which must be decoded from the code at its address.
+    void append(const cs_insn &insn);
+    void append(const Instruction &instr);
+
+    /// Appends instructions of \p other, which must be decoded from a later part of the same code.
+    void append(const Result &other);
+
+    /// Releases memory only needed while appending.
+    void squeeze();
+
     [[nodiscard]] size_t count() const;
-    [[nodiscard]] cs_insn *instructions(size_t pos) const;
+    [[nodiscard]] Instruction instruction(size_t pos) const;
+
+    [[nodiscard]] quint64 baseAddress() const;
+
+    /// Offset of instruction at \p pos relative to the base address.
+    [[nodiscard]] quint32 offset(size_t pos) const;
+
+    /// Address right after the last instruction.
+    [[nodiscard]] quint64 endAddress() const;
+
+    /// Syntax that the text of the instructions is in.
+    [[nodiscard]] Syntax syntax() const;
+
+    /// Position of the first instruction at or after \p address.
+    [[nodiscard]] size_t position(quint64 address) const;
+
+    /// Writes \p bytes into the copy of the code at \p address.
+    /** Instructions decoded from the bytes are stale until decoded again with
+        Disassembler::redisassemble(). */
+    void patch(quint64 address, const QByteArray &bytes);
+
+    /// Whether some instructions are stale since being patched.
+    [[nodiscard]] bool isPatched() const;
+
+    /// Ranges of instructions that were decoded again since last taken, merged and in order.
+    /** The instructions of each range replace all of those previously in it. */
+    std::vector<Range> takeRedecodedRanges();
+
+    /// Bytes used by the store, excluding the copy of the code.
+    [[nodiscard]] size_t memoryUsage() const;
 
     /// Lines of addresses, mnemonics, and instruction strings.
     [[nodiscard]] QString toString() const;
 
   private:
-    cs_insn *insn;
-    size_t count_;
+    /// Replaces \p count instructions at \p pos with those of \p other, which must be decoded from
+    /// the same part of the code.
+    void replace(size_t pos, size_t count, const Result &other);
+
+    QByteArray code;
+    quint64 baseAddr;
+    Syntax syntax_ = Syntax::INTEL;
+
+    std::vector<Range> patched, redecoded;
+
+    std::vector<quint32> offsets;
+    std::vector<quint8> sizes;
+    std::vector<quint16> mnemonicIds;
+    std::vector<quint32> operandOffsets;
+
+    std::vector<QByteArray> mnemonics;
+    QHash<QByteArray, quint16> mnemonicLookup;
+
+    /// Null-terminated operand strings, where offset 0 is the empty string.
+    QByteArray operandArena;
   };
 
   Disassembler(const BinaryObject &object, Syntax syntax = Syntax::INTEL);
@@ -53,10 +135,97 @@ public:
   [[nodiscard]] std::unique_ptr<Result> disassemble(const QString &text,
                                                     quint64 baseAddr = 0) const;
 
+  /// Called for each decoded instruction, which is only valid during the call.
+  /** Return false to stop disassembling. */
+  using InstructionCallback = std::function<bool(const Instruction &instr)>;
+
+  /// Streams instructions of \p data to \p callback one at a time.
+  /** Decoding reuses a single instruction so memory use is constant regardless of the size of \p
+      data. It stops at the first invalid instruction or when \p callback returns false. Returns the
+      number of instructions decoded. */
+  size_t disassemble(const QByteArray &data, quint64 baseAddr,
+                     const InstructionCallback &callback) const;
+
+  /// Disassembles \p data on all cores by splitting it into chunks at \p boundaries.
+  /** Boundaries are offsets into \p data where instructions are known to start, like those of
+      functions. Chunks are decoded with a capstone handle per thread and stitched together into one
+      result in order, continuing sequentially after any chunk that didn't decode up to the next,
+      such that it equals disassemble(). Small data is disassembled on the calling thread. */
+  [[nodiscard]] std::unique_ptr<Result>
+  disassembleConcurrently(const QByteArray &data, std::vector<quint64> boundaries,
+                          quint64 baseAddr = 0) const;
+
+  /// Same as above, but each thread acquires a disassembler of \p object from \p pool instead of
+  /// opening a capstone handle every time.
+  [[nodiscard]] std::unique_ptr<Result>
+  disassembleConcurrently(const QByteArray &data, std::vector<quint64> boundaries,
+                          DisassemblerPool &pool, const BinaryObject &object,
+                          quint64 baseAddr = 0) const;
+
+  /// Indexes where the instructions of \p data start without decoding them fully.
+  /** Returns nullptr if the architecture isn't x86. */
+  [[nodiscard]] std::unique_ptr<InstructionIndex> index(const QByteArray &data) const;
+
+  /// Disassembles the instructions of \p data that overlap [\p offset, \p offset + \p size).
+  /** Decoding starts at the closest boundary of \p index, which must be of \p data, at or before \p
+      offset, so any range is decoded on demand without decoding what comes before it. Decoding
+      continues at the next boundary after invalid instructions. */
+  [[nodiscard]] std::unique_ptr<Result> disassemble(const QByteArray &data,
+                                                    const InstructionIndex &index, quint32 offset,
+                                                    quint32 size, quint64 baseAddr = 0) const;
+
+  /// Decodes the instructions of \p result that are stale since patched.
+  /** Decoding starts at the first instruction overlapping each patch and stops when the instruction
+      stream lines up with the previous one again after it, so the cost depends on the size of the
+      patches and not of the code. Instructions that no longer decode are left out. */
+  void redisassemble(Result &result) const;
+
+  [[nodiscard]] Syntax syntax() const;
+
+  /// Prints instructions in \p syntax from now on.
+  /** Results keep the syntax they were decoded in. */
+  bool setSyntax(Syntax syntax);
+
+  /// Prints the instruction in \p bytes at \p address in the syntax of this disassembler.
+  /** Only the one instruction is decoded, so instructions with known boundaries are printed in
+      another syntax from their bytes alone without decoding the code around them. The text is valid
+      until the next call. Returns an instruction of size 0 if the bytes don't decode. */
+  [[nodiscard]] Instruction print(const unsigned char *bytes, size_t size, quint64 address) const;
+
+  /// Instruction \p pos of \p result in the syntax of this disassembler.
+  /** It is printed again if the result is in another syntax, and its text is then valid until the
+      next call. */
+  [[nodiscard]] Instruction instruction(const Result &result, size_t pos) const;
+
   [[nodiscard]] bool valid() const;
 
 private:
+  static cs_opt_value toCsSyntax(Syntax syntax);
+
+  /// Open \p handle with the architecture, mode, and syntax of this disassembler.
+  bool open(csh &handle) const;
+
+  static std::unique_ptr<Result> disassemble(csh handle, const QByteArray &data, quint64 baseAddr);
+
+  /// Decodes chunks with disassemblers of \p object from \p pool, if not null, or handles opened.
+  std::unique_ptr<Result> disassembleChunks(const QByteArray &data,
+                                            std::vector<quint64> boundaries, quint64 baseAddr,
+                                            DisassemblerPool *pool,
+                                            const BinaryObject *object) const;
+
+  /// Decodes \p data with \p handle and calls \p callback for each instruction.
+  template <typename Callback>
+  static size_t iterate(csh handle, const QByteArray &data, quint64 baseAddr, Callback &&callback);
+
+  /// Chunks smaller than this aren't worth decoding on their own thread.
+  static constexpr qint64 minChunkSize = 64 * 1024;
+
+  cs_arch arch = CS_ARCH_ALL;
+  cs_mode mode{};
+  Syntax syntax_ = Syntax::INTEL;
+  cs_opt_value csSyntax = CS_OPT_SYNTAX_INTEL;
   csh handle{};
+  cs_insn *printInsn = nullptr; ///< Instruction reused by print().
   bool valid_ = false;
 };
 
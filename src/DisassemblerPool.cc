@@ -0,0 +1,95 @@
+#include "DisassemblerPool.h"
+#include "BinaryObject.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace dispar {
+
+struct DisassemblerPool::State {
+  explicit State(int maxIdle_) : maxIdle(maxIdle_)
+  {
+  }
+
+  const int maxIdle;
+  mutable QMutex mutex;
+  std::map<Key, std::vector<std::unique_ptr<Disassembler>>> idle;
+};
+
+DisassemblerPool::Release::Release(std::weak_ptr<State> state_, Key key_)
+  : state(std::move(state_)), key(key_)
+{
+}
+
+void DisassemblerPool::Release::operator()(Disassembler *dis) const
+{
+  std::unique_ptr<Disassembler> owned(dis);
+  if (!owned || !owned->valid()) return;
+
+  const auto shared = state.lock();
+  if (!shared) return;
+
+  // The syntax might have been changed while acquired.
+  auto releaseKey = key;
+  std::get<Disassembler::Syntax>(releaseKey) = owned->syntax();
+
+  QMutexLocker locker(&shared->mutex);
+  auto &idle = shared->idle[releaseKey];
+  if (static_cast<int>(idle.size()) < shared->maxIdle) {
+    idle.push_back(std::move(owned));
+  }
+}
+
+DisassemblerPool::DisassemblerPool(int maxIdle)
+  : state(std::make_shared<State>(std::max(maxIdle, 0)))
+{
+}
+
+DisassemblerPool::~DisassemblerPool() = default;
+
+int DisassemblerPool::defaultMaxIdle()
+{
+  return std::max(QThread::idealThreadCount(), 1);
+}
+
+DisassemblerPool::Handle DisassemblerPool::acquire(const BinaryObject &object,
+                                                    Disassembler::Syntax syntax)
+{
+  const Key key(object.cpuType(), object.systemBits(), object.endianness(), syntax);
+  Release release(state, key);
+
+  {
+    QMutexLocker locker(&state->mutex);
+    if (auto it = state->idle.find(key); it != state->idle.end() && !it->second.empty()) {
+      auto dis = std::move(it->second.back());
+      it->second.pop_back();
+      return Handle(dis.release(), std::move(release));
+    }
+  }
+
+  // Open outside the lock so other threads aren't held up by it.
+  return Handle(new Disassembler(object, syntax), std::move(release));
+}
+
+int DisassemblerPool::idle() const
+{
+  QMutexLocker locker(&state->mutex);
+  int res = 0;
+  for (const auto &entry : state->idle) {
+    res += static_cast<int>(entry.second.size());
+  }
+  return res;
+}
+
+void DisassemblerPool::clear()
+{
+  QMutexLocker locker(&state->mutex);
+  state->idle.clear();
+}
+
+} // namespace dispar
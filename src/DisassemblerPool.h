@@ -0,0 +1,71 @@
+#ifndef DISPAR_DISASSEMBLER_POOL_H
+#define DISPAR_DISASSEMBLER_POOL_H
+
+#include <memory>
+#include <tuple>
+
+#include "Constants.h"
+#include "CpuType.h"
+#include "Disassembler.h"
+
+namespace dispar {
+
+class BinaryObject;
+
+/// Thread-safe pool of disassemblers keyed by architecture, mode, and syntax.
+/** Opening a capstone handle and setting it up costs more than decoding a few instructions, so
+    interactive edits and background workers acquire a disassembler that returns to the pool when
+    released instead of opening a new one every time. At most a number of idle disassemblers are
+    kept per key. Disassemblers released after the pool is destroyed are deleted. */
+class DisassemblerPool {
+  struct State;
+
+public:
+  /// Key of idle disassemblers: CPU type, system bits, endianness, and syntax.
+  using Key = std::tuple<CpuType, int, Constants::Endianness, Disassembler::Syntax>;
+
+  /// Returns a disassembler to the pool it was acquired from.
+  class Release {
+  public:
+    Release() = default;
+    Release(std::weak_ptr<State> state, Key key);
+
+    void operator()(Disassembler *dis) const;
+
+  private:
+    std::weak_ptr<State> state;
+    Key key;
+  };
+
+  using Handle = std::unique_ptr<Disassembler, Release>;
+
+  DisassemblerPool(int maxIdle = defaultMaxIdle());
+  ~DisassemblerPool();
+
+  DisassemblerPool(const DisassemblerPool &other) = delete;
+  DisassemblerPool &operator=(const DisassemblerPool &rhs) = delete;
+
+  DisassemblerPool(DisassemblerPool &&other) = delete;
+  DisassemblerPool &operator=(DisassemblerPool &&rhs) = delete;
+
+  /// One idle disassembler per core by default, enough for every worker to keep one.
+  static int defaultMaxIdle();
+
+  /// Disassembler for \p object in \p syntax, reused if one is idle.
+  /** It must be checked for being valid like any other. Changing its syntax while acquired is fine,
+      it is then returned to the pool under the new syntax. */
+  [[nodiscard]] Handle acquire(const BinaryObject &object, Disassembler::Syntax syntax);
+
+  /// Number of idle disassemblers of all keys.
+  [[nodiscard]] int idle() const;
+
+  /// Deletes all idle disassemblers.
+  void clear();
+
+private:
+  std::shared_ptr<State> state;
+};
+
+} // namespace dispar
+
+#endif // DISPAR_DISASSEMBLER_POOL_H
@@ -0,0 +1,183 @@
+#include "HexDump.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+
+namespace dispar {
+
+namespace {
+
+constexpr const char *digits = "0123456789ABCDEF";
+
+/// Width of the hex column including the extra space between the low and high halves.
+constexpr int hexWidth = HexDump::bytesPerLine * 3 + 1;
+
+/// Number of hex digits of \p address, which is at least one.
+int addressDigits(quint64 address)
+{
+  int res = 1;
+  while ((address >>= 4) != 0) {
+    res++;
+  }
+  return res;
+}
+
+/// Graphical ASCII, which excludes space.
+constexpr bool isGraph(uchar ch)
+{
+  return ch > 0x20 && ch < 0x7F;
+}
+
+} // namespace
+
+HexDump::HexDump(const QByteArray &data, quint64 address)
+{
+  const qint64 size = data.size();
+  const auto textLen = textLength(size, address);
+  if (textLen > maxTextLength) {
+    tooLarge_ = true;
+    return;
+  }
+
+  // Empty data still has the address line.
+  if (size == 0) {
+    lines_.push_back({address, 0, 0, lineLength(address, 0)});
+  }
+
+  qint64 position = 0;
+  lines_.reserve((size + bytesPerLine - 1) / bytesPerLine);
+  for (qint64 offset = 0; offset < size; offset += bytesPerLine) {
+    const auto lineSize = static_cast<int>(std::min<qint64>(bytesPerLine, size - offset));
+    const auto length = lineLength(address + offset, lineSize);
+    lines_.push_back({address + quint64(offset), quint64(offset), position, length});
+    position += length + 1;
+  }
+
+  text_ = QString(static_cast<int>(textLen), Qt::Uninitialized);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+  auto *out = text_.data();
+
+  const auto count = lines_.size();
+  const int threads = QThread::idealThreadCount();
+  const auto chunkLines =
+    std::max<size_t>(minChunkLines, count / (static_cast<size_t>(std::max(threads, 1)) * 4));
+  const auto chunks = (count + chunkLines - 1) / chunkLines;
+
+  std::atomic_size_t next{0};
+  const auto work = [this, bytes, size, out, count, chunkLines, chunks, &next] {
+    for (auto i = next++; i < chunks; i = next++) {
+      for (auto j = i * chunkLines, end = std::min(j + chunkLines, count); j < end; j++) {
+        const auto &line = lines_[j];
+        const auto lineSize =
+          static_cast<int>(std::min<qint64>(bytesPerLine, size - qint64(line.offset)));
+        writeLine(out + line.position, line.address, bytes + line.offset, // NOLINT
+                  std::max(lineSize, 0));
+        if (j + 1 < count) {
+          out[line.position + line.length] = QLatin1Char('\n'); // NOLINT
+        }
+      }
+    }
+  };
+
+  if (chunks < 2 || threads < 2) {
+    work();
+  }
+  else {
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::min(threads, static_cast<int>(chunks)));
+    for (int i = 0; i < pool.maxThreadCount(); i++) {
+      pool.start(work);
+    }
+    pool.waitForDone();
+  }
+}
+
+bool HexDump::isTooLarge() const
+{
+  return tooLarge_;
+}
+
+const QString &HexDump::text() const
+{
+  return text_;
+}
+
+const std::vector<HexDump::Line> &HexDump::lines() const
+{
+  return lines_;
+}
+
+QString HexDump::line(const Line &line) const
+{
+  return text_.mid(static_cast<int>(line.position), line.length);
+}
+
+qint64 HexDump::textLength(qint64 size, quint64 address)
+{
+  if (size <= 0) {
+    return lineLength(address, 0);
+  }
+
+  // Every line but the last is full and followed by a line break. Address digits are added after.
+  const auto lines = (size + bytesPerLine - 1) / bytesPerLine;
+  const auto lastSize = static_cast<int>(size - (lines - 1) * bytesPerLine);
+  const auto fullLength = lineLength(0, bytesPerLine) - 1;
+  qint64 res = (lines - 1) * (fullLength + 1) + lineLength(0, lastSize) - 1;
+
+  // Each line has at least one digit, and another for every power of 16 its address reaches.
+  const auto last = address + quint64(lines - 1) * bytesPerLine;
+  for (int digits = 1; digits <= 16; digits++) {
+    const quint64 min = (digits == 1 ? 0 : quint64(1) << (4 * (digits - 1)));
+    if (last < min) break;
+    const auto below = (address >= min ? 0 : (min - address + bytesPerLine - 1) / bytesPerLine);
+    res += lines - qint64(below);
+  }
+  return res;
+}
+
+int HexDump::lineLength(quint64 address, int size)
+{
+  // The empty line has neither hex nor ASCII column.
+  if (size == 0) {
+    return addressDigits(address) + 2;
+  }
+  return addressDigits(address) + 2 + hexWidth + 2 + size;
+}
+
+void HexDump::writeLine(QChar *out, quint64 address, const uchar *bytes, int size)
+{
+  const int addrDigits = addressDigits(address);
+  for (int i = addrDigits - 1; i >= 0; i--, address >>= 4) {
+    out[i] = QLatin1Char(digits[address & 0xF]); // NOLINT
+  }
+  out[addrDigits] = QLatin1Char(':');     // NOLINT
+  out[addrDigits + 1] = QLatin1Char(' '); // NOLINT
+  if (size == 0) return;
+
+  auto *hex = out + addrDigits + 2; // NOLINT
+  auto *ascii = hex + hexWidth + 2; // NOLINT
+  for (int i = 0, pos = 0; i < bytesPerLine; i++, pos += 3) {
+    // Put an extra space in the middle of the hex data to show the low and high parts.
+    if (i == bytesPerLine / 2) {
+      hex[pos++] = QLatin1Char(' '); // NOLINT
+    }
+    if (i < size) {
+      const auto byte = bytes[i];                               // NOLINT
+      hex[pos] = QLatin1Char(digits[byte >> 4]);                // NOLINT
+      hex[pos + 1] = QLatin1Char(digits[byte & 0xF]);           // NOLINT
+      ascii[i] = QLatin1Char(isGraph(byte) ? char(byte) : '.'); // NOLINT
+    }
+    else {
+      hex[pos] = hex[pos + 1] = QLatin1Char(' '); // NOLINT
+    }
+    hex[pos + 2] = QLatin1Char(' '); // NOLINT
+  }
+  hex[hexWidth] = hex[hexWidth + 1] = QLatin1Char(' '); // NOLINT
+}
+
+} // namespace dispar
@@ -0,0 +1,71 @@
+#ifndef DISPAR_HEX_DUMP_H
+#define DISPAR_HEX_DUMP_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <limits>
+#include <vector>
+
+namespace dispar {
+
+/// Renders data as lines of address, hex, and ASCII columns.
+/** Each line is of the format:
+
+    ADDR: 00 01 02 03 04 05 06 07  08 09 0A 0B 0C 0D 0E 0F   ................
+
+    Where ADDR is the uppercase address without padding. Lines are written from lookup tables
+    straight into one preallocated text, and large data is split into chunks of lines that are
+    rendered concurrently. Where each line is in the text is kept as a record, so it never has to
+    be parsed again. Data is only rendered if all of its text fits in one string. */
+class HexDump {
+public:
+  static constexpr int bytesPerLine = 16;
+
+  /// Dumps of fewer lines than this are always rendered by one thread.
+  static constexpr int minChunkLines = 16 * 1024;
+
+  /// Longest text that is rendered, since a QString can't allocate more than 2 GB.
+  static constexpr qint64 maxTextLength =
+    (std::numeric_limits<int>::max() - 64) / qint64(sizeof(QChar));
+
+  struct Line {
+    quint64 address = 0, offset = 0; ///< Of the first byte.
+    qint64 position = 0;             ///< In text.
+    int length = 0;                  ///< Excluding the line break.
+  };
+
+  HexDump() = default;
+
+  /// Renders \p data unless its text would be longer than maxTextLength.
+  HexDump(const QByteArray &data, quint64 address);
+
+  /// Whether the data was too large to be rendered, in which case there is no text nor lines.
+  [[nodiscard]] bool isTooLarge() const;
+
+  /// All lines separated by line breaks.
+  [[nodiscard]] const QString &text() const;
+
+  [[nodiscard]] const std::vector<Line> &lines() const;
+
+  /// Text of \p line.
+  [[nodiscard]] QString line(const Line &line) const;
+
+  /// Length of the text of \p size bytes at \p address, computed without rendering it.
+  static qint64 textLength(qint64 size, quint64 address);
+
+  /// Length of the line of \p size bytes at \p address.
+  static int lineLength(quint64 address, int size);
+
+  /// Writes the line of \p size bytes at \p address to \p out, which must have room for it.
+  static void writeLine(QChar *out, quint64 address, const uchar *bytes, int size);
+
+private:
+  QString text_;
+  std::vector<Line> lines_;
+  bool tooLarge_ = false;
+};
+
+} // namespace dispar
+
+#endif // DISPAR_HEX_DUMP_H
@@ -0,0 +1,131 @@
+#include "InstructionIndex.h"
+#include "X86LengthDecoder.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+namespace dispar {
+
+InstructionIndex::InstructionIndex(const QByteArray &code, bool x64)
+  : size_(static_cast<quint32>(code.size())), bits((size_ + 63) / 64, 0)
+{
+  const X86LengthDecoder decoder(x64);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *data = reinterpret_cast<const unsigned char *>(code.constData());
+  quint32 pos = 0;
+  while (pos < size_) {
+    const auto length = decoder.length(data + pos, size_ - pos); // NOLINT
+    if (length == 0) {
+      pos++;
+      continue;
+    }
+    bits[pos / 64] |= quint64(1) << (pos % 64);
+    pos += length;
+  }
+
+  countPages();
+}
+
+InstructionIndex::InstructionIndex(quint32 size, const std::vector<quint32> &offsets)
+  : size_(size), bits((size_ + 63) / 64, 0)
+{
+  for (const auto offset : offsets) {
+    if (offset < size_) {
+      bits[offset / 64] |= quint64(1) << (offset % 64);
+    }
+  }
+
+  countPages();
+}
+
+quint32 InstructionIndex::size() const
+{
+  return size_;
+}
+
+quint32 InstructionIndex::count() const
+{
+  return count_;
+}
+
+bool InstructionIndex::contains(quint32 offset) const
+{
+  return offset < size_ && (bits[offset / 64] & (quint64(1) << (offset % 64))) != 0;
+}
+
+std::optional<quint32> InstructionIndex::boundaryAtOrBefore(quint32 offset) const
+{
+  if (size_ == 0) {
+    return std::nullopt;
+  }
+  offset = std::min(offset, size_ - 1);
+
+  // Only keep bits up to and including the offset.
+  auto word = offset / 64;
+  auto value = bits[word] & (~quint64(0) >> (63 - offset % 64));
+  while (value == 0) {
+    if (word == 0) {
+      return std::nullopt;
+    }
+    value = bits[--word];
+  }
+  return word * 64 + 63 - qCountLeadingZeroBits(value);
+}
+
+std::optional<quint32> InstructionIndex::boundaryAtOrAfter(quint32 offset) const
+{
+  if (offset >= size_) {
+    return std::nullopt;
+  }
+
+  // Only keep bits from the offset onwards.
+  auto word = offset / 64;
+  auto value = bits[word] & (~quint64(0) << (offset % 64));
+  while (value == 0) {
+    if (++word == bits.size()) {
+      return std::nullopt;
+    }
+    value = bits[word];
+  }
+  return word * 64 + qCountTrailingZeroBits(value);
+}
+
+quint32 InstructionIndex::rank(quint32 offset) const
+{
+  if (offset >= size_) {
+    return count_;
+  }
+
+  const auto page = offset / pageSize;
+  auto rank = pageRanks[page];
+  const auto word = offset / 64;
+  for (auto i = page * wordsPerPage; i < word; i++) {
+    rank += qPopulationCount(bits[i]);
+  }
+  return rank + qPopulationCount(bits[word] & ((quint64(1) << (offset % 64)) - 1));
+}
+
+void InstructionIndex::countPages()
+{
+  const auto pages = (size_ + pageSize - 1) / pageSize;
+  pageRanks.reserve(pages);
+  quint32 rank = 0;
+  for (quint32 page = 0; page < pages; page++) {
+    pageRanks.push_back(rank);
+    const auto first = page * wordsPerPage;
+    const auto last = std::min<size_t>(first + wordsPerPage, bits.size());
+    for (auto word = first; word < last; word++) {
+      rank += qPopulationCount(bits[word]);
+    }
+  }
+  count_ = rank;
+}
+
+size_t InstructionIndex::memoryUsage() const
+{
+  return bits.capacity() * sizeof(quint64) + pageRanks.capacity() * sizeof(quint32);
+}
+
+} // namespace dispar
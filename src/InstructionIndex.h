@@ -0,0 +1,60 @@
+#ifndef DISPAR_INSTRUCTION_INDEX_H
+#define DISPAR_INSTRUCTION_INDEX_H
+
+#include <QByteArray>
+
+#include <optional>
+#include <vector>
+
+namespace dispar {
+
+/// Index of the offsets where instructions start in x86 or x86-64 code.
+/** It is built by a linear sweep with X86LengthDecoder, or from offsets known from before, and
+    stores one bit per byte of code, in pages of 4 KB with the number of instructions before each
+    page. Bytes that don't decode are skipped one at a time, like data in code, so the sweep
+    resynchronizes after them. */
+class InstructionIndex {
+public:
+  static constexpr quint32 pageSize = 4096;
+
+  InstructionIndex(const QByteArray &code, bool x64);
+
+  /// Index of code of \p size bytes where instructions start at \p offsets, like those cached.
+  /** Offsets at or beyond the size are ignored. */
+  InstructionIndex(quint32 size, const std::vector<quint32> &offsets);
+
+  /// Size of the indexed code.
+  [[nodiscard]] quint32 size() const;
+
+  /// Number of instructions.
+  [[nodiscard]] quint32 count() const;
+
+  /// Whether an instruction starts at \p offset.
+  [[nodiscard]] bool contains(quint32 offset) const;
+
+  /// Closest offset at or before \p offset where an instruction starts.
+  [[nodiscard]] std::optional<quint32> boundaryAtOrBefore(quint32 offset) const;
+
+  /// Closest offset at or after \p offset where an instruction starts.
+  [[nodiscard]] std::optional<quint32> boundaryAtOrAfter(quint32 offset) const;
+
+  /// Number of instructions starting before \p offset.
+  [[nodiscard]] quint32 rank(quint32 offset) const;
+
+  /// Bytes used by the index.
+  [[nodiscard]] size_t memoryUsage() const;
+
+private:
+  static constexpr quint32 wordsPerPage = pageSize / 64;
+
+  /// Counts the instructions before each page and in total.
+  void countPages();
+
+  quint32 size_ = 0, count_ = 0;
+  std::vector<quint64> bits;
+  std::vector<quint32> pageRanks; ///< Instructions before each page.
+};
+
+} // namespace dispar
+
+#endif // DISPAR_INSTRUCTION_INDEX_H
@@ -0,0 +1,189 @@
+#include "LazyDisassembly.h"
+#include "BinaryObject.h"
+#include "InstructionIndex.h"
+#include "Section.h"
+#include "X86LengthDecoder.h"
+
+#include <algorithm>
+
+namespace dispar {
+
+LazyDisassembly::LazyDisassembly(DisassemblerPool &pool, const BinaryObject &object,
+                                 const Section &section_, Disassembler::Syntax syntax,
+                                 int windowSize_, int maxWindows_)
+  : dis(pool.acquire(object, syntax)), section(section_), windowSize(std::max(windowSize_, 1)),
+    maxWindows(std::max(maxWindows_, 1)), boundaries{0}
+{
+}
+
+LazyDisassembly::~LazyDisassembly() = default;
+
+bool LazyDisassembly::suits(const Section &section)
+{
+  if (section.type() != Section::Type::TEXT && section.type() != Section::Type::SYMBOL_STUBS) {
+    return false;
+  }
+  return section.size() > quint64(Constants::Disassembly::LAZY_THRESHOLD) ||
+         !section.instructionOffsets().empty();
+}
+
+bool LazyDisassembly::valid() const
+{
+  return dis->valid();
+}
+
+void LazyDisassembly::addBoundaries(const std::vector<quint32> &offsets)
+{
+  for (const auto offset : offsets) {
+    if (offset < quint32(section.data().size())) {
+      boundaries.insert(offset);
+    }
+  }
+}
+
+LazyDisassembly::Window LazyDisassembly::window(quint32 offset)
+{
+  if (!valid() || offset >= quint32(section.data().size())) {
+    return nullptr;
+  }
+
+  // A window known to contain the offset.
+  auto range = ranges.upper_bound(offset);
+  if (range != ranges.begin()) {
+    --range;
+    if (offset < range->second) {
+      const auto start = range->first;
+      if (const auto it = cache.constFind(start); it != cache.constEnd()) {
+        const auto window = (*it)->second;
+        touch(start, window);
+        return window;
+      }
+      return decode(start);
+    }
+  }
+
+  // Otherwise decode from the closest boundary before the offset until reaching it. If that is
+  // more than a window away, start from where the instruction index says instead.
+  auto start = *std::prev(boundaries.upper_bound(offset));
+  if (offset - start > quint32(windowSize)) {
+    if (!index) {
+      // Offsets cached from before spare the sweep, and work for any architecture.
+      if (const auto &offsets = section.instructionOffsets(); !offsets.empty()) {
+        index = std::make_unique<InstructionIndex>(quint32(section.data().size()), offsets);
+      }
+      else {
+        index = dis->index(section.data());
+      }
+    }
+    if (index) {
+      start = std::max(start, index->boundaryAtOrBefore(offset).value_or(start));
+    }
+  }
+  while (true) {
+    auto window = decode(start);
+    if (!window) {
+      return nullptr;
+    }
+    if (offset < window->endAddress()) {
+      return window;
+    }
+    start = static_cast<quint32>(window->endAddress());
+  }
+}
+
+LazyDisassembly::Window LazyDisassembly::next(const Disassembler::Result &window)
+{
+  return this->window(static_cast<quint32>(window.endAddress()));
+}
+
+void LazyDisassembly::setSyntax(Disassembler::Syntax syntax)
+{
+  if (syntax == dis->syntax() || !dis->setSyntax(syntax)) {
+    return;
+  }
+
+  lru.clear();
+  cache.clear();
+}
+
+int LazyDisassembly::cachedWindows() const
+{
+  return static_cast<int>(lru.size());
+}
+
+LazyDisassembly::Window LazyDisassembly::decode(quint32 start)
+{
+  const auto &data = section.data();
+  const auto size = static_cast<quint32>(data.size());
+
+  // Don't decode into the next window so windows never overlap.
+  auto limit = std::min(size, start + static_cast<quint32>(windowSize));
+  if (const auto it = ranges.upper_bound(start); it != ranges.end()) {
+    limit = std::min(limit, it->first);
+  }
+
+  // The last instruction may extend beyond the limit.
+  const auto end = std::min(size, limit + X86LengthDecoder::maxLength);
+  const auto code = QByteArray::fromRawData(data.constData() + start, // NOLINT
+                                            static_cast<int>(end - start));
+
+  auto result = std::make_shared<Disassembler::Result>(code, start);
+  dis->disassemble(code, start, [&result, limit](const auto &instr) {
+    if (instr.address >= limit) {
+      return false;
+    }
+    result->append(instr);
+    return true;
+  });
+  if (result->count() == 0) {
+    return nullptr;
+  }
+  result->squeeze();
+
+  const auto windowEnd = static_cast<quint32>(result->endAddress());
+
+  // The last instruction extending into the next window means that one didn't start at an
+  // instruction after all, so drop it to be decoded again from the end of this one.
+  for (auto it = ranges.upper_bound(start); it != ranges.end() && it->first < windowEnd;
+       it = ranges.upper_bound(start)) {
+    drop(it->first);
+  }
+
+  ranges[start] = windowEnd;
+  boundaries.insert(start);
+  if (windowEnd < size) {
+    boundaries.insert(windowEnd);
+  }
+
+  Window window = result;
+  touch(start, window);
+  return window;
+}
+
+void LazyDisassembly::drop(quint32 start)
+{
+  ranges.erase(start);
+  if (start != 0) {
+    boundaries.erase(start);
+  }
+  if (const auto it = cache.find(start); it != cache.end()) {
+    lru.erase(*it);
+    cache.erase(it);
+  }
+}
+
+void LazyDisassembly::touch(quint32 start, const Window &window)
+{
+  if (const auto it = cache.constFind(start); it != cache.constEnd()) {
+    lru.erase(*it);
+  }
+  lru.emplace_front(start, window);
+  cache.insert(start, lru.begin());
+
+  while (static_cast<int>(lru.size()) > maxWindows) {
+    cache.remove(lru.back().first);
+    lru.pop_back();
+  }
+}
+
+} // namespace dispar
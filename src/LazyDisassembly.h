@@ -0,0 +1,98 @@
+#ifndef DISPAR_LAZY_DISASSEMBLY_H
+#define DISPAR_LAZY_DISASSEMBLY_H
+
+#include <QHash>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "Constants.h"
+#include "Disassembler.h"
+#include "DisassemblerPool.h"
+
+namespace dispar {
+
+class BinaryObject;
+class Section;
+class InstructionIndex;
+
+/// Disassembles windows of a code section on demand and keeps the most recently used ones.
+/** A window is decoded from an offset known to start an instruction until at least the window size
+    has been decoded. Known boundaries are the start of the section, offsets added explicitly, like
+    those of symbols, and the ends of decoded windows. Offsets far from any known boundary are found
+    in an InstructionIndex of the section, which is built the first time it is needed from the
+    instruction offsets of the section, if cached, or by a sweep otherwise. The extent of each
+    window is remembered, so an evicted window is decoded exactly the same when requested again,
+    unless the window before it turns out to end inside it. Then its start wasn't an instruction
+    after all, and it is dropped such that windows never overlap.
+
+    Addresses of instructions are offsets into the section. */
+class LazyDisassembly {
+public:
+  using Window = std::shared_ptr<const Disassembler::Result>;
+
+  /// The section must outlive this instance.
+  /** A disassembler is acquired from \p pool and returned to it when destroyed. */
+  LazyDisassembly(DisassemblerPool &pool, const BinaryObject &object, const Section &section,
+                  Disassembler::Syntax syntax = Disassembler::Syntax::INTEL,
+                  int windowSize = Constants::Disassembly::WINDOW_SIZE,
+                  int maxWindows = Constants::Disassembly::CACHED_WINDOWS);
+  ~LazyDisassembly();
+
+  LazyDisassembly(const LazyDisassembly &other) = delete;
+  LazyDisassembly &operator=(const LazyDisassembly &rhs) = delete;
+
+  LazyDisassembly(LazyDisassembly &&other) = delete;
+  LazyDisassembly &operator=(LazyDisassembly &&rhs) = delete;
+
+  /// Whether \p section is better disassembled lazily than all at once.
+  /** That is large code sections, and code sections whose instruction offsets are cached. */
+  static bool suits(const Section &section);
+
+  [[nodiscard]] bool valid() const;
+
+  /// Adds \p offsets that are known to start instructions.
+  void addBoundaries(const std::vector<quint32> &offsets);
+
+  /// Window of instructions containing \p offset, which is decoded if not cached.
+  /** Returns nullptr if \p offset is outside the section or nothing could be decoded. */
+  Window window(quint32 offset);
+
+  /// Window following \p window.
+  /** Returns nullptr at the end of the section or if decoding stopped at invalid code. */
+  Window next(const Disassembler::Result &window);
+
+  /// Decodes windows in \p syntax from now on.
+  /** Cached windows are dropped but their extents are kept, so windows keep the same instructions.
+      Windows handed out before stay in the previous syntax. */
+  void setSyntax(Disassembler::Syntax syntax);
+
+  /// Number of windows currently in memory.
+  [[nodiscard]] int cachedWindows() const;
+
+private:
+  Window decode(quint32 start);
+  void touch(quint32 start, const Window &window);
+
+  /// Forgets the window at \p start and that it starts an instruction.
+  void drop(quint32 start);
+
+  DisassemblerPool::Handle dis;
+  const Section &section;
+  int windowSize, maxWindows;
+
+  std::set<quint32> boundaries;
+  std::unique_ptr<InstructionIndex> index;
+  std::map<quint32, quint32> ranges; ///< Start -> end of decoded windows.
+
+  /// Most recently used windows first.
+  std::list<std::pair<quint32, Window>> lru;
+  QHash<quint32, std::list<std::pair<quint32, Window>>::iterator> cache;
+};
+
+} // namespace dispar
+
+#endif // DISPAR_LAZY_DISASSEMBLY_H
@@ -0,0 +1,168 @@
+#include "MappedFile.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <algorithm>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace dispar {
+
+MappedFile::MappedFile(const QString &file_) : file(file_)
+{
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  size_ = file.size();
+
+  // Mapping an empty file fails on most platforms, but it is still a valid (empty) file.
+  if (size_ > 0) {
+    map = file.map(0, size_);
+  }
+
+  if (map != nullptr) {
+    data_ = reinterpret_cast<const char *>(map); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  else {
+    buffer = file.readAll();
+    if (buffer.size() != size_) {
+      qWarning() << "Could not read all of" << file.fileName();
+      return;
+    }
+    data_ = buffer.constData();
+  }
+
+  valid_ = true;
+}
+
+MappedFile::~MappedFile()
+{
+  if (map != nullptr) {
+    file.unmap(map);
+  }
+}
+
+std::shared_ptr<const MappedFile> MappedFile::open(const QString &file)
+{
+  auto res = std::make_shared<MappedFile>(file);
+  if (!res->valid()) {
+    return nullptr;
+  }
+  return res;
+}
+
+bool MappedFile::valid() const
+{
+  return valid_;
+}
+
+bool MappedFile::isMapped() const
+{
+  return map != nullptr;
+}
+
+QString MappedFile::fileName() const
+{
+  return file.fileName();
+}
+
+const char *MappedFile::data() const
+{
+  return data_;
+}
+
+qint64 MappedFile::size() const
+{
+  return size_;
+}
+
+qint64 MappedFile::currentSize() const
+{
+  // Contents read into memory can't change.
+  if (map == nullptr) {
+    return size_;
+  }
+
+  // The size of the open file is that of the file mapped, even if replaced by another since.
+  return std::min(size_, file.size());
+}
+
+void MappedFile::guardTruncation() const
+{
+#ifdef Q_OS_UNIX
+  if (map == nullptr) return;
+
+  // Bytes past the end within the last page of the file read as zeros already.
+  const qint64 pageSize = sysconf(_SC_PAGESIZE);
+  const auto begin = (currentSize() + pageSize - 1) / pageSize * pageSize;
+  if (begin >= size_) return;
+
+  // Anonymous pages mapped over the range replace the pages of the file in place.
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  if (mmap(map + begin, static_cast<size_t>(size_ - begin), PROT_READ,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+    qWarning() << "Could not guard truncated mapping of" << file.fileName();
+  }
+#endif
+}
+
+bool MappedFile::contains(qint64 offset, qint64 size) const
+{
+  return offset >= 0 && size >= 0 && offset <= size_ && size <= size_ - offset;
+}
+
+QByteArray MappedFile::view(qint64 offset, qint64 size) const
+{
+  if (offset < 0 || offset >= size_ || size <= 0) {
+    return {};
+  }
+
+  size = std::min(size, size_ - offset);
+
+  // QByteArray is limited to int sizes.
+  size = std::min(size, static_cast<qint64>(std::numeric_limits<int>::max()));
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  return QByteArray::fromRawData(data_ + offset, static_cast<int>(size));
+}
+
+QByteArray MappedFile::fingerprint() const
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  const auto addNumber = [&hash](qint64 value) {
+    const auto le = qToLittleEndian(value);
+    hash.addData(reinterpret_cast<const char *>(&le), sizeof(le)); // NOLINT
+  };
+  addNumber(size_);
+  addNumber(QFileInfo(file).lastModified().toMSecsSinceEpoch());
+
+  constexpr qint64 edgeSize = 64 * 1024;
+  constexpr qint64 blockSize = 4 * 1024;
+  constexpr qint64 blocks = 64;
+
+  if (size_ <= 4 * edgeSize) {
+    hash.addData(data_, static_cast<int>(size_));
+  }
+  else {
+    hash.addData(view(0, edgeSize));
+    const qint64 stride = (size_ - 2 * edgeSize) / blocks;
+    for (qint64 i = 0; i < blocks; i++) {
+      hash.addData(view(edgeSize + i * stride, blockSize));
+    }
+    hash.addData(view(size_ - edgeSize, edgeSize));
+  }
+
+  return hash.result().toHex();
+}
+
+} // namespace dispar
@@ -0,0 +1,76 @@
+#ifndef DISPAR_MAPPED_FILE_H
+#define DISPAR_MAPPED_FILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include <memory>
+
+namespace dispar {
+
+/// Read-only memory mapping of a whole file.
+/** If the file cannot be memory-mapped, like compressed Qt resources, the contents are read into
+    memory instead. Either way the bytes are accessible through one contiguous span that stays
+    valid for the lifetime of the instance, so share it via std::shared_ptr when handing out views
+    into it. */
+class MappedFile {
+public:
+  MappedFile(const QString &file);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &other) = delete;
+  MappedFile &operator=(const MappedFile &rhs) = delete;
+
+  MappedFile(MappedFile &&other) = delete;
+  MappedFile &operator=(MappedFile &&rhs) = delete;
+
+  /// Open and map \p file.
+  /** Returns \p nullptr if nonexistent or failed. */
+  static std::shared_ptr<const MappedFile> open(const QString &file);
+
+  [[nodiscard]] bool valid() const;
+
+  /// Whether the contents are memory-mapped or read into memory.
+  [[nodiscard]] bool isMapped() const;
+
+  [[nodiscard]] QString fileName() const;
+
+  [[nodiscard]] const char *data() const;
+  [[nodiscard]] qint64 size() const;
+
+  /// Size of the file now, which is less than size() if it was truncated since being mapped.
+  /** Reading the mapping beyond it faults, so check it before reading a file that may change. */
+  [[nodiscard]] qint64 currentSize() const;
+
+  /// Replaces the mapped pages beyond the current end of a truncated file with zeros.
+  /** Every view into the mapping stays valid but reads zeros past the end instead of faulting, so
+      call it as soon as the file is known to have changed. Nothing is copied, and it does nothing
+      if the contents were read into memory or the file wasn't truncated. */
+  void guardTruncation() const;
+
+  /// Checks that [\p offset, \p offset + \p size) lies within the file.
+  [[nodiscard]] bool contains(qint64 offset, qint64 size) const;
+
+  /// Zero-copy view of \p size bytes from \p offset.
+  /** The range is clamped to the end of the file. The returned array doesn't own its data and
+      must not outlive this instance! Modifying it detaches into a deep copy. */
+  [[nodiscard]] QByteArray view(qint64 offset, qint64 size) const;
+
+  /// Fast fingerprint of the file from its size, modification time and sampled contents.
+  /** Files of up to 256 KB are hashed completely, otherwise the first and last 64 KB and 64 blocks
+      of 4 KB spread evenly in between. Returns a hex-encoded SHA-1 hash. */
+  [[nodiscard]] QByteArray fingerprint() const;
+
+private:
+  QFile file;
+  uchar *map = nullptr;
+  QByteArray buffer;
+  const char *data_ = nullptr;
+  qint64 size_ = 0;
+  bool valid_ = false;
+};
+
+} // namespace dispar
+
+#endif // DISPAR_MAPPED_FILE_H
@@ -1,4 +1,5 @@
 #include "Project.h"
+#include "Util.h"
 #include "cxx.h"
 
 #include <QDebug>
@@ -89,7 +90,9 @@ std::unique_ptr<Project> Project::load(const QString &file)
       const auto val = modsObj[key];
       if (!val.isString()) return nullptr;
 
-      const auto data = QByteArray::fromHex(val.toString().toUtf8());
+      const auto hex = val.toString();
+      const auto data = Util::byteArray(hex);
+      if (data.isEmpty() && !hex.isEmpty()) return nullptr;
       project->addModifiedRegion(addr, data);
     }
   }
@@ -120,7 +123,7 @@ bool Project::save(const QString &path)
 
   QJsonObject modsObj;
   for (const auto addr : modifiedRegions_.keys()) {
-    modsObj[QString::number(addr)] = QString::fromUtf8(modifiedRegions_[addr].toHex());
+    modsObj[QString::number(addr)] = Util::byteArrayString(modifiedRegions_[addr]);
   }
   obj["modifiedRegions"] = modsObj;
 
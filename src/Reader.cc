@@ -1,13 +1,27 @@
 #include "Reader.h"
 #include "Constants.h"
+#include "MappedFile.h"
 
 #include <QByteArray>
 #include <QIODevice>
 
+#include <algorithm>
+#include <array>
+
 namespace dispar {
 
 Reader::Reader(QIODevice &dev_, Constants::Endianness endianness_)
-  : dev(dev_), endianness_(endianness_)
+  : dev(&dev_), endianness_(endianness_)
+{
+}
+
+Reader::Reader(const char *data_, qint64 size_, Constants::Endianness endianness_)
+  : data(data_), size(data_ != nullptr ? size_ : 0), endianness_(endianness_)
+{
+}
+
+Reader::Reader(const MappedFile &file, Constants::Endianness endianness_)
+  : Reader(file.data(), file.size(), endianness_)
 {
 }
 
@@ -36,10 +50,32 @@ quint64 Reader::getUInt64(bool *ok)
   return getUInt<quint64>(ok);
 }
 
+std::vector<quint16> Reader::getUInt16Array(quint32 num, bool *ok)
+{
+  return getUIntArray<quint16>(num, ok);
+}
+
+std::vector<quint32> Reader::getUInt32Array(quint32 num, bool *ok)
+{
+  return getUIntArray<quint32>(num, ok);
+}
+
+std::vector<quint64> Reader::getUInt64Array(quint32 num, bool *ok)
+{
+  return getUIntArray<quint64>(num, ok);
+}
+
 char Reader::getChar(bool *ok)
 {
   char c{0};
-  bool res = dev.getChar(&c);
+  bool res = false;
+  if (dev != nullptr) {
+    res = dev->getChar(&c);
+  }
+  else if (pos_ < size) {
+    c = data[pos_++]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    res = true;
+  }
   if (ok != nullptr) *ok = res;
   return c;
 }
@@ -52,7 +88,14 @@ unsigned char Reader::getUChar(bool *ok)
 char Reader::peekChar(bool *ok)
 {
   char c{0};
-  qint64 num = dev.peek(&c, 1);
+  qint64 num = 0;
+  if (dev != nullptr) {
+    num = dev->peek(&c, 1);
+  }
+  else if (pos_ < size) {
+    c = data[pos_]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    num = 1;
+  }
   if (ok != nullptr) *ok = (num == 1);
   return c;
 }
@@ -64,22 +107,57 @@ unsigned char Reader::peekUChar(bool *ok)
 
 QByteArray Reader::read(qint64 max)
 {
-  return dev.read(max);
+  if (dev != nullptr) {
+    return dev->read(max);
+  }
+
+  const auto view = readView(max);
+  return {view.constData(), view.size()};
+}
+
+QByteArray Reader::readView(qint64 max)
+{
+  if (dev != nullptr) {
+    return dev->read(max);
+  }
+
+  const auto num = std::min(std::max<qint64>(max, 0), size - pos_);
+  if (num <= 0) {
+    return {};
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  auto res = QByteArray::fromRawData(data + pos_, static_cast<int>(num));
+  pos_ += num;
+  return res;
 }
 
 qint64 Reader::pos() const
 {
-  return dev.pos();
+  if (dev != nullptr) {
+    return dev->pos();
+  }
+  return pos_;
 }
 
 bool Reader::seek(qint64 pos)
 {
-  return dev.seek(pos);
+  if (dev != nullptr) {
+    return dev->seek(pos);
+  }
+  if (pos < 0 || pos > size) {
+    return false;
+  }
+  pos_ = pos;
+  return true;
 }
 
 bool Reader::atEnd() const
 {
-  return dev.atEnd();
+  if (dev != nullptr) {
+    return dev->atEnd();
+  }
+  return pos_ >= size;
 }
 
 bool Reader::peekList(std::initializer_list<unsigned char> list)
@@ -88,7 +166,17 @@ bool Reader::peekList(std::initializer_list<unsigned char> list)
     return false;
   }
 
-  const auto parr = dev.peek(list.size());
+  QByteArray parr;
+  if (dev != nullptr) {
+    parr = dev->peek(list.size());
+  }
+  else {
+    const auto num = std::min(static_cast<qint64>(list.size()), size - pos_);
+    if (num > 0) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      parr = QByteArray::fromRawData(data + pos_, static_cast<int>(num));
+    }
+  }
   if (parr.size() != static_cast<qint64>(list.size())) {
     return false;
   }
@@ -103,22 +191,82 @@ bool Reader::peekList(std::initializer_list<unsigned char> list)
   return true;
 }
 
+const unsigned char *Reader::readRaw(qint64 num, unsigned char *buf)
+{
+  if (dev != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (dev->read(reinterpret_cast<char *>(buf), num) < num) {
+      return nullptr;
+    }
+    return buf;
+  }
+
+  if (num > size - pos_) {
+    return nullptr;
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  const auto *res = reinterpret_cast<const unsigned char *>(data + pos_);
+  pos_ += num;
+  return res;
+}
+
+const unsigned char *Reader::readRecord(qint64 num)
+{
+  if (num < 0) {
+    return nullptr;
+  }
+
+  if (dev != nullptr) {
+    // Don't allocate for more than what is left.
+    if (!dev->isSequential() && num > dev->size() - dev->pos()) {
+      return nullptr;
+    }
+    // Keep at least one byte so empty records also get a valid pointer.
+    scratch.resize(static_cast<std::size_t>(std::max<qint64>(num, 1)));
+    return readRaw(num, scratch.data());
+  }
+
+  return readRaw(num, nullptr);
+}
+
 template <typename T>
 T Reader::getUInt(bool *ok)
 {
   constexpr int num = sizeof(T);
-  QByteArray buf = dev.read(num);
-  if (buf.size() < num) {
+  std::array<unsigned char, num> tmp{};
+  const auto *buf = readRaw(num, tmp.data());
+  if (buf == nullptr) {
     if (ok) *ok = false;
     return 0;
   }
-  T res{0};
-  for (int i = 0; i < num; i++) {
-    int j = i;
-    if (endianness_ == Constants::Endianness::Big) {
-      j = num - (i + 1);
-    }
-    res += ((T) static_cast<unsigned char>(buf[i])) << j * 8;
+  if (ok) *ok = true;
+  if (endianness_ == Constants::Endianness::Big) {
+    return qFromBigEndian<T>(buf);
+  }
+  return qFromLittleEndian<T>(buf);
+}
+
+template <typename T>
+std::vector<T> Reader::getUIntArray(quint32 num, bool *ok)
+{
+  if (num == 0) {
+    if (ok) *ok = true;
+    return {};
+  }
+
+  const auto *buf = readRecord(qint64(num) * qint64(sizeof(T)));
+  if (buf == nullptr) {
+    if (ok) *ok = false;
+    return {};
+  }
+
+  std::vector<T> res(num);
+  if (endianness_ == Constants::Endianness::Big) {
+    qFromBigEndian<T>(buf, num, res.data());
+  }
+  else {
+    qFromLittleEndian<T>(buf, num, res.data());
   }
   if (ok) *ok = true;
   return res;
@@ -2,16 +2,89 @@
 #define DISPAR_READER_H
 
 #include "Constants.h"
+#include "cxx.h"
+
+#include <QtEndian>
 #include <QtGlobal>
 
+#include <vector>
+
 class QIODevice;
 class QByteArray;
 
 namespace dispar {
 
+class MappedFile;
+
+/// Reads values from either a device or a bounds-checked span of memory.
+/** The span mode doesn't copy anything when reading, so it is preferred for big files. The span
+    must outlive the reader. */
 class Reader {
 public:
   Reader(QIODevice &dev, Constants::Endianness endianness = Constants::Endianness::Little);
+  Reader(const char *data, qint64 size,
+         Constants::Endianness endianness = Constants::Endianness::Little);
+  Reader(const MappedFile &file, Constants::Endianness endianness = Constants::Endianness::Little);
+
+  /// Fixed-size record whose fields are decoded with byte order \p E fixed at compile time.
+  /** Bounds are checked once when the record is read, so field access isn't checked (except by
+      assertion). A record is only valid until the next read on the reader that produced it. */
+  template <Constants::Endianness E>
+  class Record {
+  public:
+    Record() = default;
+    Record(const unsigned char *data, qint64 size) : data_(data), size_(size)
+    {
+    }
+
+    [[nodiscard]] qint64 size() const
+    {
+      return size_;
+    }
+
+    /// Decode value of type \p T at byte \p offset of the record.
+    template <typename T>
+    [[nodiscard]] T get(qint64 offset) const
+    {
+      ASSERT_X(offset >= 0 && offset + qint64(sizeof(T)) <= size_, "Field outside of record");
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      const auto *ptr = data_ + offset;
+      if constexpr (E == Constants::Endianness::Big) {
+        return qFromBigEndian<T>(ptr);
+      }
+      else {
+        return qFromLittleEndian<T>(ptr);
+      }
+    }
+
+    /// Raw bytes at \p offset of the record, like fixed-size names.
+    [[nodiscard]] QByteArray bytes(qint64 offset, int size) const
+    {
+      ASSERT_X(offset >= 0 && offset + size <= size_, "Bytes outside of record");
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      return {reinterpret_cast<const char *>(data_ + offset), size};
+    }
+
+  private:
+    const unsigned char *data_ = nullptr;
+    qint64 size_ = 0;
+  };
+
+  using LittleRecord = Record<Constants::Endianness::Little>;
+  using BigRecord = Record<Constants::Endianness::Big>;
+
+  /// Read \p size bytes as one record.
+  /** Returns false if not enough bytes were available. */
+  template <Constants::Endianness E>
+  bool getRecord(qint64 size, Record<E> &record)
+  {
+    const auto *buf = readRecord(size);
+    if (buf == nullptr) {
+      return false;
+    }
+    record = Record<E>(buf, size);
+    return true;
+  }
 
   [[nodiscard]] Constants::Endianness endianness() const;
 
@@ -26,6 +99,14 @@ public:
   /// Read 8 bytes = 64 bits.
   quint64 getUInt64(bool *ok = nullptr);
 
+  /// Read \p num consecutive values with only one bounds check and byte order branch.
+  /** Returns an empty list, and sets \p ok to false, if not enough bytes were available. */
+  //@{
+  std::vector<quint16> getUInt16Array(quint32 num, bool *ok = nullptr);
+  std::vector<quint32> getUInt32Array(quint32 num, bool *ok = nullptr);
+  std::vector<quint64> getUInt64Array(quint32 num, bool *ok = nullptr);
+  //@}
+
   char getChar(bool *ok = nullptr);
   unsigned char getUChar(bool *ok = nullptr);
   char peekChar(bool *ok = nullptr);
@@ -33,6 +114,10 @@ public:
 
   QByteArray read(qint64 max);
 
+  /// Like read() but yields a zero-copy view in span mode.
+  /** The view must not outlive the span! In device mode it is the same as read(). */
+  QByteArray readView(qint64 max);
+
   [[nodiscard]] qint64 pos() const;
   bool seek(qint64 pos);
   [[nodiscard]] bool atEnd() const;
@@ -43,7 +128,21 @@ private:
   template <typename T>
   T getUInt(bool *ok = nullptr);
 
-  QIODevice &dev;
+  template <typename T>
+  std::vector<T> getUIntArray(quint32 num, bool *ok = nullptr);
+
+  /// Reads \p num bytes into \p buf, or returns a pointer directly into the span.
+  /** Returns \p nullptr if \p num bytes weren't available. */
+  const unsigned char *readRaw(qint64 num, unsigned char *buf);
+
+  /// Like readRaw() but reads into an internal scratch buffer in device mode.
+  /** The result is valid until the next call. */
+  const unsigned char *readRecord(qint64 num);
+
+  QIODevice *dev = nullptr;
+  const char *data = nullptr;
+  qint64 size = 0, pos_ = 0;
+  std::vector<unsigned char> scratch;
   Constants::Endianness endianness_;
 };
 
@@ -1,6 +1,8 @@
 #include "Section.h"
+#include "MappedFile.h"
 
 #include <QCryptographicHash>
+#include <QMutexLocker>
 #include <QObject>
 
 namespace dispar {
@@ -76,6 +78,12 @@ QString Section::typeName(Type type)
 
   case Section::Type::LC_VERSION_MIN_TVOS:
     return QObject::tr("LC_VERSION_MIN_TVOS");
+
+  case Section::Type::OTHER:
+    return QObject::tr("Other");
+
+  case Section::Type::SEGMENT:
+    return QObject::tr("Segment");
   }
 
   return {};
@@ -118,16 +126,57 @@ bool Section::hasAddress(quint64 address) const
 
 const QByteArray &Section::data() const
 {
+  if (!dataLoaded.load(std::memory_order_acquire)) {
+    QMutexLocker locker(&dataMutex);
+    if (!dataLoaded.load(std::memory_order_relaxed)) {
+      data_ = mapping->view(offset(), size());
+      dataLoaded.store(true, std::memory_order_release);
+    }
+  }
   return data_;
 }
 
 void Section::setData(const QByteArray &data)
 {
+  QMutexLocker locker(&dataMutex);
   data_ = data;
+  dataLoaded = true;
+  mapping.reset();
+  hash_.clear();
+}
+
+void Section::mapData(std::shared_ptr<const MappedFile> file)
+{
+  if (!file) {
+    setData({});
+    return;
+  }
+
+  QMutexLocker locker(&dataMutex);
+
+  // Drop any view before releasing the previous mapping it could refer to.
+  data_.clear();
+  mapping = std::move(file);
+  dataLoaded = false;
+  hash_.clear();
+}
+
+bool Section::isDataLoaded() const
+{
+  return dataLoaded;
+}
+
+bool Section::isMapped() const
+{
+  QMutexLocker locker(&dataMutex);
+  return mapping != nullptr;
 }
 
 void Section::setSubData(const QByteArray &subData, int pos)
 {
+  // Materialize deferred data before modifying it.
+  (void) data();
+
   assert(subData.size() <= data_.size());
 
   if (pos < 0 || pos > data_.size() - 1 || subData.size() > data_.size()) {
@@ -137,6 +186,20 @@ void Section::setSubData(const QByteArray &subData, int pos)
   data_.replace(pos, subData.size(), subData);
   modified = QDateTime::currentDateTime();
 
+  // Mapped data is hashed as in the file.
+  if (!mapping) {
+    hash_.clear();
+  }
+
+  // Only the instructions overlapping the patch need decoding again.
+  if (disasm_) {
+    disasm_->patch(disasm_->baseAddress() + quint64(pos), subData);
+  }
+
+  // Instructions known from before might no longer start where they did.
+  instructionOffsets_.clear();
+  instructionOffsets_.shrink_to_fit();
+
   const ModifiedRegion region{pos, subData};
   modifiedRegions_ << region;
 
@@ -172,6 +235,29 @@ const QList<Section::ModifiedRegion> &Section::modifiedRegions() const
   return modifiedRegions_;
 }
 
+QByteArray Section::hash() const
+{
+  // Hash without holding the lock, which data() might be waiting for, but keep the mapping alive.
+  std::shared_ptr<const MappedFile> file;
+  QByteArray data;
+  {
+    QMutexLocker locker(&dataMutex);
+    if (!hash_.isEmpty()) {
+      return hash_;
+    }
+    file = mapping;
+    data = file ? file->view(offset(), static_cast<qint64>(size())) : data_;
+  }
+
+  const auto hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+  QMutexLocker locker(&dataMutex);
+  if (hash_.isEmpty()) {
+    hash_ = hash;
+  }
+  return hash_;
+}
+
 void Section::setDisassembly(std::unique_ptr<Disassembler::Result> disasm)
 {
   disasm_ = std::move(disasm);
@@ -182,4 +268,19 @@ Disassembler::Result *Section::disassembly() const
   return disasm_.get();
 }
 
+std::unique_ptr<Disassembler::Result> Section::takeDisassembly()
+{
+  return std::move(disasm_);
+}
+
+void Section::setInstructionOffsets(std::vector<quint32> offsets)
+{
+  instructionOffsets_ = std::move(offsets);
+}
+
+const std::vector<quint32> &Section::instructionOffsets() const
+{
+  return instructionOffsets_;
+}
+
 } // namespace dispar
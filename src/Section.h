@@ -4,14 +4,19 @@
 #include <QByteArray>
 #include <QDateTime>
 #include <QList>
+#include <QMutex>
 #include <QString>
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "Disassembler.h"
 
 namespace dispar {
 
+class MappedFile;
+
 class Section {
 public:
   enum class Type : int {
@@ -27,6 +32,8 @@ public:
     LC_VERSION_MIN_IPHONEOS, ///< iOS SDK min version (load command).
     LC_VERSION_MIN_WATCHOS,  ///< watchOS SDK min version (load command).
     LC_VERSION_MIN_TVOS,     ///< tvOS SDK min version (load command).
+    OTHER,                   ///< Any other section of a segment (__DATA,__data etc.).
+    SEGMENT,                 ///< Uncovered part of a segment without sections (__LINKEDIT).
   };
 
   /// Modified region indicates where and how much data was changed but doesn't contain the data
@@ -60,27 +67,59 @@ public:
 
   [[nodiscard]] bool hasAddress(quint64 address) const;
 
+  /// Get data of section, which is materialized on first access if deferred by mapData().
   [[nodiscard]] const QByteArray &data() const;
   void setData(const QByteArray &data);
 
+  /// Defer data to a zero-copy view of the section's region in \p file.
+  /** Nothing is read until data() is first called. The mapping is kept alive for as long as the
+      section references it. Modifying the data detaches it into a private copy. */
+  void mapData(std::shared_ptr<const MappedFile> file);
+
+  /// Whether data has been materialized, or wasn't deferred in the first place.
+  [[nodiscard]] bool isDataLoaded() const;
+
+  /// Whether data is a view of a mapped file, as opposed to set explicitly or absent.
+  [[nodiscard]] bool isMapped() const;
+
+  /// Replaces data at \p pos with \p subData.
+  /** The disassembly, if any, is patched too and must be decoded again with
+      Disassembler::redisassemble(). */
   void setSubData(const QByteArray &subData, int pos);
   [[nodiscard]] bool isModified() const;
   [[nodiscard]] QDateTime modifiedWhen() const;
   [[nodiscard]] const QList<ModifiedRegion> &modifiedRegions() const;
 
+  /// SHA-1 hash of the data as in the file if mapped, without modifications, or as it is otherwise.
+  /** It is computed on first call and kept until the data is replaced. */
+  [[nodiscard]] QByteArray hash() const;
+
   /// Takes ownership of \p disasm.
   void setDisassembly(std::unique_ptr<Disassembler::Result> disasm);
   [[nodiscard]] Disassembler::Result *disassembly() const;
 
+  /// Releases ownership of the disassembly.
+  std::unique_ptr<Disassembler::Result> takeDisassembly();
+
+  /// Offsets of instructions that are known without disassembling, like from the analysis cache.
+  /** They are cleared when the data is modified. */
+  void setInstructionOffsets(std::vector<quint32> offsets);
+  [[nodiscard]] const std::vector<quint32> &instructionOffsets() const;
+
 private:
   Type type_;
   QString name_;
   quint64 addr, size_;
   quint32 offset_;
-  QByteArray data_;
+  mutable QByteArray data_;
+  mutable std::atomic_bool dataLoaded{true};
+  mutable QMutex dataMutex;
+  mutable QByteArray hash_;
+  std::shared_ptr<const MappedFile> mapping;
   QList<ModifiedRegion> modifiedRegions_;
   QDateTime modified;
   std::unique_ptr<Disassembler::Result> disasm_;
+  std::vector<quint32> instructionOffsets_;
 };
 
 } // namespace dispar
@@ -0,0 +1,216 @@
+#include "StringExtractor.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+namespace dispar {
+
+namespace {
+
+constexpr quint64 ones = 0x0101010101010101ULL, highBits = 0x8080808080808080ULL;
+
+/// Space to tilde, and tab.
+constexpr bool isPrintable(uchar ch)
+{
+  return (ch >= 0x20 && ch <= 0x7E) || ch == '\t';
+}
+
+/// Whether all bytes of \p word are from space to tilde.
+constexpr bool isPrintable(quint64 word)
+{
+  const auto below = (word - ones * 0x20) & ~word & highBits;  // Some byte below 0x20.
+  const auto above = ((word + ones * (0x80 - 0x7F)) | word) & highBits; // Some byte above 0x7E.
+  return (below | above) == 0;
+}
+
+/// End of the run of printable bytes at \p pos.
+qint64 asciiRunEnd(const uchar *data, qint64 pos, qint64 size)
+{
+  while (pos + 8 <= size) {
+    quint64 word = 0;
+    std::memcpy(&word, data + pos, sizeof(word)); // NOLINT
+    if (!isPrintable(word)) break;
+    pos += 8;
+  }
+  while (pos < size && isPrintable(data[pos])) { // NOLINT
+    pos++;
+  }
+  return pos;
+}
+
+/// Whether the 16-bit code unit at \p pos is printable.
+bool isPrintable(const uchar *data, qint64 pos, qint64 size, bool littleEndian)
+{
+  if (pos + 1 >= size) {
+    return false;
+  }
+  const auto *unit = data + pos; // NOLINT
+  return littleEndian ? unit[1] == 0 && isPrintable(unit[0])  // NOLINT
+                      : unit[0] == 0 && isPrintable(unit[1]); // NOLINT
+}
+
+/// End of the run of printable 16-bit code units at \p pos.
+qint64 utf16RunEnd(const uchar *data, qint64 pos, qint64 size, bool littleEndian)
+{
+  while (isPrintable(data, pos, size, littleEndian)) {
+    pos += 2;
+  }
+  return pos;
+}
+
+} // namespace
+
+bool StringExtractor::Entry::operator==(const Entry &rhs) const
+{
+  return offset == rhs.offset && length == rhs.length && encoding == rhs.encoding;
+}
+
+StringExtractor::StringExtractor(int minLength, Encodings encodings)
+  : minLength_(std::max(minLength, 1)), encodings_(encodings)
+{
+}
+
+int StringExtractor::minLength() const
+{
+  return minLength_;
+}
+
+StringExtractor::Encodings StringExtractor::encodings() const
+{
+  return encodings_;
+}
+
+std::vector<StringExtractor::Entry> StringExtractor::extract(const QByteArray &data,
+                                                             const std::atomic_bool *canceled) const
+{
+  const qint64 size = data.size();
+  const int threads = QThread::idealThreadCount();
+
+  // Split into chunks of at least the minimum size but enough to keep all threads busy.
+  const auto chunkSize = std::max(minChunkSize, size / (std::max(threads, 1) * 4));
+  std::vector<std::pair<qint64, qint64>> chunks; // [start, end)
+  for (qint64 start = 0; start < size; start += chunkSize) {
+    chunks.emplace_back(start, std::min(start + chunkSize, size));
+  }
+
+  std::vector<std::vector<Entry>> results(chunks.size());
+  std::atomic_size_t next{0};
+  const auto work = [this, &data, &chunks, &results, &next, canceled] {
+    for (auto i = next++; i < chunks.size(); i = next++) {
+      if (canceled != nullptr && *canceled) return;
+      extract(data, chunks[i].first, chunks[i].second, results[i], canceled);
+    }
+  };
+
+  if (chunks.size() < 2 || threads < 2) {
+    work();
+  }
+  else {
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::min(threads, static_cast<int>(chunks.size())));
+    for (int i = 0; i < pool.maxThreadCount(); i++) {
+      pool.start(work);
+    }
+    pool.waitForDone();
+  }
+
+  // Each chunk has the strings starting in it, so they stay ordered when concatenated.
+  std::vector<Entry> res;
+  size_t count = 0;
+  for (const auto &result : results) {
+    count += result.size();
+  }
+  res.reserve(count);
+  for (const auto &result : results) {
+    res.insert(res.end(), result.cbegin(), result.cend());
+  }
+  return res;
+}
+
+QString StringExtractor::string(const QByteArray &data, const Entry &entry)
+{
+  const auto *bytes = data.constData() + entry.offset; // NOLINT
+  const auto length = static_cast<int>(entry.length);
+  if (entry.encoding == Encoding::ASCII) {
+    return QString::fromLatin1(bytes, length);
+  }
+
+  // Only code units with a zero high byte are extracted, so the low bytes are Latin-1.
+  const int low = entry.encoding == Encoding::UTF16_LE ? 0 : 1;
+  QString res(length, Qt::Uninitialized);
+  for (int i = 0; i < length; i++) {
+    res[i] = QLatin1Char(bytes[i * 2 + low]); // NOLINT
+  }
+  return res;
+}
+
+void StringExtractor::extract(const QByteArray &data, qint64 begin, qint64 end,
+                              std::vector<Entry> &entries, const std::atomic_bool *canceled) const
+{
+  const auto isCanceled = [canceled] {
+    return canceled != nullptr && canceled->load(std::memory_order_relaxed);
+  };
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+  const qint64 size = data.size();
+
+  if (encodings_.testFlag(Encoding::ASCII)) {
+    auto pos = begin;
+
+    // A run continuing from before belongs to the previous chunk.
+    if (pos > 0 && isPrintable(bytes[pos - 1])) { // NOLINT
+      pos = asciiRunEnd(bytes, pos, size);
+    }
+
+    while (pos < end) {
+      if (!isPrintable(bytes[pos])) { // NOLINT
+        pos++;
+        continue;
+      }
+      if (isCanceled()) return;
+      const auto runEnd = asciiRunEnd(bytes, pos, size);
+      if (runEnd - pos >= minLength_) {
+        entries.push_back(
+          {quint64(pos), static_cast<quint32>(runEnd - pos), Encoding::ASCII});
+      }
+      pos = runEnd;
+    }
+  }
+
+  // Strings of 16-bit code units can start at both even and odd offsets.
+  for (const auto encoding : {Encoding::UTF16_LE, Encoding::UTF16_BE}) {
+    if (!encodings_.testFlag(encoding)) continue;
+    const bool littleEndian = encoding == Encoding::UTF16_LE;
+
+    for (qint64 parity = 0; parity < 2; parity++) {
+      auto pos = begin + (begin % 2 == parity ? 0 : 1);
+      if (pos >= 2 && isPrintable(bytes, pos - 2, size, littleEndian)) {
+        pos = utf16RunEnd(bytes, pos, size, littleEndian);
+      }
+
+      while (pos < end) {
+        if (!isPrintable(bytes, pos, size, littleEndian)) {
+          pos += 2;
+          continue;
+        }
+        if (isCanceled()) return;
+        const auto runEnd = utf16RunEnd(bytes, pos, size, littleEndian);
+        if ((runEnd - pos) / 2 >= minLength_) {
+          entries.push_back({quint64(pos), static_cast<quint32>((runEnd - pos) / 2), encoding});
+        }
+        pos = runEnd;
+      }
+    }
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const auto &a, const auto &b) { return a.offset < b.offset; });
+}
+
+} // namespace dispar
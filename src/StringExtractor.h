@@ -0,0 +1,68 @@
+#ifndef DISPAR_STRING_EXTRACTOR_H
+#define DISPAR_STRING_EXTRACTOR_H
+
+#include <QByteArray>
+#include <QFlags>
+#include <QString>
+
+#include <atomic>
+#include <vector>
+
+#include "Constants.h"
+
+namespace dispar {
+
+/// Extracts runs of printable characters from arbitrary data, like the strings utility.
+/** Printable characters are those of ASCII from space to tilde, and tab. Runs are detected a word
+    of 8 bytes at a time where possible, and large data is split into chunks that are scanned
+    concurrently. A run crossing chunks belongs to the chunk it starts in. */
+class StringExtractor {
+public:
+  enum class Encoding : int {
+    ASCII = 1 << 0,    ///< Single bytes.
+    UTF16_LE = 1 << 1, ///< Little-endian 16-bit code units with a zero high byte.
+    UTF16_BE = 1 << 2, ///< Big-endian 16-bit code units with a zero high byte.
+  };
+  Q_DECLARE_FLAGS(Encodings, Encoding)
+
+  struct Entry {
+    quint64 offset = 0;
+    quint32 length = 0; ///< In characters.
+    Encoding encoding = Encoding::ASCII;
+
+    bool operator==(const Entry &rhs) const;
+  };
+
+  /// Data smaller than this is always scanned by one thread.
+  static constexpr qint64 minChunkSize = 1024 * 1024;
+
+  StringExtractor(int minLength = Constants::Strings::DEFAULT_MIN_LENGTH,
+                  Encodings encodings = Encodings(Encoding::ASCII) | Encoding::UTF16_LE);
+
+  [[nodiscard]] int minLength() const;
+  [[nodiscard]] Encodings encodings() const;
+
+  /// Strings of at least the minimum length in \p data, ordered by offset.
+  /** Scanning stops at the next run of characters once \p canceled is set, if given, and only
+      some of the strings are returned then. */
+  [[nodiscard]] std::vector<Entry> extract(const QByteArray &data,
+                                           const std::atomic_bool *canceled = nullptr) const;
+
+  /// String of \p entry in \p data.
+  static QString string(const QByteArray &data, const Entry &entry);
+
+private:
+  /// Appends strings starting in [\p begin, \p end) of \p data to \p entries.
+  /** Returns early if \p canceled is set. */
+  void extract(const QByteArray &data, qint64 begin, qint64 end, std::vector<Entry> &entries,
+               const std::atomic_bool *canceled) const;
+
+  int minLength_;
+  Encodings encodings_;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(StringExtractor::Encodings)
+
+} // namespace dispar
+
+#endif // DISPAR_STRING_EXTRACTOR_H
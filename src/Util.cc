@@ -1,5 +1,6 @@
 #include "Util.h"
 #include "BinaryObject.h"
+#include "HexDump.h"
 #include "formats/Format.h"
 
 #include <QAbstractScrollArea>
@@ -12,13 +13,20 @@
 #include <QScreen>
 #include <QScrollBar>
 #include <QStringList>
+#include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QTreeWidgetItem>
 #include <QXmlStreamReader>
 
+#include <QtAlgorithms>
+#include <QtEndian>
+
 #include <array>
-#include <cctype>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <optional>
 #include <utility>
 
 #include "libiberty/demangle.h"
@@ -105,6 +113,48 @@ QString Util::hexToUnicode(const QString &str)
   return res;
 }
 
+namespace {
+
+/// Two hex digits of every byte, as UTF-16 code units laid out like in a QString buffer.
+constexpr std::array<quint32, 256> hexPairs(bool uppercase)
+{
+  std::array<quint32, 256> res{};
+  const char *digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+  for (unsigned i = 0; i < res.size(); i++) {
+    const quint32 high = digits[i >> 4], low = digits[i & 0xF]; // NOLINT
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    res[i] = high | low << 16;
+#else
+    res[i] = high << 16 | low;
+#endif
+  }
+  return res;
+}
+
+constexpr auto lowerHexPairs = hexPairs(false), upperHexPairs = hexPairs(true);
+
+/// Value of hex digits and `invalidNibble` for all other Latin-1 characters.
+constexpr uchar invalidNibble = 0xF0;
+constexpr std::array<uchar, 256> nibbles = [] {
+  std::array<uchar, 256> res{};
+  for (unsigned i = 0; i < res.size(); i++) {
+    res[i] = i >= '0' && i <= '9'   ? i - '0'
+             : i >= 'a' && i <= 'f' ? i - 'a' + 10
+             : i >= 'A' && i <= 'F' ? i - 'A' + 10
+                                    : invalidNibble;
+  }
+  return res;
+}();
+
+/// Value of hex digit \p ch, or `invalidNibble` if it isn't one.
+inline uchar nibble(QChar ch)
+{
+  // Characters beyond Latin-1 map to 0xFF which isn't a hex digit either.
+  return nibbles[std::min<ushort>(ch.unicode(), 0xFF)];
+}
+
+} // namespace
+
 QString Util::hexToString(const QString &str)
 {
   return QString::fromUtf8(hexToData(str));
@@ -112,21 +162,52 @@ QString Util::hexToString(const QString &str)
 
 QByteArray Util::hexToData(const QString &str)
 {
-  QByteArray data;
-  int size = str.size();
-  bool ok = false;
-  for (int i = 0; i < size; i += 2) {
-    data += str.mid(i, 2).toInt(&ok, 16);
-    if (!ok) return QByteArray();
+  const int size = str.size();
+  QByteArray data((size + 1) / 2, Qt::Uninitialized);
+  const auto *in = str.constData();
+  auto *out = data.data();
+
+  // Validity is accumulated and checked once at the end to keep the loop free of branches.
+  uchar invalid = 0;
+  int i = 0;
+  for (; i + 1 < size; i += 2) {
+    const auto high = nibble(in[i]), low = nibble(in[i + 1]); // NOLINT
+    invalid |= high | low;
+    out[i / 2] = char(high << 4 | low); // NOLINT
+  }
+
+  // A lone trailing digit is the value of that digit.
+  if (i < size) {
+    const auto low = nibble(in[i]); // NOLINT
+    invalid |= low;
+    out[i / 2] = char(low); // NOLINT
+  }
+
+  if ((invalid & invalidNibble) != 0) {
+    return {};
   }
   return data;
 }
 
-QString Util::bytesToHex(const unsigned char *bytes, int size)
+QString Util::bytesToHex(const unsigned char *bytes, int size, char separator, bool uppercase)
 {
-  QString res;
-  for (int j = 0; j < size; j++) {
-    res += padString(QString::number(bytes[j], 16), 2, true, '0') + (j < size - 1 ? " " : "");
+  if (size <= 0) {
+    return {};
+  }
+
+  const auto &pairs = uppercase ? upperHexPairs : lowerHexPairs;
+  const int stride = separator != 0 ? 3 : 2;
+  QString res(size * stride - (stride - 2), Qt::Uninitialized);
+  auto *out = res.data();
+
+  // Each byte is written as one 32-bit store of its two code units.
+  for (int i = 0; i < size; i++) {
+    std::memcpy(out + i * stride, &pairs[bytes[i]], sizeof(quint32)); // NOLINT
+  }
+  if (separator != 0) {
+    for (int i = 0; i < size - 1; i++) {
+      out[i * stride + 2] = QLatin1Char(separator); // NOLINT
+    }
   }
   return res;
 }
@@ -231,50 +312,7 @@ void Util::resizeRatioOfScreen(QWidget *widget, float percentage, const QSize &m
 
 QString Util::addrDataString(quint64 addr, QByteArray data)
 {
-  QString output, ascii;
-  QStringList lines;
-
-  const auto addLine = [&](const QString &line) {
-    lines.append(QString::number(addr, 16).toUpper() + ": " + line);
-  };
-
-  for (int i = 0, j = 0; i < data.size(); ++i) {
-    char c = data[i];
-    int ic = c;
-    unsigned char uc = c;
-    QString hc = QString::number(uc, 16).toUpper();
-    if (hc.size() == 1) {
-      hc = "0" + hc;
-    }
-    output += hc + " ";
-
-    // Put an extra space in the middle of the hex data to show the low and high parts.
-    if (j++ == 7) {
-      output += " ";
-    }
-
-    ascii += (std::isgraph(ic) > 0 ? c : '.');
-    if ((i + 1) % 16 == 0 || i == data.size() - 1) {
-      // If hex amount is < 16 blocks (including extra spaces) then pad with spaces, not zeros.
-      if (const auto n = output.size(), max = 16 * 2 + 16 + 1; n < max) {
-        output += QString(max - n, ' ');
-      }
-
-      output += "  " + ascii;
-      ascii.clear();
-      if (i != data.size() - 1) {
-        addLine(output);
-        addr += 16;
-        output.clear();
-        j = 0;
-      }
-    }
-  }
-
-  // Add the last line.
-  addLine(output);
-
-  return lines.join("\n");
+  return HexDump(data, addr).text();
 }
 
 void Util::scrollToTop(QAbstractScrollArea *widget)
@@ -287,15 +325,12 @@ void Util::scrollToTop(QAbstractScrollArea *widget)
   });
 }
 
-QString Util::demangle(const QString &name)
-{
-#ifdef WIN
-  return name;
-#else
-  if (name.isEmpty()) {
-    return name;
-  }
+namespace {
 
+#ifndef WIN
+/// Demangles \p name in demangling \p style, or the current style if zero.
+std::optional<QString> demangleWith(const QString &name, int style)
+{
   // Skip leading . or $.
   int skip = 0;
   if (name[0] == '.' || name[0] == '$') {
@@ -308,7 +343,7 @@ QString Util::demangle(const QString &name)
   }
 
   const auto mangledName = name.mid(skip).toUtf8();
-  const int flags = DMGL_PARAMS | DMGL_ANSI | DMGL_VERBOSE;
+  const int flags = DMGL_PARAMS | DMGL_ANSI | DMGL_VERBOSE | style;
 
   // Demangled char* result must be freed instead of deleted!
   const auto deleter = [](char *c) {
@@ -320,8 +355,67 @@ QString Util::demangle(const QString &name)
       demangled != nullptr) {
     return QString::fromUtf8(demangled.get());
   }
+  return std::nullopt;
+}
+#endif
 
+} // namespace
+
+QString Util::demangle(const QString &name)
+{
+#ifdef WIN
   return name;
+#else
+  if (name.isEmpty()) {
+    return name;
+  }
+  return demangleWith(name, 0).value_or(name);
+#endif
+}
+
+std::vector<QString> Util::demangleAll(const std::vector<QString> &names)
+{
+#ifdef WIN
+  return names;
+#else
+  std::vector<std::optional<QString>> demangled(names.size());
+
+  // Only the GNU v3 demangler is reentrant, so names are first demangled by it in chunks that each
+  // thread takes the next of until none are left.
+  constexpr std::size_t chunkSize = 1024;
+  const auto chunks = (names.size() + chunkSize - 1) / chunkSize;
+  std::atomic_size_t next{0};
+  const auto work = [&names, &demangled, &next, chunks] {
+    for (auto chunk = next++; chunk < chunks; chunk = next++) {
+      const auto end = std::min(names.size(), (chunk + 1) * chunkSize);
+      for (auto i = chunk * chunkSize; i < end; i++) {
+        if (!names[i].isEmpty()) {
+          demangled[i] = demangleWith(names[i], DMGL_GNU_V3);
+        }
+      }
+    }
+  };
+
+  const int threads = std::min(QThread::idealThreadCount(), static_cast<int>(chunks));
+  if (threads < 2) {
+    work();
+  }
+  else {
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int i = 0; i < threads; i++) {
+      pool.start(work);
+    }
+    pool.waitForDone();
+  }
+
+  // The rest might be in other styles.
+  std::vector<QString> res;
+  res.reserve(names.size());
+  for (std::size_t i = 0; i < names.size(); i++) {
+    res.push_back(demangled[i] ? *demangled[i] : demangle(names[i]));
+  }
+  return res;
 #endif
 }
 
@@ -396,12 +490,13 @@ void Util::setTreeItemMarked(QTreeWidgetItem *item, int column)
 
 QString Util::byteArrayString(const QByteArray &array)
 {
-  return QString::fromLatin1(array.toHex());
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return bytesToHex(reinterpret_cast<const unsigned char *>(array.constData()), array.size(), 0);
 }
 
 QByteArray Util::byteArray(const QString &value)
 {
-  return QByteArray::fromHex(value.toLatin1());
+  return hexToData(value);
 }
 
 QString Util::escapeWhitespace(QString value)
@@ -441,4 +536,67 @@ QByteArray Util::longToData(const unsigned long n)
   return data;
 }
 
+std::vector<quint64> Util::decodeUleb128(const QByteArray &data, bool *ok)
+{
+  std::vector<quint64> values;
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+  const auto size = static_cast<size_t>(data.size());
+
+  // Slow path of one byte at a time.
+  const auto decodeOne = [&](size_t &pos) {
+    quint64 value = 0;
+    for (int shift = 0; pos < size; shift += 7) {
+      const auto byte = bytes[pos++]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      if (shift < 64) {
+        value |= quint64(byte & 0x7F) << shift;
+      }
+      if ((byte & 0x80) == 0) {
+        values.push_back(value);
+        return true;
+      }
+    }
+    return false;
+  };
+
+  constexpr quint64 highBits = 0x8080808080808080ULL;
+  size_t pos = 0;
+  bool complete = true;
+  while (pos + 8 <= size && complete) {
+    quint64 word = 0;
+    std::memcpy(&word, bytes + pos, sizeof(word)); // NOLINT
+    word = qFromLittleEndian(word);
+
+    // Bytes ending values have the high bit clear.
+    auto ends = ~word & highBits;
+    if (ends == 0) {
+      complete = decodeOne(pos);
+      continue;
+    }
+
+    int start = 0;
+    while (ends != 0) {
+      const int end = static_cast<int>(qCountTrailingZeroBits(ends)) / 8;
+      const auto bits = word >> (start * 8);
+      quint64 value = 0;
+      for (int i = 0; i <= end - start; i++) {
+        value |= ((bits >> (i * 8)) & 0x7F) << (i * 7);
+      }
+      values.push_back(value);
+      start = end + 1;
+      ends &= ends - 1;
+    }
+    pos += static_cast<size_t>(start);
+  }
+
+  while (pos < size && complete) {
+    complete = decodeOne(pos);
+  }
+  if (ok != nullptr) {
+    *ok = complete;
+  }
+  return values;
+}
+
 } // namespace dispar
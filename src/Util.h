@@ -9,6 +9,7 @@
 #include <functional>
 #include <iterator>
 #include <tuple>
+#include <vector>
 
 #include "CpuType.h"
 #include "cxx.h"
@@ -34,9 +35,16 @@ public:
                             bool unicode = false);
   static QString hexToUnicode(const QString &str);
   static QString hexToString(const QString &str);
+
+  /// Decodes pairs of hex digits of \p str, where a lone trailing digit is a byte of its own.
+  /** Digits are looked up in a table and validated once for the whole string. Returns an empty
+      byte array if \p str contains anything but hex digits. */
   static QByteArray hexToData(const QString &str);
 
-  static QString bytesToHex(const unsigned char *bytes, int size);
+  /// Encodes \p bytes as pairs of hex digits, separated by \p separator unless it is zero.
+  /** Digit pairs are taken from a table and written directly into the result. */
+  static QString bytesToHex(const unsigned char *bytes, int size, char separator = ' ',
+                            bool uppercase = false);
 
   /// If \p path is an .app it tries to resolve the binary inside.
   /** If it fails, it will return \p path. */
@@ -68,6 +76,9 @@ public:
   /// Demangle ABI identifier.
   static QString demangle(const QString &name);
 
+  /// Demangle all of \p names concurrently, in the same order.
+  static std::vector<QString> demangleAll(const std::vector<QString> &names);
+
   static void delayFunc(std::function<void()> func);
 
   static CpuType currentCpuType();
@@ -119,6 +130,12 @@ public:
   static quint32 encodeMacSdkVersion(const std::tuple<int, int> &version);
 
   static QByteArray longToData(unsigned long n);
+
+  /// Decodes all ULEB128 values of \p data.
+  /** Eight bytes are scanned at a time for the ends of values, which is where all but the last
+      byte has its high bit clear, instead of testing every byte on its own. Bits beyond 64 are
+      dropped. \p ok, if specified, is false if the last value is truncated, and it is left out. */
+  static std::vector<quint64> decodeUleb128(const QByteArray &data, bool *ok = nullptr);
 };
 
 } // namespace dispar
@@ -0,0 +1,339 @@
+#include "X86LengthDecoder.h"
+
+#include <algorithm>
+#include <array>
+
+namespace dispar {
+
+namespace {
+
+// Properties of opcodes.
+constexpr quint16 modRm = 1 << 0;
+constexpr quint16 imm8 = 1 << 1;
+constexpr quint16 imm16 = 1 << 2;
+constexpr quint16 immZ = 1 << 3;      ///< 16 or 32 bits depending on the operand size.
+constexpr quint16 immV = 1 << 4;      ///< 16, 32, or 64 bits depending on the operand size.
+constexpr quint16 moffs = 1 << 5;     ///< Offset of the address size.
+constexpr quint16 regOnly = 1 << 6;   ///< ModR/M always denotes registers regardless of the mode.
+constexpr quint16 prefix = 1 << 7;    ///< Legacy prefix.
+constexpr quint16 invalid = 1 << 8;   ///< Invalid in all modes.
+constexpr quint16 invalid64 = 1 << 9; ///< Invalid in 64-bit mode.
+
+using OpcodeTable = std::array<quint16, 256>;
+
+/// One-byte opcode map.
+constexpr OpcodeTable oneByteMap()
+{
+  OpcodeTable t{};
+
+  // Arithmetic: ADD, OR, ADC, SBB, AND, SUB, XOR, CMP.
+  for (int op = 0x00; op < 0x40; op += 8) {
+    t[op] = t[op + 1] = t[op + 2] = t[op + 3] = modRm;
+    t[op + 4] = imm8;
+    t[op + 5] = immZ;
+  }
+
+  // PUSH/POP of segment registers and BCD adjustments.
+  for (int op : {0x06, 0x07, 0x0E, 0x16, 0x17, 0x1E, 0x1F, 0x27, 0x2F, 0x37, 0x3F}) {
+    t[op] = invalid64;
+  }
+
+  // Segment overrides and operand and address size.
+  for (int op : {0x26, 0x2E, 0x36, 0x3E, 0x64, 0x65, 0x66, 0x67, 0xF0, 0xF2, 0xF3}) {
+    t[op] = prefix;
+  }
+
+  // 0x40-0x5F: INC, DEC, PUSH, POP of registers (INC and DEC are REX prefixes in 64-bit mode).
+
+  t[0x60] = t[0x61] = invalid64; // PUSHA, POPA
+  t[0x62] = modRm | invalid64;   // BOUND (EVEX is handled separately)
+  t[0x63] = modRm;               // ARPL, MOVSXD
+  t[0x68] = immZ;
+  t[0x69] = modRm | immZ;
+  t[0x6A] = imm8;
+  t[0x6B] = modRm | imm8;
+
+  // Jcc rel8
+  for (int op = 0x70; op < 0x80; op++) {
+    t[op] = imm8;
+  }
+
+  t[0x80] = modRm | imm8;
+  t[0x81] = modRm | immZ;
+  t[0x82] = modRm | imm8 | invalid64;
+  t[0x83] = modRm | imm8;
+  for (int op = 0x84; op < 0x90; op++) {
+    t[op] = modRm;
+  }
+
+  t[0x9A] = immZ | imm16 | invalid64; // CALL ptr16:16/32
+
+  for (int op = 0xA0; op < 0xA4; op++) {
+    t[op] = moffs;
+  }
+  t[0xA8] = imm8;
+  t[0xA9] = immZ;
+  for (int op = 0xB0; op < 0xB8; op++) {
+    t[op] = imm8;
+  }
+  for (int op = 0xB8; op < 0xC0; op++) {
+    t[op] = immV;
+  }
+
+  t[0xC0] = t[0xC1] = modRm | imm8;
+  t[0xC2] = imm16;
+  t[0xC4] = t[0xC5] = modRm | invalid64; // LES, LDS (VEX is handled separately)
+  t[0xC6] = modRm | imm8;
+  t[0xC7] = modRm | immZ;
+  t[0xC8] = imm16 | imm8; // ENTER
+  t[0xCA] = imm16;
+  t[0xCD] = imm8;
+  t[0xCE] = invalid64; // INTO
+
+  t[0xD0] = t[0xD1] = t[0xD2] = t[0xD3] = modRm;
+  t[0xD4] = t[0xD5] = imm8 | invalid64; // AAM, AAD
+  t[0xD6] = invalid64;                  // SALC
+  for (int op = 0xD8; op < 0xE0; op++) {
+    t[op] = modRm; // x87
+  }
+
+  // LOOPcc, JCXZ, IN, OUT
+  for (int op = 0xE0; op < 0xE8; op++) {
+    t[op] = imm8;
+  }
+  t[0xE8] = t[0xE9] = immZ;
+  t[0xEA] = immZ | imm16 | invalid64; // JMP ptr16:16/32
+  t[0xEB] = imm8;
+
+  // The immediate of TEST in group 3 depends on the ModR/M byte.
+  t[0xF6] = t[0xF7] = modRm;
+  t[0xFE] = t[0xFF] = modRm;
+  return t;
+}
+
+/// Two-byte opcode map, following 0x0F.
+constexpr OpcodeTable twoByteMap()
+{
+  OpcodeTable t{};
+  for (auto &flags : t) {
+    flags = modRm;
+  }
+
+  // SYSCALL, CLTS, SYSRET, INVD, WBINVD, UD2, FEMMS
+  for (int op : {0x05, 0x06, 0x07, 0x08, 0x09, 0x0B, 0x0E}) {
+    t[op] = 0;
+  }
+  for (int op : {0x04, 0x0A, 0x0C, 0x24, 0x25, 0x26, 0x27, 0x36, 0x39, 0x3B, 0x3C, 0x3D, 0x3E,
+                 0x3F, 0x7A, 0x7B, 0xA6, 0xA7}) {
+    t[op] = invalid;
+  }
+  t[0x0F] = modRm | imm8; // 3DNow! has a suffix opcode after the operands.
+
+  // MOV to and from control and debug registers.
+  for (int op = 0x20; op < 0x24; op++) {
+    t[op] = modRm | regOnly;
+  }
+
+  // WRMSR, RDTSC, RDMSR, RDPMC, SYSENTER, SYSEXIT, GETSEC
+  for (int op : {0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x37}) {
+    t[op] = 0;
+  }
+
+  t[0x70] = t[0x71] = t[0x72] = t[0x73] = modRm | imm8;
+  t[0x77] = 0; // EMMS
+
+  // Jcc rel16/32
+  for (int op = 0x80; op < 0x90; op++) {
+    t[op] = immZ;
+  }
+
+  // PUSH/POP FS/GS, CPUID, RSM
+  for (int op : {0xA0, 0xA1, 0xA2, 0xA8, 0xA9, 0xAA}) {
+    t[op] = 0;
+  }
+  t[0xA4] = t[0xAC] = modRm | imm8; // SHLD, SHRD
+  t[0xBA] = modRm | imm8;           // Group 8
+  t[0xC2] = t[0xC4] = t[0xC5] = t[0xC6] = modRm | imm8;
+
+  // BSWAP
+  for (int op = 0xC8; op < 0xD0; op++) {
+    t[op] = 0;
+  }
+  return t;
+}
+
+constexpr auto oneByte = oneByteMap();
+constexpr auto twoByte = twoByteMap();
+
+/// Opcode properties of instructions in \p map of VEX, EVEX, and XOP encodings.
+/** Maps 1-3 are those of 0F, 0F 38, and 0F 3A. Returns invalid for unknown maps. */
+constexpr quint16 extendedFlags(int map, unsigned char op)
+{
+  switch (map) {
+  case 1: // 0F
+    if (op == 0x77) return 0; // VZEROUPPER, VZEROALL
+    if ((op >= 0x70 && op <= 0x73) || op == 0xC2 || (op >= 0xC4 && op <= 0xC6)) {
+      return modRm | imm8;
+    }
+    return modRm;
+
+  case 2: // 0F 38
+  case 5: // FP16 maps of EVEX
+  case 6:
+  case 9: // XOP
+    return modRm;
+
+  case 3: // 0F 3A
+  case 8: // XOP
+    return modRm | imm8;
+
+  case 10: // XOP: BEXTR and LWP with 32-bit immediates
+    return modRm | immZ;
+
+  default:
+    return invalid;
+  }
+}
+
+} // namespace
+
+X86LengthDecoder::X86LengthDecoder(bool x64_) : x64(x64_)
+{
+}
+
+int X86LengthDecoder::length(const unsigned char *data, qint64 size) const
+{
+  // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  const auto max = static_cast<int>(std::min<qint64>(size, maxLength));
+  int pos = 0;
+
+  // Legacy prefixes, and REX prefixes in 64-bit mode which only apply right before the opcode.
+  bool opSize = false, addrSize = false, repne = false, rexW = false;
+  unsigned char op = 0;
+  while (true) {
+    if (pos >= max) return 0;
+    op = data[pos];
+    if (x64 && (op & 0xF0) == 0x40) {
+      rexW = (op & 0x08) != 0;
+    }
+    else if ((oneByte[op] & prefix) != 0) {
+      rexW = false;
+      opSize |= op == 0x66;
+      addrSize |= op == 0x67;
+      repne |= op == 0xF2;
+    }
+    else {
+      break;
+    }
+    pos++;
+  }
+  pos++;
+
+  quint16 flags = 0;
+
+  // VEX and EVEX reuse LES, LDS, and BOUND which require a memory operand outside 64-bit mode.
+  const bool extended = (op == 0xC4 || op == 0xC5 || op == 0x62) &&
+                        (x64 || (pos < max && (data[pos] & 0xC0) == 0xC0));
+
+  // XOP reuses POP r/m which requires a zero reg field.
+  const bool xop = op == 0x8F && pos < max && (data[pos] & 0x38) != 0;
+
+  if (op == 0x0F) {
+    if (pos >= max) return 0;
+    op = data[pos++];
+    if (op == 0x38 || op == 0x3A) {
+      if (pos >= max) return 0;
+      flags = extendedFlags(op == 0x38 ? 2 : 3, data[pos++]);
+    }
+    else {
+      flags = twoByte[op];
+
+      // SSE4a EXTRQ and INSERTQ have two immediates.
+      if (op == 0x78 && (opSize || repne)) {
+        flags |= imm16;
+      }
+    }
+  }
+  else if (extended || xop) {
+    // Size of the prefix after its first byte.
+    const int payload = (op == 0xC5 ? 1 : (op == 0x62 ? 3 : 2));
+    if (pos + payload >= max) return 0;
+    const int map = (op == 0xC5 ? 1 : data[pos] & (op == 0x62 ? 0x07 : 0x1F));
+    if (op == 0xC4 || op == 0x8F) {
+      rexW = (data[pos + 1] & 0x80) != 0;
+    }
+
+    // Maps of XOP don't overlap with those of VEX and EVEX, and only EVEX has the FP16 maps.
+    const bool validMap = (xop ? map >= 8 : map <= 3 || (op == 0x62 && (map == 5 || map == 6)));
+    pos += payload;
+    op = data[pos++];
+    flags = (validMap ? extendedFlags(map, op) : invalid);
+    opSize = false;
+  }
+  else {
+    flags = oneByte[op];
+
+    // TEST in group 3 has an immediate.
+    if ((op == 0xF6 || op == 0xF7) && pos < max && (data[pos] & 0x30) == 0) {
+      flags |= (op == 0xF6 ? imm8 : immZ);
+    }
+  }
+
+  if ((flags & invalid) != 0 || (x64 && (flags & invalid64) != 0)) {
+    return 0;
+  }
+
+  if ((flags & modRm) != 0) {
+    if (pos >= max) return 0;
+    const auto modrm = data[pos++];
+    const int mod = modrm >> 6;
+    const int rm = modrm & 0x07;
+    if (mod != 3 && (flags & regOnly) == 0) {
+      if (!x64 && addrSize) {
+        // 16-bit addressing has no SIB byte.
+        if (mod == 1) {
+          pos += 1;
+        }
+        else if (mod == 2 || rm == 6) {
+          pos += 2;
+        }
+      }
+      else {
+        if (rm == 4) {
+          if (pos >= max) return 0;
+          const auto sib = data[pos++];
+          if (mod == 0 && (sib & 0x07) == 5) {
+            pos += 4;
+          }
+        }
+        if (mod == 1) {
+          pos += 1;
+        }
+        else if (mod == 2 || rm == 5) {
+          pos += 4;
+        }
+      }
+    }
+  }
+
+  if ((flags & imm8) != 0) {
+    pos += 1;
+  }
+  if ((flags & imm16) != 0) {
+    pos += 2;
+  }
+  if ((flags & immZ) != 0) {
+    pos += ((opSize && !rexW) ? 2 : 4);
+  }
+  if ((flags & immV) != 0) {
+    pos += (rexW ? 8 : (opSize ? 2 : 4));
+  }
+  if ((flags & moffs) != 0) {
+    pos += (x64 ? (addrSize ? 4 : 8) : (addrSize ? 2 : 4));
+  }
+  // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+  return pos <= max ? pos : 0;
+}
+
+} // namespace dispar
@@ -0,0 +1,30 @@
+#ifndef DISPAR_X86_LENGTH_DECODER_H
+#define DISPAR_X86_LENGTH_DECODER_H
+
+#include <QtGlobal>
+
+namespace dispar {
+
+/// Determines the lengths of x86 and x86-64 instructions without decoding them fully.
+/** Only prefixes, opcode maps, ModR/M, SIB, displacements, and immediates are considered using
+    tables of the opcode maps, including VEX, EVEX, and XOP encoded instructions. It is an order of
+    magnitude faster than a full decoder and meant for finding where instructions start. Operands
+    aren't validated, so some invalid encodings get a length where a full decoder would fail. */
+class X86LengthDecoder {
+public:
+  /// Longest valid instruction.
+  static constexpr int maxLength = 15;
+
+  X86LengthDecoder(bool x64);
+
+  /// Length of the instruction at the start of \p data of \p size bytes.
+  /** Returns 0 if the instruction is invalid, longer than the maximum, or truncated. */
+  [[nodiscard]] int length(const unsigned char *data, qint64 size) const;
+
+private:
+  bool x64;
+};
+
+} // namespace dispar
+
+#endif // DISPAR_X86_LENGTH_DECODER_H
@@ -1,12 +1,36 @@
 #include "formats/Format.h"
 #include "BinaryObject.h"
+#include "MappedFile.h"
+#include "Reader.h"
 #include "Util.h"
+#include "cxx.h"
 #include "formats/MachO.h"
 
 #include <QIODevice>
 
+#include <array>
+
 namespace dispar {
 
+namespace {
+
+struct MagicEntry {
+  quint32 magic;
+  Format::Type type;
+};
+
+/// Magic codes of all known formats.
+constexpr std::array<MagicEntry, 6> magicTable{{
+  {0xFEEDFACE, Format::Type::MACH_O}, // 32-bit little endian
+  {0xFEEDFACF, Format::Type::MACH_O}, // 64-bit little endian
+  {0xECAFDEEF, Format::Type::MACH_O}, // 32-bit big endian
+  {0xFCAFDEEF, Format::Type::MACH_O}, // 64-bit big endian
+  {0xCAFEBABE, Format::Type::MACH_O}, // Universal binary little endian
+  {0xBEBAFECA, Format::Type::MACH_O}, // Universal binary big endian
+}};
+
+} // namespace
+
 Format::Format(Type type) : type_(type)
 {
 }
@@ -16,6 +40,16 @@ Format::Type Format::type() const
   return type_;
 }
 
+void Format::setCache(std::shared_ptr<const AnalysisCache> cache)
+{
+  cache_ = std::move(cache);
+}
+
+std::shared_ptr<const AnalysisCache> Format::cache() const
+{
+  return cache_;
+}
+
 QString Format::toString() const
 {
   const auto objs = objects();
@@ -23,6 +57,9 @@ QString Format::toString() const
   if (objs.size() > 1) {
     res += QString("%1 objects:\n").arg(objs.size());
   }
+  for (const auto index : failedObjects()) {
+    res += QString("- Object %1 failed to parse!\n").arg(index);
+  }
   for (const auto *obj : objs) {
     res += QString("- %1\n").arg(obj->toString());
     for (const auto *sec : obj->sections()) {
@@ -41,14 +78,39 @@ QString Format::toString() const
 
 std::shared_ptr<Format> Format::detect(const QString &file)
 {
-  // Mach-O
-  auto res = std::make_shared<MachO>(file);
-  if (res->detect()) {
-    return res;
+  auto mapping = MappedFile::open(file);
+  if (!mapping) {
+    return nullptr;
   }
+
+  Reader r(*mapping);
+  bool ok = false;
+  const quint32 magic = r.getUInt32(&ok);
+  if (!ok) return nullptr;
+
+  const auto type = typeFromMagic(magic);
+  if (!type) {
+    return nullptr;
+  }
+
+  switch (*type) {
+  case Type::MACH_O:
+    return std::make_shared<MachO>(file, std::move(mapping));
+  }
+
   return nullptr;
 }
 
+std::optional<Format::Type> Format::typeFromMagic(quint32 magic)
+{
+  const auto it =
+    cxx::find_if(magicTable, [magic](const auto &entry) { return entry.magic == magic; });
+  if (it == magicTable.cend()) {
+    return std::nullopt;
+  }
+  return it->type;
+}
+
 QString Format::typeName(Type type)
 {
   switch (type) {
@@ -61,7 +123,8 @@ QString Format::typeName(Type type)
 
 void Format::write(QIODevice &device) const
 {
-  for (const auto *object : objects()) {
+  // Objects that were never parsed cannot have been modified.
+  for (const auto *object : parsedObjects()) {
     for (const auto *section : object->sections()) {
       if (!section->isModified()) {
         continue;
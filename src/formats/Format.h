@@ -6,6 +6,7 @@
 #include <QString>
 
 #include <memory>
+#include <optional>
 
 #include "CpuType.h"
 #include "FileType.h"
@@ -15,12 +16,25 @@ class QIODevice;
 
 namespace dispar {
 
+class AnalysisCache;
 class BinaryObject;
+class MappedFile;
 
 class Format {
 public:
   enum class Type { MACH_O };
 
+  /// Header information of a binary object that is known before it is parsed completely.
+  struct ObjectSummary {
+    CpuType cpuType{CpuType::X86};
+    CpuType cpuSubType{CpuType::I386};
+    int systemBits{32};
+    FileType fileType{FileType::EXECUTE};
+
+    /// Location of the object in the file.
+    quint64 offset{0}, size{0};
+  };
+
   Format(Type type);
   virtual ~Format() = default;
 
@@ -40,19 +54,51 @@ public:
   /** Only reads the first chunk of the file and not all of it! */
   virtual bool detect() = 0;
 
-  /// Parses the file into the various sections and so on.
+  /// Finds the binary objects of the file and reads their headers.
+  /** The objects themselves are parsed into the various sections and so on when first accessed. */
   virtual bool parse() = 0;
 
-  /// Get the list of probed binary objects of the file.
-  /** Format keeps ownership of objects. */
+  /// Get summaries of all binary objects of the file, in the same order as objects().
+  [[nodiscard]] virtual QList<ObjectSummary> summaries() const = 0;
+
+  /// Get binary object at \p index, parsing it if necessary.
+  /** Returns nullptr if out of bounds or parsing failed. Format keeps ownership of the object. */
+  [[nodiscard]] virtual BinaryObject *object(int index) const = 0;
+
+  /// Get the list of probed binary objects of the file, parsing those not yet parsed.
+  /** Objects that fail to parse are left out. Format keeps ownership of objects. */
   [[nodiscard]] virtual QList<BinaryObject *> objects() const = 0;
 
-  /// Write modified sections of objects to \p device.
+  /// Get the list of binary objects that have been parsed so far.
+  [[nodiscard]] virtual QList<BinaryObject *> parsedObjects() const = 0;
+
+  /// Indices of the binary objects whose parsing has failed so far, in order.
+  /** They are left out of objects(), so check this to not skip them unknowingly. */
+  [[nodiscard]] virtual QList<int> failedObjects() const = 0;
+
+  /// Fingerprint of the file contents that keys the analysis cache.
+  /** Empty if not available. */
+  [[nodiscard]] virtual QByteArray fingerprint() const = 0;
+
+  /// Mapping of the file that objects are parsed from and their section data are views into.
+  /** Null if the file hasn't been mapped. */
+  [[nodiscard]] virtual std::shared_ptr<const MappedFile> mappedFile() const = 0;
+
+  /// Use \p cache to load objects that were analyzed before instead of parsing them.
+  void setCache(std::shared_ptr<const AnalysisCache> cache);
+  [[nodiscard]] std::shared_ptr<const AnalysisCache> cache() const;
+
+  /// Write modified sections of parsed objects to \p device.
   void write(QIODevice &device) const;
 
-  /// Try each of the known formats and see if any of them are compatible with the file.
+  /// Detect the format of the file from its magic code.
+  /** The file is opened and mapped only once, and the mapping is handed to the format for parsing.
+      Returns nullptr if the file can't be opened or the format is unknown. */
   static std::shared_ptr<Format> detect(const QString &file);
 
+  /// Look up the format of the \p magic code, which is the first 4 bytes read as little-endian.
+  static std::optional<Type> typeFromMagic(quint32 magic);
+
   /// Get string representation of type.
   static QString typeName(Type type);
 
@@ -60,6 +106,7 @@ public:
 
 private:
   Type type_;
+  std::shared_ptr<const AnalysisCache> cache_;
 };
 
 } // namespace dispar
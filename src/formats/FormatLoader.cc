@@ -1,5 +1,6 @@
 #include "formats/FormatLoader.h"
 #include "BinaryObject.h"
+#include "Context.h"
 #include "formats/Format.h"
 
 #include <QDebug>
@@ -26,6 +27,7 @@ void FormatLoader::run()
   emit status(tr("Detected %1 - Reading and parsing binary..").arg(typeName));
   emit progress(0.5);
 
+  fmt->setCache(Context::get().analysisCache());
   if (!fmt->parse()) {
     emit failed(tr("Could not parse file!"));
     return;
@@ -1,20 +1,233 @@
 #include <QDebug>
-#include <QFile>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
 
+#include <algorithm>
 #include <cmath>
+#include <optional>
+#include <type_traits>
 
+#include "AnalysisCache.h"
 #include "BinaryObject.h"
 #include "Constants.h"
+#include "MappedFile.h"
 #include "Reader.h"
 #include "Util.h"
 #include "formats/MachO.h"
 
 namespace dispar {
 
+namespace {
+
+/// Converts CPU type of the Mach-O header.
+/** Types in /usr/include/mach/machine.h */
+CpuType cpuTypeFromMachO(quint32 cputype)
+{
+  if (cputype == 7) { // CPU_TYPE_X86, CPU_TYPE_I386
+    return CpuType::X86;
+  }
+  if (cputype == 7 + 0x01000000) { // CPU_TYPE_X86 | CPU_ARCH_ABI64
+    return CpuType::X86_64;
+  }
+  if (cputype == 11) { // CPU_TYPE_HPPA
+    return CpuType::HPPA;
+  }
+  if (cputype == 12) { // CPU_TYPE_ARM
+    return CpuType::ARM;
+  }
+  if (cputype == 14) { // CPU_TYPE_SPARC
+    return CpuType::SPARC;
+  }
+  if (cputype == 15) { // CPU_TYPE_I860
+    return CpuType::I860;
+  }
+  if (cputype == 18) { // CPU_TYPE_POWERPC
+    return CpuType::POWER_PC;
+  }
+  if (cputype == 18 + 0x01000000) { // CPU_TYPE_POWERPC | CPU_ARCH_ABI64
+    return CpuType::POWER_PC_64;
+  }
+  return CpuType::X86;
+}
+
+/// Converts CPU sub type of the Mach-O header.
+CpuType cpuSubTypeFromMachO(quint32 cpusubtype, int systemBits)
+{
+  // Subtract 64-bit mask.
+  if (systemBits == 64) {
+    cpusubtype -= 0x80000000;
+  }
+
+  if (cpusubtype == 3) { // CPU_SUBTYPE_386
+    return CpuType::I386;
+  }
+  if (cpusubtype == 4) { // CPU_SUBTYPE_486
+    return CpuType::I486;
+  }
+  if (cpusubtype == 4 + (8 << 4)) { // CPU_SUBTYPE_486SX
+    return CpuType::I486_SX;
+  }
+  if (cpusubtype == 5) { // CPU_SUBTYPE_PENT
+    return CpuType::PENTIUM;
+  }
+  if (cpusubtype == 6 + (1 << 4)) { // CPU_SUBTYPE_PENTPRO
+    return CpuType::PENTIUM_PRO;
+  }
+  if (cpusubtype == 6 + (3 << 4)) { // CPU_SUBTYPE_PENTII_M3
+    return CpuType::PENTIUM_II_M3;
+  }
+  if (cpusubtype == 6 + (5 << 4)) { // CPU_SUBTYPE_PENTII_M5
+    return CpuType::PENTIUM_II_M5;
+  }
+  if (cpusubtype == 7 + (6 << 4)) { // CPU_SUBTYPE_CELERON
+    return CpuType::CELERON;
+  }
+  if (cpusubtype == 7 + (7 << 4)) { // CPU_SUBTYPE_CELERON_MOBILE
+    return CpuType::CELERON_MOBILE;
+  }
+  if (cpusubtype == 8) { // CPU_SUBTYPE_PENTIUM_3
+    return CpuType::PENTIUM_3;
+  }
+  if (cpusubtype == 8 + (1 << 4)) { // CPU_SUBTYPE_PENTIUM_3_M
+    return CpuType::PENTIUM_3_M;
+  }
+  if (cpusubtype == 8 + (2 << 4)) { // CPU_SUBTYPE_PENTIUM_3_XEON
+    return CpuType::PENTIUM_3_Xeon;
+  }
+  if (cpusubtype == 9) { // CPU_SUBTYPE_PENTIUM_M
+    return CpuType::PENTIUM_M;
+  }
+  if (cpusubtype == 10) { // CPU_SUBTYPE_PENTIUM_4
+    return CpuType::PENTIUM_4;
+  }
+  if (cpusubtype == 10 + (1 << 4)) { // CPU_SUBTYPE_PENTIUM_4_M
+    return CpuType::PENTIUM_4_M;
+  }
+  if (cpusubtype == 11) { // CPU_SUBTYPE_ITANIUM
+    return CpuType::ITANIUM;
+  }
+  if (cpusubtype == 11 + (1 << 4)) { // CPU_SUBTYPE_ITANIUM_2
+    return CpuType::ITANIUM_2;
+  }
+  if (cpusubtype == 12) { // CPU_SUBTYPE_XEON
+    return CpuType::XEON;
+  }
+  if (cpusubtype == 12 + (1 << 4)) { // CPU_SUBTYPE_XEON_MP
+    return CpuType::XEON_MP;
+  }
+  return CpuType::I386;
+}
+
+/// Converts file type of the Mach-O header.
+/** Sets \p ok to false if unknown. */
+FileType fileTypeFromMachO(quint32 filetype, bool *ok = nullptr)
+{
+  if (ok) *ok = true;
+
+  switch (filetype) {
+  case 1: // MH_OBJECT
+    return FileType::OBJECT;
+  case 2: // MH_EXECUTE
+    return FileType::EXECUTE;
+  case 4: // MH_CORE
+    return FileType::CORE;
+  case 5: // MH_PRELOAD
+    return FileType::PRELOAD;
+  case 6: // MH_DYLIB
+    return FileType::DYLIB;
+  case 7: // MH_DYLINKER
+    return FileType::DYLINKER;
+  case 8: // MH_BUNDLE
+    return FileType::BUNDLE;
+  default:
+    break;
+  }
+
+  qWarning() << "Unknown file type:" << filetype;
+  if (ok) *ok = false;
+  return FileType::OBJECT;
+}
+
+/// Layout of the Mach-O structures that differ between 32-bit and 64-bit objects.
+template <int Bits>
+struct Layout {
+  static_assert(Bits == 32 || Bits == 64, "Mach-O objects are either 32-bit or 64-bit");
+
+  /// Type of addresses and sizes.
+  using Word = std::conditional_t<Bits == 64, quint64, quint32>;
+  static constexpr qint64 wordSize = sizeof(Word);
+
+  /// mach_header or mach_header_64, including the magic.
+  static constexpr qint64 headerSize = (Bits == 64 ? 32 : 28);
+
+  /// segment_command or segment_command_64, excluding type and size of the load command.
+  static constexpr qint64 segmentSize = 16 + 4 * wordSize + 4 * 4;
+
+  /// section or section_64.
+  static constexpr qint64 sectionSize = 16 + 16 + 2 * wordSize + (Bits == 64 ? 8 : 7) * 4;
+
+  /// nlist or nlist_64.
+  static constexpr qint64 nlistSize = 8 + wordSize;
+};
+
+/// Reads \p num nlist entries of the symbol table at once.
+/** Returns std::nullopt if the table exceeds the file. */
+template <int Bits, Constants::Endianness E>
+std::optional<SymbolTable> readSymbols(Reader &r, quint32 num)
+{
+  using L = Layout<Bits>;
+  Reader::Record<E> entries;
+  if (!r.getRecord(qint64(num) * L::nlistSize, entries)) {
+    return std::nullopt;
+  }
+
+  SymbolTable table;
+  auto &symbols = table.symbols();
+  symbols.reserve(num);
+  for (quint32 i = 0; i < num; i++) {
+    const auto base = qint64(i) * L::nlistSize;
+
+    // Index into the string table, followed by type flag (1), section number or NO_SECT (1), and
+    // description (2).
+    const auto index = entries.template get<quint32>(base);
+
+    // Value of the symbol (or stab offset).
+    const quint64 value = entries.template get<typename L::Word>(base + 8);
+
+    symbols.emplace_back(index, value);
+  }
+  return table;
+}
+
+/// Decodes LC_FUNCTION_STARTS data into addresses.
+/** The data is ULEB128 deltas from the previous function, where the first is from the start of
+    __TEXT at \p textAddress, terminated by a zero delta. */
+std::vector<quint64> decodeFunctionStarts(const QByteArray &data, quint64 textAddress)
+{
+  auto starts = Util::decodeUleb128(data);
+  auto address = textAddress;
+  std::size_t count = 0;
+  for (; count < starts.size() && starts[count] != 0; count++) {
+    address += starts[count];
+    starts[count] = address;
+  }
+  starts.resize(count);
+  return starts;
+}
+
+} // namespace
+
 MachO::MachO(const QString &file) : Format(Format::Type::MACH_O), file_{file}
 {
 }
 
+MachO::MachO(const QString &file, std::shared_ptr<const MappedFile> mapping_)
+  : Format(Format::Type::MACH_O), file_{file}, mapping{std::move(mapping_)}
+{
+}
+
 QString MachO::file() const
 {
   return file_;
@@ -22,32 +235,43 @@ QString MachO::file() const
 
 bool MachO::detect()
 {
-  QFile f{file_};
-  if (!f.open(QIODevice::ReadOnly)) {
-    return false;
+  // Keep the mapping for parsing.
+  if (!mapping) {
+    mapping = MappedFile::open(file_);
+    if (!mapping) {
+      return false;
+    }
   }
 
-  Reader r(f);
+  Reader r(*mapping);
   bool ok = false;
   quint32 magic = r.getUInt32(&ok);
   if (!ok) return false;
 
-  return magic == 0xFEEDFACE || // 32-bit little endian
-         magic == 0xFEEDFACF || // 64-bit little endian
-         magic == 0xECAFDEEF || // 32-bit big endian
-         magic == 0xFCAFDEEF || // 64-bit big endian
-         magic == 0xCAFEBABE || // Universal binary little endian
-         magic == 0xBEBAFECA;   // Universal binary big endian
+  return typeFromMagic(magic) == Format::Type::MACH_O;
 }
 
 bool MachO::parse()
 {
-  QFile f{file_};
-  if (!f.open(QIODevice::ReadOnly)) {
-    return false;
+  summaries_.clear();
+  objects_.clear();
+  fingerprint_.clear();
+
+  // Section data will be views into the mapping instead of copies. It might already be opened by
+  // detection.
+  if (!mapping) {
+    mapping = MappedFile::open(file_);
+    if (!mapping) {
+      return false;
+    }
+  }
+
+  // Only fingerprint the file when it is needed to look up cached objects.
+  if (cache()) {
+    fingerprint_ = mapping->fingerprint();
   }
 
-  Reader r(f);
+  Reader r(*mapping);
   bool ok = false;
   quint32 magic = r.getUInt32(&ok);
   if (!ok) return false;
@@ -60,243 +284,227 @@ bool MachO::parse()
     quint32 nfat_arch = r.getUInt32(&ok);
     if (!ok) return false;
 
-    // Read "fat" headers.
+    // Read "fat" headers (fat_arch) all at once. Each consists of the CPU type, CPU sub type, file
+    // offset to the object file, size of the object file, and alignment as a power of 2.
+    constexpr qint64 fatArchSize = 5 * 4;
+    Reader::BigRecord fatArchs;
+    if (!r.getRecord(qint64(nfat_arch) * fatArchSize, fatArchs)) return false;
+
     typedef QPair<quint32, quint32> puu;
     QList<puu> archs;
     for (quint32 i = 0; i < nfat_arch; i++) {
-      // CPU type.
-      r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // CPU sub type.
-      r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // File offset to this object file.
-      quint32 offset = r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Size of this object file.
-      quint32 size = r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Alignment as a power of 2.
-      r.getUInt32(&ok);
-      if (!ok) return false;
-
+      const auto base = qint64(i) * fatArchSize;
+      const auto offset = fatArchs.get<quint32>(base + 8);
+      const auto size = fatArchs.get<quint32>(base + 12);
       archs << puu(offset, size);
     }
 
-    // Parse the actual binary objects.
-    if (cxx::any_of(archs,
-                    [&](const auto &arch) { return !parseHeader(arch.first, arch.second, r); })) {
-      return false;
+    // Only read the headers of the binary objects. The rest is parsed when accessed.
+    for (const auto &arch : archs) {
+      const auto summary = readSummary(arch.first, arch.second);
+      if (!summary) return false;
+      summaries_ << *summary;
     }
   }
 
-  // Otherwise, just parse a single object file.
+  // Otherwise, just a single object file.
   else {
-    return parseHeader(0, 0, r);
+    const auto summary = readSummary(0, static_cast<quint32>(mapping->size()));
+    if (!summary) return false;
+    summaries_ << *summary;
   }
 
+  objects_.resize(summaries_.size());
   return true;
 }
 
+QList<Format::ObjectSummary> MachO::summaries() const
+{
+  return summaries_;
+}
+
+BinaryObject *MachO::object(int index) const
+{
+  if (index < 0 || index >= summaries_.size()) {
+    return nullptr;
+  }
+
+  QMutexLocker locker(&objectsMutex);
+  auto &object = objects_[index];
+  if (!object) {
+    const auto &summary = summaries_[index];
+    object = parseHeader(summary.offset, summary.size);
+    if (!object) {
+      failed << index;
+    }
+  }
+  return object.get();
+}
+
 QList<BinaryObject *> MachO::objects() const
 {
+  QMutexLocker locker(&objectsMutex);
+
+  // Parse the remaining binary objects concurrently since they are independent of each other.
+  QThreadPool pool;
+  pool.setMaxThreadCount(std::max(1, std::min(summaries_.size(), QThread::idealThreadCount())));
+  for (int i = 0; i < summaries_.size(); i++) {
+    if (objects_[i]) continue;
+    const auto &summary = summaries_[i];
+    pool.start([this, i, summary] { objects_[i] = parseHeader(summary.offset, summary.size); });
+  }
+  pool.waitForDone();
+
+  QList<BinaryObject *> res;
+  for (int i = 0; i < summaries_.size(); i++) {
+    if (objects_[i]) {
+      res << objects_[i].get();
+    }
+    else {
+      failed << i;
+    }
+  }
+  return res;
+}
+
+QList<BinaryObject *> MachO::parsedObjects() const
+{
+  QMutexLocker locker(&objectsMutex);
   QList<BinaryObject *> res;
   for (const auto &object : objects_) {
-    res << object.get();
+    if (object) {
+      res << object.get();
+    }
   }
   return res;
 }
 
-bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
+QByteArray MachO::fingerprint() const
 {
-  auto binaryObject = std::make_unique<BinaryObject>();
+  if (!fingerprint_.isEmpty() || !mapping) {
+    return fingerprint_;
+  }
+  return mapping->fingerprint();
+}
+
+QList<int> MachO::failedObjects() const
+{
+  QMutexLocker locker(&objectsMutex);
+  auto res = failed.values();
+  std::sort(res.begin(), res.end());
+  return res;
+}
+
+std::shared_ptr<const MappedFile> MachO::mappedFile() const
+{
+  return mapping;
+}
 
+std::optional<Format::ObjectSummary> MachO::readSummary(quint32 offset, quint32 size) const
+{
+  Reader r(*mapping);
   r.seek(offset);
-  r.setEndianness(Constants::Endianness::Little);
 
   bool ok = false;
-  quint32 magic = r.getUInt32(&ok);
-  if (!ok) return false;
+  const quint32 magic = r.getUInt32(&ok);
+  if (!ok) return std::nullopt;
+
+  ObjectSummary summary;
+  summary.offset = offset;
+  summary.size = size;
 
-  int systemBits{32};
   auto endianness{Constants::Endianness::Little};
-  if (magic == 0xFEEDFACE) {
-    systemBits = 32;
-    endianness = Constants::Endianness::Little;
-  }
-  else if (magic == 0xFEEDFACF) {
-    systemBits = 64;
-    endianness = Constants::Endianness::Little;
-  }
-  else if (magic == 0xECAFDEEF) {
-    systemBits = 32;
-    endianness = Constants::Endianness::Big;
+  if (magic == 0xFEEDFACF || magic == 0xFCAFDEEF) {
+    summary.systemBits = 64;
   }
-  else if (magic == 0xFCAFDEEF) {
-    systemBits = 64;
+  if (magic == 0xECAFDEEF || magic == 0xFCAFDEEF) {
     endianness = Constants::Endianness::Big;
   }
-
-  binaryObject->setSystemBits(systemBits);
-  binaryObject->setEndianness(endianness);
-
-  // Read info in the endianness of the file.
   r.setEndianness(endianness);
 
-  quint32 cputype = 0, cpusubtype = 0, filetype = 0, ncmds = 0, sizeofcmds = 0, flags = 0;
-
-  cputype = r.getUInt32(&ok);
-  if (!ok) return false;
+  // The CPU type, CPU sub type and file type are the same for 32-bit and 64-bit headers.
+  const auto cputype = r.getUInt32(&ok);
+  if (!ok) return std::nullopt;
 
-  cpusubtype = r.getUInt32(&ok);
-  if (!ok) return false;
+  const auto cpusubtype = r.getUInt32(&ok);
+  if (!ok) return std::nullopt;
 
-  filetype = r.getUInt32(&ok);
-  if (!ok) return false;
+  const auto filetype = r.getUInt32(&ok);
+  if (!ok) return std::nullopt;
 
-  ncmds = r.getUInt32(&ok);
-  if (!ok) return false;
+  summary.cpuType = cpuTypeFromMachO(cputype);
+  summary.cpuSubType = cpuSubTypeFromMachO(cpusubtype, summary.systemBits);
+  summary.fileType = fileTypeFromMachO(filetype, &ok);
+  if (!ok) return std::nullopt;
 
-  sizeofcmds = r.getUInt32(&ok);
-  if (!ok) return false;
-  (void) sizeofcmds; // Mark used.
+  return summary;
+}
 
-  flags = r.getUInt32(&ok);
-  if (!ok) return false;
-  (void) flags; // Mark used.
+std::unique_ptr<BinaryObject> MachO::parseHeader(quint32 offset, quint32 size) const
+{
+  (void) size; // Mark used.
 
-  // Read reserved field.
-  if (systemBits == 64) {
-    r.getUInt32();
+  // Use the object from the analysis cache if available.
+  if (const auto analysisCache = cache(); analysisCache && !fingerprint_.isEmpty()) {
+    if (auto object = analysisCache->load(fingerprint_, offset, mapping)) {
+      return object;
+    }
   }
 
-  // Types in /usr/include/mach/machine.h
-  CpuType cpuType{CpuType::X86};
-  if (cputype == 7) { // CPU_TYPE_X86, CPU_TYPE_I386
-    cpuType = CpuType::X86;
-  }
-  else if (cputype == 7 + 0x01000000) { // CPU_TYPE_X86 | CPU_ARCH_ABI64
-    cpuType = CpuType::X86_64;
-  }
-  else if (cputype == 11) { // CPU_TYPE_HPPA
-    cpuType = CpuType::HPPA;
-  }
-  else if (cputype == 12) { // CPU_TYPE_ARM
-    cpuType = CpuType::ARM;
-  }
-  else if (cputype == 14) { // CPU_TYPE_SPARC
-    cpuType = CpuType::SPARC;
-  }
-  else if (cputype == 15) { // CPU_TYPE_I860
-    cpuType = CpuType::I860;
+  // Each object file gets its own reader so they can be parsed concurrently.
+  Reader r(*mapping);
+  r.seek(offset);
+
+  bool ok = false;
+  quint32 magic = r.getUInt32(&ok);
+  if (!ok) return nullptr;
+
+  // Choose word size and byte order once such that the structures are decoded without checking
+  // them for every field.
+  using Endianness = Constants::Endianness;
+  if (magic == 0xFEEDFACF) {
+    return parseObject<64, Endianness::Little>(offset, r);
   }
-  else if (cputype == 18) { // CPU_TYPE_POWERPC
-    cpuType = CpuType::POWER_PC;
+  if (magic == 0xECAFDEEF) {
+    return parseObject<32, Endianness::Big>(offset, r);
   }
-  else if (cputype == 18 + 0x01000000) { // CPU_TYPE_POWERPC | CPU_ARCH_ABI64
-    cpuType = CpuType::POWER_PC_64;
+  if (magic == 0xFCAFDEEF) {
+    return parseObject<64, Endianness::Big>(offset, r);
   }
+  return parseObject<32, Endianness::Little>(offset, r);
+}
 
-  binaryObject->setCpuType(cpuType);
+template <int Bits, Constants::Endianness E>
+std::unique_ptr<BinaryObject> MachO::parseObject(quint32 offset, Reader &r) const
+{
+  using L = Layout<Bits>;
+  using Word = typename L::Word;
+  using Record = Reader::Record<E>;
 
-  // Subtract 64-bit mask.
-  if (systemBits == 64) {
-    cpusubtype -= 0x80000000;
-  }
+  auto binaryObject = std::make_unique<BinaryObject>();
+  binaryObject->setSystemBits(Bits);
+  binaryObject->setEndianness(E);
 
-  CpuType cpuSubType{CpuType::I386};
-  if (cpusubtype == 3) { // CPU_SUBTYPE_386
-    cpuSubType = CpuType::I386;
-  }
-  else if (cpusubtype == 4) { // CPU_SUBTYPE_486
-    cpuSubType = CpuType::I486;
-  }
-  else if (cpusubtype == 4 + (8 << 4)) { // CPU_SUBTYPE_486SX
-    cpuSubType = CpuType::I486_SX;
-  }
-  else if (cpusubtype == 5) { // CPU_SUBTYPE_PENT
-    cpuSubType = CpuType::PENTIUM;
-  }
-  else if (cpusubtype == 6 + (1 << 4)) { // CPU_SUBTYPE_PENTPRO
-    cpuSubType = CpuType::PENTIUM_PRO;
-  }
-  else if (cpusubtype == 6 + (3 << 4)) { // CPU_SUBTYPE_PENTII_M3
-    cpuSubType = CpuType::PENTIUM_II_M3;
-  }
-  else if (cpusubtype == 6 + (5 << 4)) { // CPU_SUBTYPE_PENTII_M5
-    cpuSubType = CpuType::PENTIUM_II_M5;
-  }
-  else if (cpusubtype == 7 + (6 << 4)) { // CPU_SUBTYPE_CELERON
-    cpuSubType = CpuType::CELERON;
-  }
-  else if (cpusubtype == 7 + (7 << 4)) { // CPU_SUBTYPE_CELERON_MOBILE
-    cpuSubType = CpuType::CELERON_MOBILE;
-  }
-  else if (cpusubtype == 8) { // CPU_SUBTYPE_PENTIUM_3
-    cpuSubType = CpuType::PENTIUM_3;
-  }
-  else if (cpusubtype == 8 + (1 << 4)) { // CPU_SUBTYPE_PENTIUM_3_M
-    cpuSubType = CpuType::PENTIUM_3_M;
-  }
-  else if (cpusubtype == 8 + (2 << 4)) { // CPU_SUBTYPE_PENTIUM_3_XEON
-    cpuSubType = CpuType::PENTIUM_3_Xeon;
-  }
-  else if (cpusubtype == 9) { // CPU_SUBTYPE_PENTIUM_M
-    cpuSubType = CpuType::PENTIUM_M;
-  }
-  else if (cpusubtype == 10) { // CPU_SUBTYPE_PENTIUM_4
-    cpuSubType = CpuType::PENTIUM_4;
-  }
-  else if (cpusubtype == 10 + (1 << 4)) { // CPU_SUBTYPE_PENTIUM_4_M
-    cpuSubType = CpuType::PENTIUM_4_M;
-  }
-  else if (cpusubtype == 11) { // CPU_SUBTYPE_ITANIUM
-    cpuSubType = CpuType::ITANIUM;
-  }
-  else if (cpusubtype == 11 + (1 << 4)) { // CPU_SUBTYPE_ITANIUM_2
-    cpuSubType = CpuType::ITANIUM_2;
-  }
-  else if (cpusubtype == 12) { // CPU_SUBTYPE_XEON
-    cpuSubType = CpuType::XEON;
-  }
-  else if (cpusubtype == 12 + (1 << 4)) { // CPU_SUBTYPE_XEON_MP
-    cpuSubType = CpuType::XEON_MP;
-  }
+  // Read info in the endianness of the file.
+  r.seek(offset);
+  r.setEndianness(E);
 
-  binaryObject->setCpuSubType(cpuSubType);
+  // Magic, CPU type, CPU sub type, file type, number of load commands, size of load commands,
+  // flags, and a reserved field for 64-bit.
+  Record header;
+  if (!r.getRecord(L::headerSize, header)) return nullptr;
 
-  FileType fileType{FileType::OBJECT};
-  if (filetype == 1) { // MH_OBJECT
-    fileType = FileType::OBJECT;
-  }
-  else if (filetype == 2) { // MH_EXECUTE
-    fileType = FileType::EXECUTE;
-  }
-  else if (filetype == 4) { // MH_CORE
-    fileType = FileType::CORE;
-  }
-  else if (filetype == 5) { // MH_PRELOAD
-    fileType = FileType::PRELOAD;
-  }
-  else if (filetype == 6) { // MH_DYLIB
-    fileType = FileType::DYLIB;
-  }
-  else if (filetype == 7) { // MH_DYLINKER
-    fileType = FileType::DYLINKER;
-  }
-  else if (filetype == 8) { // MH_BUNDLE
-    fileType = FileType::BUNDLE;
-  }
-  else {
-    qWarning() << "Unknown file type:" << filetype;
-    return false;
-  }
+  const auto cputype = header.template get<quint32>(4);
+  const auto cpusubtype = header.template get<quint32>(8);
+  const auto filetype = header.template get<quint32>(12);
+  const auto ncmds = header.template get<quint32>(16);
+
+  binaryObject->setCpuType(cpuTypeFromMachO(cputype));
+  binaryObject->setCpuSubType(cpuSubTypeFromMachO(cpusubtype, Bits));
 
-  binaryObject->setFileType(fileType);
+  bool ok = false;
+  binaryObject->setFileType(fileTypeFromMachO(filetype, &ok));
+  if (!ok) return nullptr;
 
   // TODO: Load flags when necessary.
 
@@ -307,14 +515,27 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
   // it.
   quint32 indirsymoff{0}, indirsymnum{0};
 
+  // Sections without data in the file.
+  QSet<const Section *> zeroFill;
+
+  // Start of the __TEXT segment that function starts are relative to.
+  std::optional<quint64> textAddress;
+
+  // Segments without sections that have contents in the file.
+  struct Segment {
+    QString name;
+    quint64 vmaddr{0}, fileoff{0}, filesize{0};
+  };
+  std::vector<Segment> segments;
+
   // Parse load commands sequentially. Each consists of the type, size
   // and data.
   for (decltype(ncmds) i = 0; i < ncmds; i++) {
     quint32 type = r.getUInt32(&ok);
-    if (!ok) return false;
+    if (!ok) return nullptr;
 
     quint32 cmdsize = r.getUInt32(&ok);
-    if (!ok) return false;
+    if (!ok) return nullptr;
 
     // Abort parsing if obsolete load command is reached: LC_SYMSEG, LC_LOADFVMLIB, LC_IDFVMLIB,
     // LC_IDENT, LC_FVMFILE, LC_PREPAGE, LC_PREBOUND_DYLIB, LC_TWOLEVEL_HINTS or LC_PREBIND_CKSUM.
@@ -322,159 +543,86 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
         type == 0x10 || type == 0x16 || type == 0x17) {
       qCritical().nospace().noquote()
         << "Obsolete load command 0x" << QString::number(type, 16) << " is not supported!";
-      return false;
+      return nullptr;
     }
 
     // LC_SEGMENT or LC_SEGMENT_64
     if (type == 1 || type == 25) {
-      QString name{r.read(16)};
-
-      // Memory address of this segment.
-      quint64 vmaddr = 0;
-      if (systemBits == 32) {
-        vmaddr = r.getUInt32(&ok);
-        if (!ok) return false;
-      }
-      else {
-        vmaddr = r.getUInt64(&ok);
-        if (!ok) return false;
-      }
-      (void) vmaddr; // Mark used.
-
-      // Memory size of this segment.
-      quint64 vmsize = 0;
-      if (systemBits == 32) {
-        vmsize = r.getUInt32(&ok);
-        if (!ok) return false;
-      }
-      else {
-        vmsize = r.getUInt64(&ok);
-        if (!ok) return false;
+      // Name, memory address, memory size, file offset, amount to map from the file, maximum and
+      // initial VM protection, number of sections, and flags.
+      Record segment;
+      if (!r.getRecord(L::segmentSize, segment)) return nullptr;
+
+      const QString segmentName{segment.bytes(0, 16)};
+      const quint64 vmaddr = segment.template get<Word>(16);
+      const quint64 fileoff = segment.template get<Word>(16 + 2 * L::wordSize);
+      const quint64 filesize = segment.template get<Word>(16 + 3 * L::wordSize);
+      const auto nsects = segment.template get<quint32>(16 + 4 * L::wordSize + 2 * 4);
+
+      if (segmentName == "__TEXT") {
+        textAddress = vmaddr;
       }
-      (void) vmsize; // Mark used.
 
-      // File offset of this segment.
-      quint64 fileoff = 0;
-      if (systemBits == 32) {
-        fileoff = r.getUInt32(&ok);
-        if (!ok) return false;
+      // Segments without sections are exposed when the sections inside them are known.
+      if (nsects == 0 && filesize > 0) {
+        segments.push_back({segmentName, vmaddr, fileoff, filesize});
       }
-      else {
-        fileoff = r.getUInt64(&ok);
-        if (!ok) return false;
-      }
-      (void) fileoff; // Mark used.
 
-      // Amount to map from the file.
-      quint64 filesize = 0;
-      if (systemBits == 32) {
-        filesize = r.getUInt32(&ok);
-        if (!ok) return false;
-      }
-      else {
-        filesize = r.getUInt64(&ok);
-        if (!ok) return false;
-      }
-      (void) filesize; // Mark used.
-
-      // Maximum VM protection.
-      r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Initial VM protection.
-      r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Number of sections in segment.
-      quint32 nsects = r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Flags.
-      r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Read sections.
-      if (nsects > 0) {
-        for (decltype(nsects) j = 0; j < nsects; j++) {
-          QString secname{r.read(16)};
-
-          QString segname{r.read(16)};
-
-          // Memory address of this section.
-          quint64 addr = 0;
-          if (systemBits == 32) {
-            addr = r.getUInt32(&ok);
-            if (!ok) return false;
-          }
-          else {
-            addr = r.getUInt64(&ok);
-            if (!ok) return false;
-          }
-
-          // Size in bytes of this section.
-          quint64 secsize = 0;
-          if (systemBits == 32) {
-            secsize = r.getUInt32(&ok);
-            if (!ok) return false;
-          }
-          else {
-            secsize = r.getUInt64(&ok);
-            if (!ok) return false;
-          }
+      // Read all sections at once.
+      Record sections;
+      if (!r.getRecord(qint64(nsects) * L::sectionSize, sections)) return nullptr;
 
-          // File offset of this section.
-          quint32 secfileoff = r.getUInt32(&ok);
-          if (!ok) return false;
+      for (decltype(nsects) j = 0; j < nsects; j++) {
+        const auto base = qint64(j) * L::sectionSize;
 
-          // Section alignment (power of 2).
-          r.getUInt32(&ok);
-          if (!ok) return false;
+        const QString secname{sections.bytes(base, 16)};
+        const QString segname{sections.bytes(base + 16, 16)};
 
-          // File offset of relocation entries.
-          r.getUInt32(&ok);
-          if (!ok) return false;
+        // Memory address of this section.
+        const quint64 addr = sections.template get<Word>(base + 32);
 
-          // Number of relocation entries.
-          r.getUInt32(&ok);
-          if (!ok) return false;
+        // Size in bytes of this section.
+        const quint64 secsize = sections.template get<Word>(base + 32 + L::wordSize);
 
-          // Flags.
-          r.getUInt32(&ok);
-          if (!ok) return false;
+        // File offset of this section. It is followed by alignment, and file offset and number of
+        // relocation entries.
+        const auto secfileoff = sections.template get<quint32>(base + 32 + 2 * L::wordSize);
 
-          // Reserved fields.
-          r.getUInt32();
-          r.getUInt32();
-          if (systemBits == 64) {
-            r.getUInt32();
-          }
+        // Flags, followed by reserved fields.
+        const auto secflags = sections.template get<quint32>(base + 32 + 2 * L::wordSize + 4 * 4);
 
-          // Store needed sections.
-          if (segname == "__TEXT") {
-            if (secname == "__text") {
-              auto sec = std::make_unique<Section>(Section::Type::TEXT, QObject::tr("Program"),
-                                                   addr, secsize, offset + secfileoff);
-              binaryObject->addSection(std::move(sec));
-            }
-            else if (secname == "__symbol_stub" || secname == "__stubs") {
-              auto sec =
-                std::make_unique<Section>(Section::Type::SYMBOL_STUBS, QObject::tr("Symbol Stubs"),
+        std::unique_ptr<Section> sec;
+        if (segname == "__TEXT" && secname == "__text") {
+          sec = std::make_unique<Section>(Section::Type::TEXT, QObject::tr("Program"), addr,
+                                          secsize, offset + secfileoff);
+        }
+        else if (segname == "__TEXT" && (secname == "__symbol_stub" || secname == "__stubs")) {
+          sec = std::make_unique<Section>(Section::Type::SYMBOL_STUBS, QObject::tr("Symbol Stubs"),
                                           addr, secsize, offset + secfileoff);
-              binaryObject->addSection(std::move(sec));
-            }
-            else if (secname == "__cstring") {
-              auto sec = std::make_unique<Section>(Section::Type::CSTRING, QObject::tr("C-Strings"),
-                                                   addr, secsize, offset + secfileoff);
-              binaryObject->addSection(std::move(sec));
-            }
-            else if (secname == "__objc_methname") {
-              auto sec =
-                std::make_unique<Section>(Section::Type::CSTRING, QObject::tr("ObjC Method Names"),
+        }
+        else if (segname == "__TEXT" && secname == "__cstring") {
+          sec = std::make_unique<Section>(Section::Type::CSTRING, QObject::tr("C-Strings"), addr,
+                                          secsize, offset + secfileoff);
+        }
+        else if (segname == "__TEXT" && secname == "__objc_methname") {
+          sec = std::make_unique<Section>(Section::Type::CSTRING, QObject::tr("ObjC Method Names"),
                                           addr, secsize, offset + secfileoff);
-              binaryObject->addSection(std::move(sec));
-            }
+        }
+
+        // Expose all other sections, too, since their data is only read when accessed.
+        else {
+          sec = std::make_unique<Section>(Section::Type::OTHER,
+                                          QString("%1,%2").arg(segname, secname), addr, secsize,
+                                          offset + secfileoff);
+
+          // S_ZEROFILL, S_GB_ZEROFILL or S_THREAD_LOCAL_ZEROFILL sections have no data in the file.
+          const auto sectype = secflags & 0xFF;
+          if (sectype == 0x1 || sectype == 0xC || sectype == 0x12) {
+            zeroFill << sec.get();
           }
         }
+
+        binaryObject->addSection(std::move(sec));
       }
     }
 
@@ -482,62 +630,62 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
     else if (type == 0x22 || type == (0x22 | 0x80000000)) {
       // File offset to rebase info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Size of rebase info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to binding info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Size of binding info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to weak binding info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Size of weak binding info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to lazy binding info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Size of lazy binding info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to export info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Size of export info.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
     }
 
     // LC_SYMTAB
     else if (type == 2) {
       // Symbol table offset.
       symoff = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of symbol table entries.
       symnum = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // String table offset.
       quint32 stroff = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // String table size in bytes.
       quint32 strsize = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       auto sec = std::make_unique<Section>(Section::Type::STRING, QObject::tr("String Table"),
                                            stroff, strsize, offset + stroff);
@@ -548,94 +696,94 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
     else if (type == 0xB) {
       // Index to local symbols.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of local symbols.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Index to externally defined symbols.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of externally defined symbols.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Index to undefined defined symbols.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of undefined defined symbols.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to table of contents.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of entries in the table of contents.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to module table.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of module table entries.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to referenced symbol table.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of referenced symbol table entries.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to indirect symbol table.
       indirsymoff = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of indirect symbol table entries.
       indirsymnum = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to external relocation entries.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of external relocation entries.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File offset to local relocation entries.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of local relocation entries.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
     }
 
     // LC_LOAD_DYLIB, LC_ID_DYLIB, LC_LOAD_WEAK_DYLIB, LC_REEXPORT_DYLIB
     else if (type == 0xC || type == 0xD || type == 0x18 + 0x80000000 || type == 0x1F + 0x80000000) {
       // Library path name offset.
       quint32 liboffset = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Time stamp.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Current version.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Compatibility version.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Library path name.
       r.read(cmdsize - liboffset);
@@ -645,7 +793,7 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
     else if (type == 0xE || type == 0xF || type == 0x27) {
       // Dynamic linker's path name.
       quint32 noffset = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       r.read(cmdsize - noffset);
     }
@@ -661,11 +809,11 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
       // Version (X.Y.Z is encoded in nibbles xxxx.yy.zz)
       const auto targetAddr = r.pos();
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // SDK version (X.Y.Z is encoded in nibbles xxxx.yy.zz)
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       if (type == 0x24) {
         auto sec = std::make_unique<Section>(Section::Type::LC_VERSION_MIN_MACOSX,
@@ -697,18 +845,18 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
     else if (type == 0x2A) {
       // Version (A.B.C.D.E packed as a24.b10.c10.d10.e10)
       r.getUInt64(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
     }
 
     // LC_MAIN
     else if (type == (0x28 | 0x80000000)) {
       // File (__TEXT) offset of main()
       r.getUInt64(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Initial stack size if not zero.
       r.getUInt64(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
     }
 
     // LC_FUNCTION_STARTS, LC_DYLIB_CODE_SIGN_DRS, LC_SEGMENT_SPLIT_INFO, LC_CODE_SIGNATURE,
@@ -717,11 +865,11 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
              type == (0x33 | 0x80000000) || type == (0x34 | 0x80000000)) {
       // File offset to data in __LINKEDIT segment.
       quint32 off = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // File size of data in __LINKEDIT segment.
       quint32 siz = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // LC_FUNCTION_STARTS
       if (type == 0x26) {
@@ -742,24 +890,24 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
     else if (type == 0x29) {
       // From mach_header to start of data range.
       r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Number of bytes in data range.
       r.getUInt16(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Dice kind value.
       r.getUInt16(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
     }
 
     // LC_THREAD or LC_UNIXTHREAD
     else if (type == 0x4 || type == 0x5) {
       quint32 flavor = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       quint32 count = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Data.
       r.read(qint64(flavor) * qint64(count));
@@ -769,7 +917,7 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
     else if (type == 0x1C + 0x80000000) {
       // Name offset.
       quint32 off = r.getUInt32(&ok);
-      if (!ok) return false;
+      if (!ok) return nullptr;
 
       // Name.
       r.read(cmdsize - off);
@@ -803,45 +951,16 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
 
   // Parse symbol table if found.
   // (/usr/include/macho/nlist.h)
-  quint32 symsize{0};
   SymbolTable symTable;
   if (symnum > 0) {
-    r.seek(symoff);
-    qint64 pos = 0;
-    for (decltype(symnum) i = 0; i < symnum; i++) {
-      pos = r.pos();
-
-      // Index into the string table.
-      quint32 index = r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Type flag.
-      r.getUChar(&ok);
-      if (!ok) return false;
+    // The offset is relative to the start of the object file.
+    r.seek(offset + symoff);
 
-      // Section number or NO_SECT.
-      r.getUChar(&ok);
-      if (!ok) return false;
-
-      // Description.
-      r.getUInt16(&ok);
-      if (!ok) return false;
-
-      // Value of the symbol (or stab offset).
-      quint64 value = 0;
-      if (systemBits == 32) {
-        value = r.getUInt32(&ok);
-        if (!ok) return false;
-      }
-      else {
-        value = r.getUInt64(&ok);
-        if (!ok) return false;
-      }
-
-      symTable.addSymbol(SymbolEntry(index, value));
-      symsize += (r.pos() - pos);
-    }
+    auto parsed = readSymbols<Bits, E>(r, symnum);
+    if (!parsed) return nullptr;
+    symTable = std::move(*parsed);
 
+    const quint32 symsize = symnum * L::nlistSize;
     auto sec = std::make_unique<Section>(Section::Type::SYMBOLS, QObject::tr("Symbol Table"),
                                          symoff, symsize, offset + symoff);
     binaryObject->addSection(std::move(sec));
@@ -849,31 +968,77 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
 
   // Parse dynamic symbol table if found. Store the offsets into the
   // symbol table for later updating.
-  quint32 dynsymsize{0};
   SymbolTable dynsymTable;
   if (indirsymnum > 0) {
-    r.seek(indirsymoff);
-    qint64 pos = 0;
-    for (decltype(indirsymnum) i = 0; i < indirsymnum; i++) {
-      pos = r.pos();
+    r.seek(offset + indirsymoff);
 
-      quint32 num = r.getUInt32(&ok);
-      if (!ok) return false;
+    // Each entry is a 32-bit index into the symbol table.
+    const auto indices = r.getUInt32Array(indirsymnum, &ok);
+    if (!ok) return nullptr;
 
-      dynsymTable.addSymbol(SymbolEntry(num, 0));
-      dynsymsize += (r.pos() - pos);
+    auto &dynsymbols = dynsymTable.symbols();
+    dynsymbols.reserve(indices.size());
+    for (const auto num : indices) {
+      dynsymbols.emplace_back(num, 0);
     }
 
+    const quint32 dynsymsize = indirsymnum * sizeof(quint32);
     auto sec =
       std::make_unique<Section>(Section::Type::DYN_SYMBOLS, QObject::tr("Dynamic Symbol Table"),
                                 indirsymoff, dynsymsize, offset + indirsymoff);
     binaryObject->addSection(std::move(sec));
   }
 
-  // Fill data of stored sections.
-  for (auto &sec : binaryObject->sections()) {
-    r.seek(sec->offset());
-    sec->setData(r.read(sec->size()));
+  // Expose the parts of segments without sections that no other section covers, like the dyld
+  // info of __LINKEDIT, so all data can be browsed without any being in two sections.
+  if (!segments.empty()) {
+    std::vector<std::pair<quint64, quint64>> covered; // File offsets [begin, end).
+    for (const auto *sec : binaryObject->sections()) {
+      if (!zeroFill.contains(sec)) {
+        covered.emplace_back(sec->offset(), sec->offset() + sec->size());
+      }
+    }
+    std::sort(covered.begin(), covered.end());
+
+    for (const auto &segment : segments) {
+      const quint64 begin = offset + segment.fileoff, end = begin + segment.filesize;
+      const auto addGap = [&](quint64 gapBegin, quint64 gapEnd) {
+        const auto name = (gapBegin == begin ? segment.name
+                                             : QString("%1+0x%2")
+                                                 .arg(segment.name)
+                                                 .arg(gapBegin - begin, 0, 16));
+        binaryObject->addSection(std::make_unique<Section>(Section::Type::SEGMENT, name,
+                                                           segment.vmaddr + (gapBegin - begin),
+                                                           gapEnd - gapBegin,
+                                                           static_cast<quint32>(gapBegin)));
+      };
+
+      auto pos = begin;
+      for (const auto &range : covered) {
+        if (range.second <= pos) continue;
+        if (range.first >= end) break;
+        if (range.first > pos) {
+          addGap(pos, range.first);
+        }
+        pos = range.second;
+      }
+      if (pos < end) {
+        addGap(pos, end);
+      }
+    }
+  }
+
+  // Defer data of sections to the mapping, except zero-filled sections that have none.
+  for (auto *sec : binaryObject->sections()) {
+    if (!zeroFill.contains(sec)) {
+      sec->mapData(mapping);
+    }
+  }
+
+  // Function starts give function boundaries even when stripped of symbols.
+  if (const auto *funcStarts = binaryObject->section(Section::Type::FUNC_STARTS);
+      funcStarts != nullptr && textAddress) {
+    binaryObject->setFunctionStarts(decodeFunctionStarts(funcStarts->data(), *textAddress));
   }
 
   // If symbol table loaded then merge string table entries into it.
@@ -919,8 +1084,7 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r)
     binaryObject->setDynSymbolTable(std::move(dynsymTable));
   }
 
-  objects_.emplace_back(std::move(binaryObject));
-  return true;
+  return binaryObject;
 }
 
 } // namespace dispar
@@ -1,37 +1,73 @@
 #ifndef DISPAR_MACHO_FORMAT_H
 #define DISPAR_MACHO_FORMAT_H
 
+#include "Constants.h"
 #include "formats/Format.h"
 
+#include <QMutex>
+#include <QSet>
+
+#include <optional>
 #include <vector>
 
 namespace dispar {
 
+class BinaryObject;
 class Reader;
+class MappedFile;
 
 class MachO : public Format {
 public:
   MachO(const QString &file);
+
+  /// Use already opened \p mapping of \p file instead of opening it again.
+  MachO(const QString &file, std::shared_ptr<const MappedFile> mapping);
   ~MachO() override = default;
 
-  MachO(const MachO &other) = default;
-  MachO &operator=(const MachO &rhs) = default;
+  MachO(const MachO &other) = delete;
+  MachO &operator=(const MachO &rhs) = delete;
 
-  MachO(MachO &&other) = default;
-  MachO &operator=(MachO &&rhs) = default;
+  MachO(MachO &&other) = delete;
+  MachO &operator=(MachO &&rhs) = delete;
 
   [[nodiscard]] QString file() const override;
 
   bool detect() override;
   bool parse() override;
 
+  [[nodiscard]] QList<ObjectSummary> summaries() const override;
+  [[nodiscard]] BinaryObject *object(int index) const override;
   [[nodiscard]] QList<BinaryObject *> objects() const override;
+  [[nodiscard]] QList<BinaryObject *> parsedObjects() const override;
+  [[nodiscard]] QList<int> failedObjects() const override;
+
+  [[nodiscard]] QByteArray fingerprint() const override;
+  [[nodiscard]] std::shared_ptr<const MappedFile> mappedFile() const override;
 
 private:
-  bool parseHeader(quint32 offset, quint32 size, Reader &reader);
+  /// Reads only the header of the object file at \p offset of the mapping.
+  [[nodiscard]] std::optional<ObjectSummary> readSummary(quint32 offset, quint32 size) const;
+
+  /// Parses the object file at \p offset of the mapping.
+  /** Returns nullptr on failure. Only reads the mapping, so distinct object files can be parsed
+      concurrently. */
+  [[nodiscard]] std::unique_ptr<BinaryObject> parseHeader(quint32 offset, quint32 size) const;
+
+  /// Parses the object file at \p offset with word size \p Bits and byte order \p E.
+  template <int Bits, Constants::Endianness E>
+  [[nodiscard]] std::unique_ptr<BinaryObject> parseObject(quint32 offset, Reader &reader) const;
 
   QString file_;
-  std::vector<std::unique_ptr<BinaryObject>> objects_;
+  std::shared_ptr<const MappedFile> mapping;
+  QByteArray fingerprint_;
+  QList<ObjectSummary> summaries_;
+
+  /// Objects are parsed on first access, so null until then.
+  mutable std::vector<std::unique_ptr<BinaryObject>> objects_;
+  mutable QMutex objectsMutex;
+
+  /// Indices of objects that failed to parse.
+  mutable QSet<int> failed;
 };
 
 } // namespace dispar
@@ -64,8 +64,14 @@ bool saveFile(const std::shared_ptr<Format> &format)
 
 int handleParse(const std::shared_ptr<Format> &format)
 {
+  const auto text = format->toString();
+  if (const auto failed = format->failedObjects(); !failed.isEmpty()) {
+    qInfo().noquote() << text;
+    qCritical() << "Could not parse binary objects:" << failed;
+    return 1;
+  }
   qInfo() << "Binary parsed successfully!";
-  qInfo().noquote() << format->toString();
+  qInfo().noquote() << text;
   return 0;
 }
 
@@ -102,8 +108,15 @@ int handlePatchSdk(const std::shared_ptr<Format> &format, const Section::Type ty
     qInfo().nospace() << "- Source SDK: " << std::get<0>(sdk) << "." << std::get<1>(sdk);
   };
 
+  // Don't leave objects unpatched that couldn't be parsed.
+  const auto objects = format->objects();
+  if (const auto failed = format->failedObjects(); !failed.isEmpty()) {
+    qCritical() << "Could not parse binary objects:" << failed;
+    return 1;
+  }
+
   bool modified = false;
-  for (const auto *object : format->objects()) {
+  for (const auto *object : objects) {
     auto *section = object->section(type);
     if (section == nullptr) {
       qInfo() << "[" << qPrintable(object->toString()) << "]";
@@ -16,20 +16,28 @@
 #include <QPlainTextEdit>
 #include <QProgressDialog>
 #include <QPushButton>
+#include <QScrollBar>
 #include <QSet>
 #include <QTabWidget>
 #include <QTextBlockUserData>
 #include <QTimer>
 
+#include <algorithm>
 #include <cassert>
 
 #include "AddrHexAsciiEncoder.h"
 #include "BinaryObject.h"
 #include "CStringReader.h"
+#include "Constants.h"
 #include "Context.h"
+#include "DisassemblerPool.h"
+#include "HexDump.h"
+#include "LazyDisassembly.h"
+#include "MappedFile.h"
 #include "MacSdkVersionPatcher.h"
 #include "Project.h"
 #include "Reader.h"
+#include "StringExtractor.h"
 #include "Util.h"
 #include "cxx.h"
 #include "widgets/BinaryWidget.h"
@@ -50,6 +58,7 @@ public:
   int addressStart = 0, addressEnd = 0;
   int bytesStart = 0, bytesEnd = 0;
   QString bytes;
+  dispar::Disassembler::Syntax syntax = dispar::Disassembler::Syntax::INTEL;
 };
 
 } // namespace
@@ -63,10 +72,13 @@ BinaryWidget::BinaryWidget(BinaryObject *object) : object_(object), context(Cont
 
   connect(&context, &Context::showMachineCodeChanged, this,
           &BinaryWidget::onShowMachineCodeChanged);
+  connect(&context, &Context::disassemblerSyntaxChanged, this,
+          &BinaryWidget::onDisassemblerSyntaxChanged);
 }
 
 BinaryWidget::~BinaryWidget()
 {
+  cancelStringExtraction();
   qDeleteAll(disassemblyEditors.values());
   qDeleteAll(hexEditors.values());
   qDeleteAll(macSdkVersionsEditors.values());
@@ -77,6 +89,38 @@ void BinaryWidget::reloadUi()
   setup();
 }
 
+quint64 BinaryWidget::currentAddress() const
+{
+  if (mainView == nullptr) {
+    return 0;
+  }
+
+  const auto block = mainView->textCursor().block();
+  ensureBlockData(block);
+  const auto *userData = dynamic_cast<TextBlockUserData *>(block.userData());
+  return userData != nullptr ? userData->address : 0;
+}
+
+void BinaryWidget::setMappedFile(std::shared_ptr<const MappedFile> file_, quint64 offset,
+                                 quint64 size)
+{
+  file = std::move(file_);
+  fileOffset = offset;
+  fileSize = size;
+}
+
+void BinaryWidget::stopStringExtraction()
+{
+  cancelStringExtraction();
+  file.reset();
+  stringList_->setSortingEnabled(true);
+}
+
+void BinaryWidget::setStartAddress(quint64 address)
+{
+  startAddress = address;
+}
+
 void BinaryWidget::showEvent(QShowEvent *event)
 {
   if (!shown) {
@@ -130,10 +174,23 @@ void BinaryWidget::onCursorPositionChanged()
   mainView->setExtraSelections({selection});
 
   const auto block = cursor.block();
+  ensureBlockData(block);
   const auto *userData = dynamic_cast<TextBlockUserData *>(block.userData());
   if (userData != nullptr) {
-    addressLabel->setText(
-      tr("Address: 0x%1 (%2)").arg(userData->address, 0, 16).arg(userData->address));
+    auto addressText =
+      tr("Address: 0x%1 (%2)").arg(userData->address, 0, 16).arg(userData->address);
+
+    // Show where the address is relative to the closest symbol of the same section.
+    const auto index = object_->addressIndex();
+    const auto *section = index->section(userData->address);
+    if (const auto symbol = index->symbolAtOrBefore(userData->address);
+        section != nullptr && symbol && section->hasAddress(*symbol)) {
+      const auto name = demangle(*index->symbol(*symbol));
+      addressText += *symbol == userData->address
+                       ? QString(" <%1>").arg(name)
+                       : QString(" <%1+0x%2>").arg(name).arg(userData->address - *symbol, 0, 16);
+    }
+    addressLabel->setText(addressText);
     offsetLabel->setText(
       tr("Offset: 0x%1 (%2)").arg(userData->offset, 0, 16).arg(userData->offset));
 
@@ -166,7 +223,7 @@ void BinaryWidget::onShowMachineCodeChanged(bool show)
   auto cursor = mainView->textCursor();
   cursor.beginEditBlock();
 
-  auto block = doc->findBlockByNumber(codeBlocks.first());
+  auto block = doc->firstBlock();
   while (block.isValid()) {
     auto *userData = dynamic_cast<TextBlockUserData *>(block.userData());
     if ((userData != nullptr) && !userData->bytes.isEmpty()) {
@@ -190,6 +247,17 @@ void BinaryWidget::onShowMachineCodeChanged(bool show)
   qDebug() << "Modified machine code visibility in" << elapsedTimer.restart() << "ms";
 }
 
+void BinaryWidget::onDisassemblerSyntaxChanged(Disassembler::Syntax syntax)
+{
+  // Instructions are printed again when shown instead of disassembling everything again.
+  for (auto &entry : lazySections) {
+    if (entry.second.disasm) {
+      entry.second.disasm->setSyntax(syntax);
+    }
+  }
+  renderVisibleInstructions();
+}
+
 void BinaryWidget::onCustomContextMenuRequested(const QPoint &pos)
 {
   QMenu menu(mainView);
@@ -203,6 +271,7 @@ void BinaryWidget::onCustomContextMenuRequested(const QPoint &pos)
   }
 
   auto cursor = mainView->textCursor();
+  ensureBlockData(cursor.block());
   const auto *userData = dynamic_cast<TextBlockUserData *>(cursor.block().userData());
   if (userData != nullptr) {
     for (auto *section : object_->sections()) {
@@ -214,6 +283,7 @@ void BinaryWidget::onCustomContextMenuRequested(const QPoint &pos)
           section->type() == Section::Type::SYMBOL_STUBS) {
         menu.addAction(tr("Edit '%1'").arg(section->toString()), this, [this, section] {
           const auto priorModRegions = section->modifiedRegions();
+          if (!ensureDisassembled(section)) return;
 
           auto *editor = disassemblyEditors.value(section, nullptr);
           if (editor == nullptr) {
@@ -243,18 +313,18 @@ void BinaryWidget::onCustomContextMenuRequested(const QPoint &pos)
         });
       }
 
-      menu.addAction(tr("Hex edit '%1'").arg(section->toString()), this, [this, section] {
-        const auto priorModRegions = section->modifiedRegions();
-
-        auto *editor = hexEditors.value(section, nullptr);
-        if (editor == nullptr) {
-          editor = new HexEditor(section, object_, this);
-          hexEditors[section] = editor;
-        }
+      menu.addAction(tr("Hex edit '%1'").arg(section->toString()), this,
+                     [this, section] { hexEdit(section); });
+    }
+  }
 
-        editor->exec();
-        checkModified(section, priorModRegions);
-      });
+  // Sections that aren't shown in the view are only read when hex edited.
+  if (const auto others =
+        object_->sectionsByTypes({Section::Type::OTHER, Section::Type::SEGMENT});
+      !others.isEmpty()) {
+    auto *otherMenu = menu.addMenu(tr("Hex Edit Section"));
+    for (auto *section : others) {
+      otherMenu->addAction(section->toString(), this, [this, section] { hexEdit(section); });
     }
   }
 
@@ -283,6 +353,20 @@ void BinaryWidget::onCustomContextMenuRequested(const QPoint &pos)
   menu.exec(mainView->mapToGlobal(pos));
 }
 
+void BinaryWidget::hexEdit(Section *section)
+{
+  const auto priorModRegions = section->modifiedRegions();
+
+  auto *editor = hexEditors.value(section, nullptr);
+  if (editor == nullptr) {
+    editor = new HexEditor(section, object_, this);
+    hexEditors[section] = editor;
+  }
+
+  editor->exec();
+  checkModified(section, priorModRegions);
+}
+
 void BinaryWidget::filterSymbols(const QString &filter)
 {
   QElapsedTimer elapsedTimer;
@@ -506,9 +590,17 @@ void BinaryWidget::createLayout()
           &BinaryWidget::onCursorPositionChanged);
   connect(mainView, &QWidget::customContextMenuRequested, this,
           &BinaryWidget::onCustomContextMenuRequested);
+  connect(mainView->verticalScrollBar(), &QScrollBar::valueChanged, this,
+          &BinaryWidget::loadVisibleLazySections);
+  connect(mainView->verticalScrollBar(), &QScrollBar::valueChanged, this,
+          &BinaryWidget::renderVisibleInstructions);
 
   doc = mainView->document();
 
+  // Lines are only changed programmatically, and text of lazily disassembled sections that is
+  // removed again must not be kept for undoing.
+  doc->setUndoRedoEnabled(false);
+
   auto *vertSplitter = new PersistentSplitter("BinaryWidget.vertSplitter");
   vertSplitter->addWidget(symbolsWidget);
   vertSplitter->addWidget(mainView);
@@ -528,6 +620,7 @@ void BinaryWidget::setup()
   setupElapsedTimer.start();
 
   // Make sure we start from a clean slate.
+  cancelStringExtraction();
   mainView->clear();
 
   symbolList_->clear();
@@ -541,7 +634,8 @@ void BinaryWidget::setup()
 
   offsetBlock.clear();
   sectionBlock.clear();
-  codeBlocks.clear();
+  lazySections.clear();
+  hexSections.clear();
 
   setupDiag = new QProgressDialog(this);
   setupDiag->setCancelButton(nullptr);
@@ -569,19 +663,27 @@ void BinaryWidget::setup()
   symbolList_->setSortingEnabled(true);
   symbolList_->setEnabled(true);
 
-  stringList_->setSortingEnabled(true);
+  // Sorted when all extracted strings have been added.
   stringList_->setEnabled(true);
 
   tagList_->setSortingEnabled(true);
   tagList_->setEnabled(true);
 
-  if (!offsetBlock.isEmpty()) {
+  if (hasAddress(startAddress)) {
+    selectAddress(startAddress);
+  }
+  else if (!offsetBlock.isEmpty() || !lazySections.empty() || !hexSections.empty()) {
     selectAddress(firstAddress);
   }
 
   setupDiag->deleteLater();
   setupCursor.reset();
 
+  loadVisibleLazySections();
+
+  // Disassembly kept from before might be in another syntax.
+  renderVisibleInstructions();
+
   emit loaded();
 }
 
@@ -597,7 +699,8 @@ void BinaryWidget::updateTagList()
   }
 }
 
-void BinaryWidget::addSymbolToList(const QString &text, quint64 address, QListWidget *list)
+QListWidgetItem *BinaryWidget::addSymbolToList(const QString &text, quint64 address,
+                                               QListWidget *list)
 {
   class ListWidgetItem : public QListWidgetItem {
   public:
@@ -621,21 +724,421 @@ void BinaryWidget::addSymbolToList(const QString &text, quint64 address, QListWi
   item->setData(Qt::UserRole, address);
   item->setToolTip(QString("0x%1").arg(address, 0, 16));
   list->addItem(item);
+  return item;
 }
 
 void BinaryWidget::selectAddress(quint64 address)
 {
-  if (!offsetBlock.contains(address)) {
+  ensureShown(address);
+  auto block = addressBlock(address);
+  if (!block.isValid()) {
+    const auto line = lineAddress(address);
+    if (!line) return;
+    block = addressBlock(*line);
+    if (!block.isValid()) return;
+  }
+
+  selectBlock(block);
+}
+
+std::optional<quint64> BinaryWidget::lineAddress(quint64 address)
+{
+  const auto index = object_->addressIndex();
+  const auto *section = index->section(address);
+  if (section == nullptr) {
+    return std::nullopt;
+  }
+
+  // Instructions are relative to the section.
+  const auto offset = address - section->address();
+  const Disassembler::Result *disasm = section->disassembly();
+  LazyDisassembly::Window window;
+  if (const auto it = lazySections.find(section);
+      disasm == nullptr && it != lazySections.end() && it->second.disasm->valid()) {
+    window = it->second.disasm->window(static_cast<quint32>(offset));
+    disasm = window.get();
+  }
+  if (disasm != nullptr) {
+    auto pos = disasm->position(offset);
+    if (pos == disasm->count() || disasm->baseAddress() + disasm->offset(pos) > offset) {
+      if (pos == 0) {
+        return std::nullopt;
+      }
+      pos--;
+    }
+    return section->address() + disasm->baseAddress() + disasm->offset(pos);
+  }
+
+  // Otherwise the row of the hex dump, the closest symbol of the section, or the section itself.
+  if (hexSections.count(section) > 0) {
+    return address - offset % HexDump::bytesPerLine;
+  }
+  const auto symbol = index->symbolAtOrBefore(address);
+  return symbol && section->hasAddress(*symbol) ? *symbol : section->address();
+}
+
+bool BinaryWidget::hasAddress(quint64 address) const
+{
+  if (offsetBlock.contains(address) || hexBlock(address).isValid()) {
+    return true;
+  }
+  return std::any_of(lazySections.cbegin(), lazySections.cend(), [address](const auto &entry) {
+    return entry.second.disasm->valid() && entry.first->hasAddress(address);
+  });
+}
+
+void BinaryWidget::setupLazySection(const Section *section)
+{
+  auto &lazy = lazySections[section];
+  lazy.disasm = std::make_unique<LazyDisassembly>(context.disassemblerPool(), *object_, *section,
+                                                  context.disassemblerSyntax());
+  if (!lazy.disasm->valid()) return;
+
+  // Symbols and function starts are known to start instructions.
+  std::vector<quint32> boundaries;
+  for (const auto start :
+       object_->addressIndex()->starts(section->address(), section->address() + section->size())) {
+    boundaries.push_back(static_cast<quint32>(start - section->address()));
+  }
+  lazy.disasm->addBoundaries(boundaries);
+
+  // All of it is a gap until shown.
+  if (const auto size = static_cast<quint32>(section->data().size()); size > 0) {
+    appendPlaceholder(section, 0, size);
+  }
+}
+
+void BinaryWidget::appendPlaceholder(const Section *section, quint32 begin, quint32 end)
+{
+  setupCursor->insertBlock();
+  setupCursor->insertText(QString("%1%2")
+                            .arg(QString("0x%1").arg(section->address() + begin, 0, 16), -20)
+                            .arg(tr("; %1 bytes are disassembled when shown").arg(end - begin)));
+}
+
+std::vector<BinaryWidget::LazySpan> BinaryWidget::lazySpans(const Section *section) const
+{
+  std::vector<LazySpan> spans;
+  const auto it = lazySections.find(section);
+  const auto header = sectionBlock.value(section);
+  if (it == lazySections.cend() || !it->second.disasm->valid() || !header.isValid()) {
+    return spans;
+  }
+
+  const auto size = static_cast<quint32>(section->data().size());
+  auto block = header.blockNumber() + 1;
+  quint32 pos = 0;
+  for (const auto &[start, window] : it->second.shown) {
+    if (start > pos) {
+      spans.push_back({pos, start, block++, 1, false});
+    }
+    spans.push_back({start, window.end, block, window.blocks, true});
+    block += window.blocks;
+    pos = std::max(pos, window.end);
+  }
+  if (pos < size) {
+    spans.push_back({pos, size, block, 1, false});
+  }
+  return spans;
+}
+
+void BinaryWidget::showWindow(const Section *section, const Disassembler::Result &window)
+{
+  const auto begin = static_cast<quint32>(window.baseAddress());
+  const auto end = static_cast<quint32>(window.endAddress());
+
+  const auto spans = lazySpans(section);
+  const auto gap = cxx::find_if(spans, [begin](const auto &span) {
+    return !span.shown && span.begin <= begin && begin < span.end;
+  });
+  if (gap == spans.cend()) return;
+
+  // What is left of the gap on either side keeps a placeholder.
+  const bool before = begin > gap->begin, after = end < gap->end;
+  const auto blocks = replaceBlocks(gap->block, 1, [&] {
+    if (before) {
+      appendPlaceholder(section, gap->begin, begin);
+    }
+    appendDisassembly(section, window);
+    if (after) {
+      appendPlaceholder(section, end, gap->end);
+    }
+  });
+
+  auto &lazy = lazySections[section];
+  lazy.shown[begin] = {end, blocks - int(before) - int(after), ++lazyUses};
+}
+
+void BinaryWidget::evictWindows(const Section *section)
+{
+  auto &lazy = lazySections[section];
+  while (static_cast<int>(lazy.shown.size()) > Constants::Disassembly::CACHED_WINDOWS) {
+    const auto [first, last] = visibleBlocks();
+    const auto spans = lazySpans(section);
+
+    std::optional<std::size_t> lru;
+    for (std::size_t i = 0; i < spans.size(); i++) {
+      const auto &span = spans[i];
+      if (!span.shown || (span.block + span.blocks > first && span.block <= last)) continue;
+      if (!lru || lazy.shown[span.begin].used < lazy.shown[spans[*lru].begin].used) {
+        lru = i;
+      }
+    }
+    if (!lru) return;
+
+    // The window and the gaps around it become one gap.
+    const auto &span = spans[*lru];
+    const bool before = *lru > 0 && !spans[*lru - 1].shown;
+    const bool after = *lru + 1 < spans.size() && !spans[*lru + 1].shown;
+    const auto begin = before ? spans[*lru - 1].begin : span.begin;
+    const auto end = after ? spans[*lru + 1].end : span.end;
+
+    lazy.shown.erase(span.begin);
+    lazy.failed.erase(lazy.failed.lower_bound(begin), lazy.failed.lower_bound(end));
+    replaceBlocks(before ? spans[*lru - 1].block : span.block,
+                  span.blocks + int(before) + int(after),
+                  [&] { appendPlaceholder(section, begin, end); });
+  }
+}
+
+int BinaryWidget::replaceBlocks(int first, int count, const std::function<void()> &append)
+{
+  auto *scrollBar = mainView->verticalScrollBar();
+  const auto top = scrollBar->value();
+  const auto blockCount = doc->blockCount();
+
+  // The setup cursor is used for appending, and it might be in use by setup itself.
+  auto previousCursor = std::move(setupCursor);
+  setupCursor = std::make_unique<QTextCursor>(doc->findBlockByNumber(first - 1));
+  setupCursor->movePosition(QTextCursor::EndOfBlock);
+  if (count > 0) {
+    const auto lastBlock = doc->findBlockByNumber(first + count - 1);
+    setupCursor->setPosition(lastBlock.position() + lastBlock.length() - 1,
+                             QTextCursor::KeepAnchor);
+    setupCursor->removeSelectedText();
+  }
+  append();
+
+  // Lines are blocks since they aren't wrapped. Scrolling while the setup cursor is in use doesn't
+  // load anything.
+  const auto delta = doc->blockCount() - blockCount;
+  if (first + count - 1 <= top) {
+    scrollBar->setValue(top + delta);
+  }
+  setupCursor = std::move(previousCursor);
+
+  return count + delta;
+}
+
+void BinaryWidget::loadVisibleLazySections()
+{
+  // Nothing is loaded during setup or while blocks are being replaced.
+  if (lazySections.empty() || setupCursor != nullptr) return;
+
+  // Show windows where gaps are within a couple of pages of the view, a few at a time. Gaps at the
+  // top of the view or above are reached by scrolling up, so they are filled from their end.
+  for (int i = 0; i <= Constants::Disassembly::READ_AHEAD_WINDOWS; i++) {
+    const auto [first, last] = visibleBlocks();
+    const auto margin = 2 * (last - first) + 1;
+
+    bool loaded = false;
+    for (auto &[section, lazy] : lazySections) {
+      for (const auto &span : lazySpans(section)) {
+        if (span.block + span.blocks <= first - margin || span.block > last + margin) continue;
+        if (span.shown) {
+          if (span.block + span.blocks > first && span.block <= last) {
+            lazy.shown[span.begin].used = ++lazyUses;
+          }
+          continue;
+        }
+        if (lazy.failed.count(span.begin) > 0) continue;
+
+        const auto offset =
+          span.block > first
+            ? span.begin
+            : span.end - std::min<quint32>(span.end - span.begin,
+                                           Constants::Disassembly::WINDOW_SIZE);
+        const auto window = lazy.disasm->window(offset);
+        if (!window) {
+          lazy.failed.insert(span.begin);
+          continue;
+        }
+        showWindow(section, *window);
+        evictWindows(section);
+        loaded = true;
+        break;
+      }
+    }
+    if (!loaded) break;
+  }
+}
+
+std::pair<int, int> BinaryWidget::visibleBlocks() const
+{
+  const auto rect = mainView->viewport()->rect();
+  return {mainView->cursorForPosition(rect.topLeft()).blockNumber(),
+          mainView->cursorForPosition(rect.bottomLeft()).blockNumber()};
+}
+
+void BinaryWidget::renderVisibleInstructions()
+{
+  const auto syntax = context.disassemblerSyntax();
+  const auto [first, last] = visibleBlocks();
+  const auto index = object_->addressIndex();
+  DisassemblerPool::Handle printer;
+  QTextCursor cursor(doc);
+  bool editing = false;
+
+  auto block = doc->findBlockByNumber(first);
+  for (; block.isValid() && block.blockNumber() <= last; block = block.next()) {
+    auto *userData = dynamic_cast<TextBlockUserData *>(block.userData());
+    if (userData == nullptr || userData->bytes.isEmpty() || userData->syntax == syntax) {
+      continue;
+    }
+
+    if (!printer) {
+      printer = context.disassemblerPool().acquire(*object_, syntax);
+    }
+    if (!printer->valid()) return;
+
+    // Instructions are decoded at their offsets into the section, so print them the same way from
+    // the bytes of the section.
+    const auto *section = index->section(userData->address);
+    if (section == nullptr) continue;
+    const auto &data = section->data();
+    const auto size = (userData->bytes.size() + 1) / 3; // Hex pairs separated by spaces.
+    if (userData->offset + quint64(size) > quint64(data.size())) continue;
+
+    // NOLINTNEXTLINE
+    const auto *code = reinterpret_cast<const unsigned char *>(data.constData() + userData->offset);
+    const auto instr = printer->print(code, size_t(size), userData->offset);
+    userData->syntax = syntax;
+    if (instr.size != size) continue;
+
+    if (!editing) {
+      cursor.beginEditBlock();
+      editing = true;
+    }
+
+    // The instruction follows the address and the machine code, if shown.
+    const auto bytesWidth = (userData->bytesEnd != -1 ? std::max(24, userData->bytes.size()) : 0);
+    cursor.setPosition(block.position() + userData->addressEnd + bytesWidth);
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText(QString("%1%2").arg(instr.mnemonic, -10).arg(instr.operands));
+  }
+
+  if (editing) {
+    cursor.endEditBlock();
+  }
+}
+
+void BinaryWidget::ensureShown(quint64 address)
+{
+  for (auto &[section, lazy] : lazySections) {
+    if (!lazy.disasm->valid() || !section->hasAddress(address)) continue;
+
+    const auto offset = static_cast<quint32>(address - section->address());
+    if (auto it = lazy.shown.upper_bound(offset);
+        it != lazy.shown.begin() && offset < std::prev(it)->second.end) {
+      std::prev(it)->second.used = ++lazyUses;
+      continue;
+    }
+
+    if (const auto window = lazy.disasm->window(offset)) {
+      showWindow(section, *window);
+      evictWindows(section);
+    }
+  }
+}
+
+QTextBlock BinaryWidget::addressBlock(quint64 address) const
+{
+  if (const auto it = offsetBlock.constFind(address); it != offsetBlock.cend()) {
+    return *it;
+  }
+  if (auto block = hexBlock(address); block.isValid()) {
+    return block;
+  }
+
+  // Otherwise look through the window of a lazily disassembled section that shows it.
+  for (const auto &entry : lazySections) {
+    const auto *section = entry.first;
+    if (!section->hasAddress(address)) continue;
+
+    const auto offset = address - section->address();
+    for (const auto &span : lazySpans(section)) {
+      if (!span.shown || offset < span.begin || offset >= span.end) continue;
+
+      auto block = doc->findBlockByNumber(span.block);
+      for (int i = 0; i < span.blocks && block.isValid(); i++, block = block.next()) {
+        const auto *userData = dynamic_cast<TextBlockUserData *>(block.userData());
+        if (userData != nullptr && userData->address == address) {
+          return block;
+        }
+      }
+    }
+  }
+  return {};
+}
+
+QTextBlock BinaryWidget::hexBlock(quint64 address) const
+{
+  for (const auto &[section, hex] : hexSections) {
+    if (!section->hasAddress(address)) continue;
+
+    const auto offset = address - section->address();
+    const auto line = static_cast<qint64>(offset / HexDump::bytesPerLine);
+    if (offset % HexDump::bytesPerLine != 0 || line >= hex.lines) continue;
+    return doc->findBlockByNumber(hex.first.blockNumber() + static_cast<int>(line));
+  }
+  return {};
+}
+
+void BinaryWidget::ensureBlockData(QTextBlock block) const
+{
+  if (!block.isValid() || block.userData() != nullptr) return;
+
+  const auto number = block.blockNumber();
+  for (const auto &[section, hex] : hexSections) {
+    const auto line = number - hex.first.blockNumber();
+    if (line < 0 || line >= hex.lines) continue;
+
+    auto *userData = new TextBlockUserData;
+    userData->offset = quint64(line) * HexDump::bytesPerLine;
+    userData->address = section->address() + userData->offset;
+    block.setUserData(userData);
     return;
   }
+}
+
+bool BinaryWidget::ensureDisassembled(Section *section)
+{
+  if (section->disassembly() != nullptr) {
+    return true;
+  }
+
+  const auto dis = context.disassemblerPool().acquire(*object_, context.disassemblerSyntax());
+  if (!dis->valid()) {
+    return false;
+  }
+
+  auto boundaries =
+    object_->addressIndex()->starts(section->address(), section->address() + section->size());
+  for (auto &boundary : boundaries) {
+    boundary -= section->address();
+  }
 
-  auto blockNum = offsetBlock[address];
-  selectBlock(blockNum);
+  auto res = dis->disassembleConcurrently(section->data(), std::move(boundaries),
+                                          context.disassemblerPool(), *object_);
+  if (!res) {
+    return false;
+  }
+  section->setDisassembly(std::move(res));
+  return true;
 }
 
-void BinaryWidget::selectBlock(int number)
+void BinaryWidget::selectBlock(const QTextBlock &block)
 {
-  auto block = doc->findBlockByNumber(number);
   auto cursor = mainView->textCursor();
   cursor.setPosition(block.position());
   mainView->setTextCursor(cursor);
@@ -673,6 +1176,9 @@ void BinaryWidget::checkModified(const Section *section,
   if (section->isModified() && section->modifiedRegions() != priorModifications) {
     emit modified();
 
+    // Changed instructions are updated in place when possible.
+    if (updateDisassembly(section)) return;
+
     auto ret = QMessageBox::question(this, "dispar", tr("Binary was modified. Reload UI?"),
                                      QMessageBox::Yes | QMessageBox::No);
     if (QMessageBox::Yes == ret) {
@@ -681,8 +1187,63 @@ void BinaryWidget::checkModified(const Section *section,
   }
 }
 
+bool BinaryWidget::updateDisassembly(const Section *section)
+{
+  auto *disasm = section->disassembly();
+  if (disasm == nullptr || !sectionBlock.contains(section) || lazySections.count(section) > 0) {
+    return false;
+  }
+
+  const auto dis = context.disassemblerPool().acquire(*object_, context.disassemblerSyntax());
+  if (!dis->valid()) {
+    return false;
+  }
+  dis->redisassemble(*disasm);
+
+  // Ranges are in order, so replacing one doesn't move the addresses of the next.
+  for (const auto &[begin, end] : disasm->takeRedecodedRanges()) {
+    replaceInstructions(section, *disasm, begin, end);
+  }
+  return true;
+}
+
+void BinaryWidget::replaceInstructions(const Section *section, const Disassembler::Result &disasm,
+                                       quint64 begin, quint64 end)
+{
+  const auto base = section->address();
+  const auto first = disasm.position(begin), last = disasm.position(end);
+
+  // Instructions before the range are unchanged, so the new ones go after the last of them.
+  const auto prev = (first > 0 ? offsetBlock.value(base + disasm.instruction(first - 1).address)
+                               : sectionBlock.value(section));
+  if (!prev.isValid()) return;
+  const auto prevBlock = prev.blockNumber();
+
+  // Find the blocks of the previous instructions in the range, with procedure names before them.
+  auto lastBlock = prevBlock;
+  QList<quint64> oldAddresses;
+  for (auto block = doc->findBlockByNumber(prevBlock + 1); block.isValid(); block = block.next()) {
+    const auto *userData = dynamic_cast<TextBlockUserData *>(block.userData());
+    if (userData == nullptr) {
+      if (block.text().startsWith("=====")) break;
+      continue;
+    }
+    if (userData->address >= base + end) break;
+    oldAddresses << userData->address;
+    lastBlock = block.blockNumber();
+  }
+
+  // Blocks are removed along with their lines, and those of other lines are unaffected.
+  for (const auto address : oldAddresses) {
+    offsetBlock.remove(address);
+  }
+  replaceBlocks(prevBlock + 1, lastBlock - prevBlock,
+                [&] { appendDisassembly(section, disasm, first, last); });
+}
+
 void BinaryWidget::appendInstruction(quint64 address, quint64 offset, const QString &bytes,
-                                     const QString &instruction, const QString &operands)
+                                     const QString &instruction, const QString &operands,
+                                     Disassembler::Syntax syntax)
 {
   auto *userData = new TextBlockUserData;
   userData->address = address;
@@ -695,6 +1256,7 @@ void BinaryWidget::appendInstruction(quint64 address, quint64 offset, const QStr
   userData->bytes = bytes;
   userData->bytesStart = userData->addressEnd + 1;
   userData->bytesEnd = (smc ? userData->bytesStart + 24 : -1);
+  userData->syntax = syntax;
 
   setupCursor->insertBlock();
   setupCursor->insertText(QString("%1%2%3%4")
@@ -705,9 +1267,36 @@ void BinaryWidget::appendInstruction(quint64 address, quint64 offset, const QStr
 
   auto block = setupCursor->block();
   block.setUserData(userData);
+}
+
+void BinaryWidget::appendDisassembly(const Section *section, const Disassembler::Result &disasm,
+                                     size_t first, size_t last)
+{
+  // Blocks of lazily disassembled sections come and go, so they are found otherwise.
+  const bool lazy = lazySections.count(section) > 0;
 
-  offsetBlock[userData->address] = block.blockNumber();
-  codeBlocks << block.blockNumber();
+  for (auto i = first, n = std::min(last, disasm.count()); i < n; i++) {
+    const auto instr = disasm.instruction(i);
+    const auto offset = instr.address;
+    const auto addr = offset + section->address();
+
+    // Check if address is the start of a procedure.
+    const auto it = procNameMap.find(addr);
+    if (it != procNameMap.end()) {
+      setupCursor->insertBlock();
+      setupCursor->insertText("\nPROC: " + *it + "\n");
+    }
+
+    if (firstAddress == 0) {
+      firstAddress = addr;
+    }
+
+    appendInstruction(addr, offset, Util::bytesToHex(instr.bytes, instr.size), instr.mnemonic,
+                      instr.operands, disasm.syntax());
+    if (!lazy) {
+      offsetBlock[addr] = setupCursor->block();
+    }
+  }
 }
 
 void BinaryWidget::appendString(quint64 address, quint64 offset, const QString &string)
@@ -725,7 +1314,12 @@ void BinaryWidget::appendString(quint64 address, quint64 offset, const QString &
   auto block = setupCursor->block();
   block.setUserData(userData);
 
-  offsetBlock[userData->address] = block.blockNumber();
+  offsetBlock[userData->address] = block;
+}
+
+QString BinaryWidget::demangle(const QString &name) const
+{
+  return object_->demangledName(name);
 }
 
 qint64 BinaryWidget::presetup()
@@ -737,11 +1331,21 @@ qint64 BinaryWidget::presetup()
   symbols = object_->symbolTable().symbols();
   Util::copyTo(object_->dynSymbolTable().symbols(), symbols);
 
+  // Demangle all symbols at once, except those known from before, like from the analysis cache.
+  object_->demangleSymbols();
+
   // Create temporary procedure name lookup map.
   procNameMap.clear();
   for (const auto &symbol : symbols) {
     if (!symbol.string().isEmpty()) {
-      procNameMap[symbol.value()] = Util::demangle(symbol.string());
+      procNameMap[symbol.value()] = demangle(symbol.string());
+    }
+  }
+
+  // Name the functions without symbols, like stripped binaries, after their addresses.
+  for (const auto start : object_->functionStarts()) {
+    if (!procNameMap.contains(start)) {
+      procNameMap[start] = QString("sub_%1").arg(start, 0, 16);
     }
   }
 
@@ -763,8 +1367,22 @@ qint64 BinaryWidget::setupDisassembledSections()
 
   firstAddress = 0;
   for (auto *section : object_->sections()) {
-    const auto *disasm = section->disassembly();
-    if (disasm == nullptr) continue;
+    auto *disasm = section->disassembly();
+
+    // Decode instructions patched since disassembled, which are all shown anew.
+    if (disasm != nullptr && disasm->isPatched()) {
+      context.disassemblerPool()
+        .acquire(*object_, context.disassemblerSyntax())
+        ->redisassemble(*disasm);
+    }
+    if (disasm != nullptr) {
+      disasm->takeRedecodedRanges();
+    }
+
+    // Large code sections are left for disassembling while scrolling.
+    const bool lazy =
+      disasm == nullptr && context.lazyDisassembly() && LazyDisassembly::suits(*section);
+    if (disasm == nullptr && !lazy) continue;
 
     setupCursor->movePosition(QTextCursor::End);
 
@@ -774,7 +1392,7 @@ qint64 BinaryWidget::setupDisassembledSections()
     }
 
     // Save section to block number.
-    sectionBlock[section] = setupCursor->blockNumber();
+    sectionBlock[section] = setupCursor->block();
 
     const auto secName = section->toString();
     qDebug() << "" << secName << "section..";
@@ -783,31 +1401,22 @@ qint64 BinaryWidget::setupDisassembledSections()
     QElapsedTimer sectionTimer;
     sectionTimer.start();
 
-    for (std::size_t i = 0; i < disasm->count(); i++) {
-      const auto *instr = disasm->instructions(i);
-      const auto offset = instr->address;
-      const auto addr = offset + section->address();
-
-      // Check if address is the start of a procedure.
-      const auto it = procNameMap.find(addr);
-      if (it != procNameMap.end()) {
-        setupCursor->insertBlock();
-        setupCursor->insertText("\nPROC: " + *it + "\n");
-      }
-
+    // Lazily disassembled sections show placeholders until scrolled or jumped to.
+    if (lazy) {
+      setupLazySection(section);
       if (firstAddress == 0) {
-        firstAddress = addr;
+        firstAddress = section->address();
       }
-
-      appendInstruction(addr, offset, Util::bytesToHex(instr->bytes, instr->size), instr->mnemonic,
-                        instr->op_str);
     }
-
-    qDebug() << " >" << sectionTimer.restart() << "ms";
+    else {
+      appendDisassembly(section, *disasm);
+    }
 
     setupCursor->movePosition(QTextCursor::End);
     setupCursor->insertBlock();
     setupCursor->insertText("\n===== /" + secName + " =====\n");
+
+    qDebug() << " >" << sectionTimer.restart() << "ms";
   }
 
   const auto disSectionsTime = setupElapsedTimer.restart();
@@ -829,7 +1438,7 @@ qint64 BinaryWidget::setupStringSections()
     setupCursor->insertBlock();
 
     // Save section to block number.
-    sectionBlock[section] = setupCursor->blockNumber();
+    sectionBlock[section] = setupCursor->block();
 
     const auto secName = section->toString();
     qDebug() << "" << secName << "section..";
@@ -838,12 +1447,11 @@ qint64 BinaryWidget::setupStringSections()
     QElapsedTimer sectionTimer;
     sectionTimer.start();
 
-    CStringReader reader(section->data());
-    while (reader.next()) {
-      const auto offset = reader.offset();
-      const auto addr = offset + section->address();
-      const auto string = reader.string();
-      appendString(addr, offset, string);
+    const auto &data = section->data();
+    for (const auto &entry : CStringReader::scan(data)) {
+      const auto addr = entry.offset + section->address();
+      const auto string = CStringReader::string(data, entry);
+      appendString(addr, entry.offset, string);
       addSymbolToList(string, addr, stringList_);
     }
 
@@ -854,12 +1462,135 @@ qint64 BinaryWidget::setupStringSections()
     setupCursor->insertText("\n===== /" + secName + " =====\n");
   }
 
+  // Strings found in other sections, like __const and __data, are only added to the list.
+  extractStrings();
+
   const auto stringSectionsTime = setupElapsedTimer.restart();
   qDebug() << ">" << stringSectionsTime << "ms";
 
   return stringSectionsTime;
 }
 
+void BinaryWidget::extractStrings()
+{
+  // Data is taken on the GUI thread, where sections are modified. The copies are views of the
+  // mapped file, or share the data, so nothing is read yet.
+  std::vector<std::pair<QByteArray, quint64>> sources; ///< Data and address of its first byte.
+
+  /// Section at file offsets [offset, offset + size) when scanning the whole file.
+  struct Range {
+    quint64 offset = 0, size = 0, address = 0;
+    bool shown = false; ///< Strings of string sections are shown already.
+  };
+  std::vector<Range> ranges;
+
+  const auto begin = static_cast<qint64>(fileOffset), size = static_cast<qint64>(fileSize);
+  const bool scanFile = context.stringsScanFile() && file && file->contains(begin, size);
+  if (scanFile) {
+    sources.emplace_back(file->view(begin, size), 0);
+    for (const auto *section : object_->sections()) {
+      // Zero-filled sections aren't in the file.
+      if (!section->isMapped() || section->size() == 0) continue;
+      const auto type = section->type();
+      ranges.push_back({section->offset(), section->size(), section->address(),
+                        type == Section::Type::CSTRING || type == Section::Type::STRING});
+    }
+    std::sort(ranges.begin(), ranges.end(),
+              [](const auto &a, const auto &b) { return a.offset < b.offset; });
+  }
+  else {
+    for (const auto *section : object_->sectionsByType(Section::Type::OTHER)) {
+      sources.emplace_back(section->data(), section->address());
+    }
+  }
+
+  const StringExtractor extractor(context.stringsMinLength(), context.stringsEncodings());
+  const auto generation = stringsGeneration;
+  const auto offset = fileOffset;
+  stringsPool.start([this, generation, extractor, scanFile, offset, file = file,
+                     sources = std::move(sources), ranges = std::move(ranges)] {
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    ExtractedStrings batch;
+    int count = 0;
+    const auto post = [this, generation, &batch](bool done) {
+      QMetaObject::invokeMethod(
+        this,
+        [this, generation, strings = std::move(batch), done] {
+          addExtractedStrings(generation, strings, done);
+        },
+        Qt::QueuedConnection);
+      batch.clear();
+    };
+
+    // Sections don't overlap, since segments only cover what no section does, so the one
+    // containing the string is the last one starting at or before it.
+    const auto address = [&ranges, offset](quint64 pos) -> std::optional<quint64> {
+      auto it = std::upper_bound(ranges.cbegin(), ranges.cend(), pos,
+                                 [](quint64 pos, const auto &range) { return pos < range.offset; });
+      if (it == ranges.cbegin()) return {};
+      --it;
+      if (pos - it->offset >= it->size || it->shown) return {};
+      return it->address + (pos - it->offset);
+    };
+
+    for (const auto &source : sources) {
+      const auto &data = source.first;
+      const auto entries = extractor.extract(data, &stringsCanceled);
+      for (const auto &entry : entries) {
+        if (stringsCanceled) return;
+
+        const auto addr =
+          scanFile ? address(offset + entry.offset) : std::optional(source.second + entry.offset);
+        if (!addr) continue;
+
+        batch.emplace_back(StringExtractor::string(data, entry), *addr);
+        if (++count == Constants::Strings::MAX_EXTRACTED) {
+          qDebug() << "Extracted strings limited to" << count;
+          post(true);
+          return;
+        }
+        if (batch.size() == std::size_t(Constants::Strings::EXTRACTED_BATCH)) {
+          post(false);
+        }
+      }
+    }
+
+    qDebug() << "Extracted" << count << "strings in" << elapsedTimer.elapsed() << "ms";
+    post(true);
+  });
+}
+
+void BinaryWidget::cancelStringExtraction()
+{
+  stringsCanceled = true;
+  stringsPool.waitForDone();
+  stringsCanceled = false;
+
+  // Batches that are still queued are dropped.
+  stringsGeneration++;
+}
+
+void BinaryWidget::addExtractedStrings(quint64 generation, const ExtractedStrings &strings,
+                                       bool done)
+{
+  if (generation != stringsGeneration) return;
+
+  // Keep the current filter of the list.
+  const auto filter = listFilters.value(stringList_);
+  for (const auto &[text, address] : strings) {
+    auto *item = addSymbolToList(text, address, stringList_);
+    if (!filter.isEmpty() && !text.contains(filter, Qt::CaseInsensitive)) {
+      item->setHidden(true);
+    }
+  }
+
+  if (done) {
+    stringList_->setSortingEnabled(true);
+  }
+}
+
 qint64 BinaryWidget::setupLoadCommandSections()
 {
   setupDiag->setValue(3);
@@ -875,7 +1606,7 @@ qint64 BinaryWidget::setupLoadCommandSections()
     setupCursor->insertBlock();
 
     // Save section to block number.
-    sectionBlock[section] = setupCursor->blockNumber();
+    sectionBlock[section] = setupCursor->block();
 
     const auto secName = section->toString();
     qDebug() << "" << secName << "section..";
@@ -926,7 +1657,8 @@ qint64 BinaryWidget::setupMiscSections()
 
   // Show miscellaneous sections. The section not shown in specific ways will be address-hex-ASCII
   // encoded just to give some representation. SYMBOL_STUBS aren't shown on purpose because the
-  // function symbols should map inside the program text instead!
+  // function symbols should map inside the program text instead! Neither are OTHER and SEGMENT,
+  // which are only read when hex edited.
   for (auto *section :
        object_->sectionsByTypes({Section::Type::FUNC_STARTS, Section::Type::SYMBOLS,
                                  Section::Type::DYN_SYMBOLS, Section::Type::CODE_SIG})) {
@@ -934,7 +1666,7 @@ qint64 BinaryWidget::setupMiscSections()
     setupCursor->insertBlock();
 
     // Save section to block number.
-    sectionBlock[section] = setupCursor->blockNumber();
+    sectionBlock[section] = setupCursor->block();
 
     const auto secName = section->toString();
     qDebug() << "" << secName << "section..";
@@ -946,25 +1678,24 @@ qint64 BinaryWidget::setupMiscSections()
     AddrHexAsciiEncoder encoder(section);
     const bool blocking(true);
     encoder.start(blocking);
-    const auto lines = encoder.result().split("\n");
+    const auto &dump = encoder.dump();
 
-    for (const auto &line : lines) {
-      const auto pos = line.indexOf(':');
-      if (pos == -1) continue;
-
-      const auto addr = line.mid(0, pos).toULongLong(nullptr, 16);
-
-      setupCursor->insertBlock();
-      setupCursor->insertText(line);
+    // All lines are inserted as one text, so each only costs its block.
+    setupCursor->insertBlock();
+    if (dump.isTooLarge()) {
+      setupCursor->insertText(
+        tr("Too large to show here, use \"Hex edit '%1'\" instead.").arg(secName));
 
       auto *userData = new TextBlockUserData;
-      userData->address = addr;
-      userData->offset = addr - section->address();
+      userData->address = section->address();
 
       auto block = setupCursor->block();
       block.setUserData(userData);
-
-      offsetBlock[userData->address] = block.blockNumber();
+      offsetBlock[userData->address] = block;
+    }
+    else {
+      hexSections[section] = {setupCursor->block(), static_cast<qint64>(dump.lines().size())};
+      setupCursor->insertText(dump.text());
     }
 
     qDebug() << " >" << sectionTimer.restart() << "ms";
@@ -996,11 +1727,11 @@ qint64 BinaryWidget::setupSidebar()
 
     seenSymbols << symbol.value();
 
-    auto func = Util::demangle(symbol.string());
+    auto func = demangle(symbol.string());
     if (func.isEmpty()) {
       func = QString("unnamed_%1").arg(symbol.value(), 0, 16);
     }
-    if (offsetBlock.contains(symbol.value())) {
+    if (hasAddress(symbol.value())) {
       func += " *";
     }
 
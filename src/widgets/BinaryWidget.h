@@ -4,17 +4,29 @@
 #include <QElapsedTimer>
 #include <QHash>
 #include <QPointer>
+#include <QTextBlock>
+#include <QThreadPool>
 #include <QWidget>
 
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "BinaryObject.h"
+#include "Disassembler.h"
 #include "SymbolTable.h"
 
 class QLabel;
 class QTabWidget;
 class QTextCursor;
 class QListWidget;
+class QListWidgetItem;
 class QPlainTextEdit;
 class QTextDocument;
 class QProgressDialog;
@@ -24,6 +36,8 @@ namespace dispar {
 class Context;
 class TagsEdit;
 class HexEditor;
+class MappedFile;
+class LazyDisassembly;
 class DisassemblyEditor;
 class MacSdkVersionsEditor;
 
@@ -43,6 +57,21 @@ public:
 
   void reloadUi();
 
+  /// Address of the line at the cursor, or 0 if none.
+  [[nodiscard]] quint64 currentAddress() const;
+
+  /// Select \p address instead of the first one when setup is done, if it exists.
+  void setStartAddress(quint64 address);
+
+  /// Region of \p file that the object was parsed from.
+  /** Strings are extracted from all of it instead of from section data if
+      Context::stringsScanFile(). */
+  void setMappedFile(std::shared_ptr<const MappedFile> file, quint64 offset, quint64 size);
+
+  /// Stops extracting strings in the background and no longer reads the mapped file.
+  /** Needed before the file changes, since section data might not be views of it anymore. */
+  void stopStringExtraction();
+
 signals:
   void modified();
   void loaded();
@@ -55,6 +84,7 @@ private slots:
   void onSymbolChosen(int row);
   void onCursorPositionChanged();
   void onShowMachineCodeChanged(bool show);
+  void onDisassemblerSyntaxChanged(Disassembler::Syntax syntax);
   void onCustomContextMenuRequested(const QPoint &pos);
 
   void filterSymbols(const QString &filter);
@@ -63,18 +93,42 @@ private:
   void createLayout();
   void setup();
   void updateTagList();
-  void addSymbolToList(const QString &text, quint64 address, QListWidget *list);
+  QListWidgetItem *addSymbolToList(const QString &text, quint64 address, QListWidget *list);
   void selectAddress(quint64 address);
-  void selectBlock(int number);
+
+  /// Address of the line containing \p address, like the instruction it is inside of.
+  [[nodiscard]] std::optional<quint64> lineAddress(quint64 address);
+
+  /// Whether \p address is shown, or will be when scrolled to.
+  [[nodiscard]] bool hasAddress(quint64 address) const;
+
+  void selectBlock(const QTextBlock &block);
   void selectSection(const Section *section);
   void selectPosition(int pos);
   void removeSelectedTags();
 
+  /// Opens the hex editor of \p section, which only reads its data then.
+  void hexEdit(Section *section);
+
   /// Check if section has different modifications than \p priorModifications and emit modified.
   /** It will also add to re-run setup() if modified. */
   void checkModified(const Section *section,
                      const QList<Section::ModifiedRegion> &priorModifications);
 
+  /// Decodes the patched instructions of \p section again and replaces those shown.
+  /** Returns false if the section isn't shown from its disassembly, which then needs setup(). */
+  bool updateDisassembly(const Section *section);
+
+  /// Replaces the instructions shown for section offsets [\p begin, \p end) with \p disasm.
+  void replaceInstructions(const Section *section, const Disassembler::Result &disasm,
+                           quint64 begin, quint64 end);
+
+  /// Replaces \p count blocks from \p first, which must follow another block, with those appended
+  /// by \p append.
+  /** What is shown stays in place if the blocks are above it. Returns the number of blocks
+      appended. */
+  int replaceBlocks(int first, int count, const std::function<void()> &append);
+
   BinaryObject *object_;
 
   Context &context;
@@ -86,9 +140,23 @@ private:
   QHash<QListWidget *, QString> listFilters;
   QPlainTextEdit *mainView = nullptr;
   QTextDocument *doc = nullptr;
-  QHash<quint64, int> offsetBlock;          ///< Offset -> block
-  QHash<const Section *, int> sectionBlock; ///< Section -> block
-  QList<int> codeBlocks;
+  QHash<quint64, QTextBlock> offsetBlock;          ///< Offset -> block
+  QHash<const Section *, QTextBlock> sectionBlock; ///< Section -> block
+
+  /// Hex dumped section, whose lines are inserted as one text after the block of its first line.
+  /** Large sections have millions of lines, so they aren't in offsetBlock and are only given block
+      user data when needed. Their addresses follow from the block numbers instead. */
+  struct HexSection {
+    QTextBlock first;
+    qint64 lines = 0;
+  };
+  std::map<const Section *, HexSection> hexSections;
+
+  /// Block of the line of \p address in a hex dumped section, which is invalid if none.
+  [[nodiscard]] QTextBlock hexBlock(quint64 address) const;
+
+  /// Gives \p block user data if it's a line of a hex dumped section without it yet.
+  void ensureBlockData(QTextBlock block) const;
   QLabel *addressLabel = nullptr, *offsetLabel = nullptr, *machineCodeLabel = nullptr,
          *binaryLabel = nullptr, *sizeLabel = nullptr, *archLabel = nullptr,
          *fileTypeLabel = nullptr;
@@ -97,17 +165,82 @@ private:
   QHash<Section *, MacSdkVersionsEditor *> macSdkVersionsEditors;
   QHash<Section *, HexEditor *> hexEditors;
 
+  /// Code section that is disassembled while scrolling.
+  /** The blocks after its header are those of the windows shown, in order, where each gap between
+      them is a single placeholder block. Windows are shown when scrolled or jumped to, and the least
+      recently used ones are turned back into placeholders once more than
+      Constants::Disassembly::CACHED_WINDOWS are shown. Blocks of windows aren't in offsetBlock
+      since they come and go. */
+  struct LazySection {
+    struct Window {
+      quint32 end = 0;
+      int blocks = 0;
+      quint64 used = 0; ///< When last shown or visible.
+    };
+
+    std::unique_ptr<LazyDisassembly> disasm;
+    std::map<quint32, Window> shown; ///< Start offset -> window.
+    std::set<quint32> failed;        ///< Start offsets of gaps where nothing could be decoded.
+  };
+  std::map<const Section *, LazySection> lazySections;
+  quint64 lazyUses = 0;
+
+  /// Window shown, or gap, of a lazily disassembled section at section offsets [begin, end).
+  struct LazySpan {
+    quint32 begin = 0, end = 0;
+    int block = 0, blocks = 1;
+    bool shown = false;
+  };
+
+  /// Spans of lazily disassembled \p section in order.
+  [[nodiscard]] std::vector<LazySpan> lazySpans(const Section *section) const;
+
+  void setupLazySection(const Section *section);
+  void appendPlaceholder(const Section *section, quint32 begin, quint32 end);
+
+  /// Shows \p window of lazily disassembled \p section in place of the placeholder of its gap.
+  void showWindow(const Section *section, const Disassembler::Result &window);
+
+  /// Turns the least recently used windows of \p section that aren't visible back into
+  /// placeholders until few enough are shown.
+  void evictWindows(const Section *section);
+
+  /// Shows windows of lazily disassembled sections where gaps are close to being visible.
+  void loadVisibleLazySections();
+
+  /// First and last blocks shown in the view.
+  [[nodiscard]] std::pair<int, int> visibleBlocks() const;
+
+  /// Prints shown instructions again that are in another syntax than the current one.
+  /** Instructions are printed from their bytes, so switching syntax only costs what is visible. */
+  void renderVisibleInstructions();
+
+  /// Shows the window of a lazily disassembled section that includes \p address, if not already.
+  /** Only that window is decoded, directly from the closest known instruction boundary. */
+  void ensureShown(quint64 address);
+
+  /// Block of the line of \p address, which is invalid if not shown.
+  [[nodiscard]] QTextBlock addressBlock(quint64 address) const;
+
+  /// Disassembles all of \p section if it was disassembled lazily.
+  bool ensureDisassembled(Section *section);
+
   /// Setup related.
   //@{
   QPointer<QProgressDialog> setupDiag;
   QElapsedTimer setupElapsedTimer;
   std::unique_ptr<QTextCursor> setupCursor;
   QHash<quint64, QString> procNameMap;
-  quint64 firstAddress = 0;
+  quint64 firstAddress = 0, startAddress = 0;
   SymbolTable::EntryList symbols;
   void appendInstruction(quint64 address, quint64 offset, const QString &bytes,
-                         const QString &instruction, const QString &operands);
+                         const QString &instruction, const QString &operands,
+                         Disassembler::Syntax syntax);
   void appendString(quint64 address, quint64 offset, const QString &string);
+  /// Appends instructions at positions [\p first, \p last) of \p disasm.
+  void appendDisassembly(const Section *section, const Disassembler::Result &disasm,
+                         size_t first = 0, size_t last = std::numeric_limits<size_t>::max());
+  [[nodiscard]] QString demangle(const QString &name) const;
   qint64 presetup();
   qint64 setupDisassembledSections();
   qint64 setupStringSections();
@@ -115,6 +248,22 @@ private:
   qint64 setupMiscSections();
   qint64 setupSidebar();
   //@}
+
+  /// Strings extracted outside of string sections.
+  /** They are extracted in the background after setup and added to the strings list in batches,
+      up to Constants::Strings::MAX_EXTRACTED of them. Each setup starts a new generation, and
+      batches of earlier ones are dropped. */
+  //@{
+  using ExtractedStrings = std::vector<std::pair<QString, quint64>>; ///< String and address.
+  QThreadPool stringsPool;
+  std::atomic_bool stringsCanceled{false};
+  quint64 stringsGeneration = 0;
+  std::shared_ptr<const MappedFile> file;
+  quint64 fileOffset = 0, fileSize = 0;
+  void extractStrings();
+  void cancelStringExtraction();
+  void addExtractedStrings(quint64 generation, const ExtractedStrings &strings, bool done);
+  //@}
 };
 
 } // namespace dispar
@@ -11,7 +11,9 @@
 
 #include "BinaryObject.h"
 #include "Constants.h"
+#include "Context.h"
 #include "Disassembler.h"
+#include "DisassemblerPool.h"
 #include "Util.h"
 #include "cxx.h"
 #include "widgets/DisassemblerDialog.h"
@@ -46,9 +48,9 @@ void DisassemblerDialog::onConvert()
   const auto textOffset = offsetEdit->text().toULongLong(nullptr, 16);
 
   auto obj = std::make_unique<BinaryObject>(cpuType);
-  Disassembler dis(*obj, syntax);
+  const auto dis = Context::get().disassemblerPool().acquire(*obj, syntax);
 
-  auto result = dis.disassemble(text, textOffset);
+  auto result = dis->disassemble(text, textOffset);
   if (result) {
     asmText->setText(result->toString());
     setAsmVisible();
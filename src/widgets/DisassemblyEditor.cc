@@ -1,6 +1,7 @@
 #include "widgets/DisassemblyEditor.h"
 #include "BinaryObject.h"
 #include "Context.h"
+#include "DisassemblerPool.h"
 #include "Section.h"
 #include "Util.h"
 #include "widgets/TreeWidget.h"
@@ -85,20 +86,20 @@ public:
     disasmEditor->updateModified();
 
     // Update disassembly.
-    Disassembler dis(*object, Context::get().disassemblerSyntax());
-    const auto result = dis.disassemble(data, addr);
-    if (!result) {
+    auto &ctx = Context::get();
+    const auto dis = ctx.disassemblerPool().acquire(*object, ctx.disassemblerSyntax());
+    QStringList lines;
+    const auto count = dis->disassemble(data, addr, [&lines](const auto &instr) {
+      lines << QString("%1 %2").arg(instr.mnemonic).arg(instr.operands);
+      return true;
+    });
+    if (count == 0) {
       item->setText(2, tr("Could not disassemble!"));
     }
     else {
-      QStringList lines;
-      for (std::size_t i = 0; i < result->count(); i++) {
-        const auto *instr = result->instructions(i);
-        lines << QString("%1 %2").arg(instr->mnemonic).arg(instr->op_str);
-      }
       item->setText(2, lines.join("   "));
 
-      if (result->count() > 1) {
+      if (count > 1) {
         disasmEditor->showUpdateButton();
         QMessageBox::information(nullptr, "",
                                  tr("Changes implied new instructions.") + "\n" +
@@ -185,8 +186,18 @@ void DisassemblyEditor::updateDisassembly()
 
   qDebug() << "Re-dissassembling..";
 
-  Disassembler dis(*object, Context::get().disassemblerSyntax());
-  auto result = dis.disassemble(section->data());
+  auto &ctx = Context::get();
+  const auto dis = ctx.disassemblerPool().acquire(*object, ctx.disassemblerSyntax());
+
+  // Only decode the instructions affected by edits.
+  auto *disasm = section->disassembly();
+  if (disasm && disasm->count() > 0) {
+    dis->redisassemble(*disasm);
+    qDebug() << ">" << elapsedTimer.restart() << "ms";
+    return;
+  }
+
+  auto result = dis->disassemble(section->data());
   if (!result) {
     QMessageBox::critical(this, "", tr("Could not disassemble machine code!"));
     return;
@@ -258,13 +269,17 @@ void DisassemblyEditor::createEntries()
   QHash<quint64, QString> procNameMap;
   for (const auto &symbol : symbols) {
     if (!symbol.string().isEmpty()) {
-      procNameMap[symbol.value()] = Util::demangle(symbol.string());
+      procNameMap[symbol.value()] = object->demangledName(symbol.string());
     }
   }
 
+  // Instructions are shown in the current syntax even if decoded in another.
+  auto &ctx = Context::get();
+  const auto dis = ctx.disassemblerPool().acquire(*object, ctx.disassemblerSyntax());
+
   for (std::size_t i = 0; i < disasm->count(); i++) {
-    const auto *instr = disasm->instructions(i);
-    const auto offset = instr->address;
+    const auto instr = dis->valid() ? dis->instruction(*disasm, i) : disasm->instruction(i);
+    const auto offset = instr.address;
     const auto addr = offset + section->address();
 
     // Check if address is the start of a procedure.
@@ -291,8 +306,8 @@ void DisassemblyEditor::createEntries()
     item->setFlags(Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
     item->setText(0,
                   Util::padString(QString::number(addr, 16).toUpper(), object->systemBits() / 8));
-    item->setText(1, Util::bytesToHex(instr->bytes, instr->size));
-    item->setText(2, QString("%1 %2").arg(instr->mnemonic).arg(instr->op_str));
+    item->setText(1, Util::bytesToHex(instr.bytes, instr.size));
+    item->setText(2, QString("%1 %2").arg(instr.mnemonic).arg(instr.operands));
     treeWidget->addTopLevelItem(item);
   }
 
@@ -1,7 +1,8 @@
 #include "widgets/HexEdit.h"
-#include "AddrHexAsciiEncoder.h"
 #include "BinaryObject.h"
 #include "Constants.h"
+#include "HexDump.h"
+#include "MappedFile.h"
 #include "Section.h"
 #include "Util.h"
 #include "widgets/ConversionHelper.h"
@@ -9,52 +10,80 @@
 
 #include <QApplication>
 #include <QClipboard>
-#include <QContextMenuEvent>
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QFormLayout>
 #include <QInputDialog>
+#include <QKeyEvent>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMenu>
 #include <QMessageBox>
-#include <QTextBlock>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
 
+#include <algorithm>
 #include <cassert>
 
 namespace dispar {
 
-QString HexEdit::Block::addrStr() const
+namespace {
+
+/// Space around the rows.
+constexpr int margin = 4;
+
+} // namespace
+
+QString HexEdit::Row::addrStr() const
 {
   return QString::number(addr, 16).toUpper();
 }
 
-QString HexEdit::Block::addrEndStr() const
+QString HexEdit::Row::addrEndStr() const
+{
+  // Return the last address of the row.
+  return QString::number(addr + bytes.size() - 1, 16).toUpper();
+}
+
+QString HexEdit::Row::hexLow() const
 {
-  // Return the last address of the block.
-  return QString::number(addr + hex().size() / 2 - 1, 16).toUpper();
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *data = reinterpret_cast<const unsigned char *>(bytes.constData());
+  return Util::bytesToHex(data, std::min(bytes.size(), 8), 0, true);
+}
+
+QString HexEdit::Row::hexHigh() const
+{
+  if (!hasHexHigh()) return {};
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *data = reinterpret_cast<const unsigned char *>(bytes.constData());
+  return Util::bytesToHex(data + 8, bytes.size() - 8, 0, true); // NOLINT
 }
 
-QString HexEdit::Block::hex() const
+QString HexEdit::Row::hex() const
 {
-  return hexLow + hexHigh;
+  return hexLow() + hexHigh();
 }
 
-bool HexEdit::Block::hasHexHigh() const
+QString HexEdit::Row::ascii() const
 {
-  return hex().size() / 2 > 8;
+  return Util::dataToAscii(bytes, 0, bytes.size());
 }
 
-HexEdit::HexEdit(QWidget *parent) : QPlainTextEdit(parent)
+bool HexEdit::Row::hasHexHigh() const
 {
-  setReadOnly(true);
-  setCenterOnScroll(true);
-  setLineWrapMode(QPlainTextEdit::NoWrap);
+  return bytes.size() > 8;
+}
+
+HexEdit::HexEdit(QWidget *parent) : QAbstractScrollArea(parent)
+{
+  setFocusPolicy(Qt::StrongFocus);
   setContextMenuPolicy(Qt::CustomContextMenu);
   setFont(Constants::FIXED_FONT);
 
-  connect(this, &QPlainTextEdit::cursorPositionChanged, this, &HexEdit::cursorPositionChanged);
-  connect(this, &QPlainTextEdit::customContextMenuRequested, this,
+  connect(this, &QWidget::customContextMenuRequested, this,
           &HexEdit::customContextMenuRequested);
 }
 
@@ -65,39 +94,126 @@ void HexEdit::decode(Section *section_, BinaryObject *object_)
   object = object_;
   assert(object_);
 
-  AddrHexAsciiEncoder encoder(section);
-  const bool blocking(true);
-  encoder.start(blocking);
-  setPlainText(encoder.result());
-  markModifiedRegions();
+  file.reset();
+  fileData.clear();
+  reset();
 }
 
-void HexEdit::mouseDoubleClickEvent(QMouseEvent *event)
+void HexEdit::decode(std::shared_ptr<const MappedFile> file_)
+{
+  file = std::move(file_);
+  assert(file);
+  fileData = file->view(0, file->size());
+
+  section = nullptr;
+  object = nullptr;
+  reset();
+}
+
+void HexEdit::paintEvent(QPaintEvent * /*event*/)
+{
+  // Only show what the file still has if truncated since, which faults when read beyond its end.
+  if (file && file->currentSize() < fileData.size()) {
+    fileData = file->view(0, file->currentSize());
+    updateScrollBars();
+    curRow = std::min(curRow, rowCount() - 1);
+  }
+
+  QPainter painter(viewport());
+  painter.setFont(font());
+
+  const auto &bytes = data();
+  const auto *raw = bytes.constData();
+  const int rows = rowCount(), first = verticalScrollBar()->value(), height = lineHeight();
+  const int x = margin - horizontalScrollBar()->value();
+  const int ascent = fontMetrics().ascent();
+
+  const auto highlight = palette().highlight().color().lighter(120);
+  QString line;
+
+  for (int index = first, y = margin; index < rows && y < viewport()->height();
+       index++, y += height) {
+    if (index == curRow) {
+      painter.fillRect(0, y, viewport()->width(), height, highlight);
+    }
+
+    const auto offset = index * HexDump::bytesPerLine;
+    const auto size = std::min(HexDump::bytesPerLine, bytes.size() - offset);
+    const auto addr = address() + offset;
+    line.resize(HexDump::lineLength(addr, size));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    HexDump::writeLine(line.data(), addr, reinterpret_cast<const uchar *>(raw) + offset, size);
+
+    painter.setPen(isModified(index) ? QColor(Qt::red) : palette().text().color());
+    painter.drawText(x, y + ascent, line);
+  }
+}
+
+void HexEdit::resizeEvent(QResizeEvent *event)
 {
-  QPlainTextEdit::mouseDoubleClickEvent(event);
-  editAtCursor();
+  QAbstractScrollArea::resizeEvent(event);
+  updateScrollBars();
 }
 
-void HexEdit::cursorPositionChanged()
+void HexEdit::scrollContentsBy(int /*dx*/, int /*dy*/)
 {
-  // Mark the whole line to highlight it.
-  auto highlight = palette().highlight();
-  highlight.setColor(highlight.color().lighter(120));
+  viewport()->update();
+}
 
-  QTextEdit::ExtraSelection selection;
-  selection.format.setBackground(highlight);
-  selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-  selection.cursor = textCursor();
+void HexEdit::keyPressEvent(QKeyEvent *event)
+{
+  switch (event->key()) {
+  case Qt::Key_Up:
+    setCurrentRow(curRow - 1);
+    break;
+  case Qt::Key_Down:
+    setCurrentRow(curRow + 1);
+    break;
+  case Qt::Key_PageUp:
+    setCurrentRow(curRow - visibleRows());
+    break;
+  case Qt::Key_PageDown:
+    setCurrentRow(curRow + visibleRows());
+    break;
+  case Qt::Key_Home:
+    setCurrentRow(0);
+    break;
+  case Qt::Key_End:
+    setCurrentRow(rowCount() - 1);
+    break;
+  case Qt::Key_Return:
+  case Qt::Key_Enter:
+    editAtCursor();
+    break;
+  default:
+    QAbstractScrollArea::keyPressEvent(event);
+  }
+}
 
-  curLineSelection = {selection};
+void HexEdit::mousePressEvent(QMouseEvent *event)
+{
+  if (const auto index = rowAt(event->pos()); index != -1) {
+    setCurrentRow(index);
+  }
+  QAbstractScrollArea::mousePressEvent(event);
+}
 
-  setExtraSelections(modSelections + curLineSelection);
+void HexEdit::mouseDoubleClickEvent(QMouseEvent *event)
+{
+  if (const auto index = rowAt(event->pos()); index != -1) {
+    setCurrentRow(index);
+    editAtCursor();
+  }
 }
 
 void HexEdit::customContextMenuRequested(const QPoint &pos)
 {
+  if (const auto index = rowAt(pos); index != -1) {
+    setCurrentRow(index);
+  }
+
   QMenu menu;
-  menu.addAction(tr("Edit"), this, &HexEdit::editAtCursor);
+  menu.addAction(tr("Edit"), this, &HexEdit::editAtCursor)->setEnabled(section != nullptr);
   menu.addAction(tr("Find address"), this, &HexEdit::findAddress);
   menu.addSeparator();
 
@@ -109,29 +225,29 @@ void HexEdit::customContextMenuRequested(const QPoint &pos)
   copyMenu->addAction(tr("ASCII"), this, [this] { copyContent(Copy::ASCII); });
 
   menu.addSeparator();
-  menu.addAction(tr("Disassemble"), this, &HexEdit::disassemble);
+  menu.addAction(tr("Disassemble"), this, &HexEdit::disassemble)->setEnabled(object != nullptr);
 
   menu.addSeparator();
   menu.addAction(tr("Conversion helper"), this, &HexEdit::showConversionHelper);
 
-  menu.exec(mapToGlobal(pos));
+  menu.exec(viewport()->mapToGlobal(pos));
 }
 
 void HexEdit::copyContent(const Copy type)
 {
-  const auto block = currentBlock();
+  const auto block = currentRow();
   const auto text = [block, type]() -> QString {
     switch (type) {
     case Copy::ADDRESS:
       return block.addrStr();
     case Copy::HEX_LOW:
-      return block.hexLow;
+      return block.hexLow();
     case Copy::HEX_HIGH:
-      return block.hexHigh;
+      return block.hexHigh();
     case Copy::HEX_BOTH:
       return block.hex();
     case Copy::ASCII:
-      return block.ascii;
+      return block.ascii();
     }
     return {};
   }();
@@ -140,7 +256,9 @@ void HexEdit::copyContent(const Copy type)
 
 void HexEdit::editAtCursor()
 {
-  const auto block = currentBlock();
+  if (section == nullptr || data().isEmpty()) return;
+
+  const auto block = currentRow();
   const bool showHigh = block.hasHexHigh();
 
   QDialog diag(this);
@@ -150,10 +268,10 @@ void HexEdit::editAtCursor()
 
   auto *addrLabel = new QLabel(block.addrStr() + " - " + block.addrEndStr());
 
-  auto *asciiLowLabel = new QLabel(block.ascii.mid(0, 8));
+  auto *asciiLowLabel = new QLabel(block.ascii().mid(0, 8));
   asciiLowLabel->setFont(Constants::FIXED_FONT);
 
-  auto *asciiHighLabel = new QLabel(block.ascii.mid(8));
+  auto *asciiHighLabel = new QLabel(block.ascii().mid(8));
   asciiHighLabel->setFont(Constants::FIXED_FONT);
 
   const auto createEdit = [](const QString &data, QLabel *label) {
@@ -185,8 +303,8 @@ void HexEdit::editAtCursor()
     return edit;
   };
 
-  auto *editLow = createEdit(block.hexLow, asciiLowLabel),
-       *editHigh = createEdit(block.hexHigh, asciiHighLabel);
+  auto *editLow = createEdit(block.hexLow(), asciiLowLabel),
+       *editHigh = createEdit(block.hexHigh(), asciiHighLabel);
 
   auto *lowLayout = new QHBoxLayout;
   lowLayout->addWidget(editLow);
@@ -214,37 +332,15 @@ void HexEdit::editAtCursor()
     return;
   }
 
-  auto const low = editLow->text().toUpper();
-  auto const high = editHigh->text().toUpper();
-  auto newStr = low + "  " + high;
-
-  // Pad hex string, like when low/high is less than 16 chars. Two blocks of 8*2 hex chars with a
-  // space between, and two spaces between the two hex blocks.
-  if (const int max = (8 * 2 + 7) * 2 + 2; newStr.size() < max) {
-    newStr = Util::padString(newStr, max, false, ' ');
-  }
-
-  const auto newAscii = Util::hexToAscii(newStr, 0, 16);
-  const auto newLine = QString::number(block.addr, 16).toUpper() + ": " + newStr + "   " + newAscii;
-
   // Ignore if hex wasn't changed.
-  if (newLine == block.line) {
+  const auto newData = Util::hexToData((editLow->text() + editHigh->text()).remove(' '));
+  if (newData.isEmpty() || newData == block.bytes) {
     return;
   }
 
-  // Change region.
-  quint64 pos = block.addr - section->address();
-  const auto data = Util::hexToData(newStr.replace(" ", ""));
-  section->setSubData(data, pos);
-
-  // Change line text: "[ADDR]: [LOW]  [HIGH]   [ASCII]"
-  auto cursor = textCursor();
-  cursor.clearSelection();
-  cursor.movePosition(QTextCursor::StartOfLine);
-  cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-  cursor.insertText(newLine);
-
-  markModifiedRegions();
+  // Change region, which is then rendered from the section data.
+  section->setSubData(newData, block.offset);
+  viewport()->update();
   emit edited();
 }
 
@@ -264,20 +360,11 @@ void HexEdit::findAddress()
     return;
   }
 
-  const auto *doc = document();
-  const auto firstAddr = cursorBlock(doc->firstBlock()).addr;
-  const auto lastAddr = cursorBlock(doc->lastBlock()).addr + 16;
-
+  const auto firstAddr = address();
+  const auto lastAddr = firstAddr + quint64(data().size());
   if (num >= firstAddr && num < lastAddr) {
-    num -= firstAddr; // Remove offset.
-    num /= 16;        // Find nearest 16 byte multiple.
-    const auto block = doc->findBlockByNumber(num);
-
-    auto cursor = QTextCursor(block);
-    cursor.clearSelection();
-    cursor.movePosition(QTextCursor::StartOfLine);
-    setTextCursor(cursor);
-    ensureCursorVisible();
+    const bool center(true);
+    setCurrentRow(static_cast<int>((num - firstAddr) / HexDump::bytesPerLine), center);
     return;
   }
 
@@ -286,7 +373,9 @@ void HexEdit::findAddress()
 
 void HexEdit::disassemble()
 {
-  const auto block = currentBlock();
+  if (object == nullptr) return;
+
+  const auto block = currentRow();
   DisassemblerDialog diag(this, object->cpuType(), block.hex(), block.addr);
   diag.exec();
 }
@@ -298,50 +387,109 @@ void HexEdit::showConversionHelper()
   helper->show();
 }
 
-HexEdit::Block HexEdit::cursorBlock(const QTextBlock &block)
+const QByteArray &HexEdit::data() const
+{
+  return section != nullptr ? section->data() : fileData;
+}
+
+quint64 HexEdit::address() const
+{
+  return section != nullptr ? section->address() : 0;
+}
+
+int HexEdit::rowCount() const
 {
-  const auto oldText = block.text().trimmed();
+  // Empty data still has the address row.
+  return std::max(1, (data().size() + HexDump::bytesPerLine - 1) / HexDump::bytesPerLine);
+}
 
-  const auto addr = oldText.mid(0, oldText.indexOf(':')).toULongLong(nullptr, 16);
-  const auto ascii = oldText.right(16).trimmed();
+int HexEdit::visibleRows() const
+{
+  return std::max(1, (viewport()->height() - margin * 2) / lineHeight());
+}
 
-  // Remove the address part "...:" and the last ASCII part.
-  auto text = oldText.mid(oldText.indexOf(':') + 1);
-  text.chop(ascii.size()); // Remove ASCII.
-  text = text.trimmed().replace(" ", "");
+int HexEdit::lineHeight() const
+{
+  return fontMetrics().height();
+}
 
-  // Each part is up to 2x8 chars.
-  const auto hexLow = text.mid(0, 16), hexHigh = text.mid(16, 16);
+int HexEdit::charWidth() const
+{
+  return fontMetrics().horizontalAdvance(QLatin1Char('0'));
+}
 
-  return {addr, hexLow, hexHigh, ascii, oldText};
+int HexEdit::rowAt(const QPoint &pos) const
+{
+  if (pos.y() < margin) return -1;
+  const auto index = verticalScrollBar()->value() + (pos.y() - margin) / lineHeight();
+  return index < rowCount() ? index : -1;
 }
 
-HexEdit::Block HexEdit::currentBlock() const
+HexEdit::Row HexEdit::row(int index) const
 {
-  return cursorBlock(textCursor().block());
+  const auto offset = index * HexDump::bytesPerLine;
+  return {address() + offset, offset, data().mid(offset, HexDump::bytesPerLine)};
 }
 
-void HexEdit::markModifiedRegions()
+HexEdit::Row HexEdit::currentRow() const
 {
-  const auto &modRegs = section->modifiedRegions();
-  if (modRegs.isEmpty()) return;
+  return row(curRow);
+}
 
-  const auto *doc = document();
-  modSelections.clear();
+bool HexEdit::isModified(int index) const
+{
+  if (section == nullptr) return false;
 
-  for (const auto &reg : modRegs) {
-    const auto offset = reg.position();
-    const auto block = doc->findBlockByNumber(offset / 16);
+  const auto begin = index * HexDump::bytesPerLine, end = begin + HexDump::bytesPerLine;
+  const auto &regions = section->modifiedRegions();
+  return std::any_of(regions.cbegin(), regions.cend(), [begin, end](const auto &region) {
+    return region.position() < end && region.position() + region.size() > begin;
+  });
+}
 
-    QTextEdit::ExtraSelection selection;
-    selection.format.setForeground(Qt::red);
-    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-    selection.cursor = QTextCursor(block);
+void HexEdit::setCurrentRow(int index, bool center)
+{
+  curRow = std::clamp(index, 0, rowCount() - 1);
 
-    modSelections << selection;
+  auto *scrollBar = verticalScrollBar();
+  const auto visible = visibleRows();
+  if (center) {
+    scrollBar->setValue(curRow - visible / 2);
+  }
+  else if (curRow < scrollBar->value()) {
+    scrollBar->setValue(curRow);
   }
+  else if (curRow >= scrollBar->value() + visible) {
+    scrollBar->setValue(curRow - visible + 1);
+  }
+  viewport()->update();
+}
 
-  setExtraSelections(modSelections + curLineSelection);
+void HexEdit::reset()
+{
+  curRow = 0;
+  updateScrollBars();
+  verticalScrollBar()->setValue(0);
+  horizontalScrollBar()->setValue(0);
+  viewport()->update();
+}
+
+void HexEdit::updateScrollBars()
+{
+  const auto visible = visibleRows();
+  auto *vertical = verticalScrollBar();
+  vertical->setRange(0, std::max(0, rowCount() - visible));
+  vertical->setPageStep(visible);
+  vertical->setSingleStep(1);
+
+  // The widest row is the last full one since addresses only grow in length.
+  const auto lastAddr = address() + quint64(std::max(0, data().size() - 1));
+  const auto width =
+    HexDump::lineLength(lastAddr, HexDump::bytesPerLine) * charWidth() + margin * 2;
+  auto *horizontal = horizontalScrollBar();
+  horizontal->setRange(0, std::max(0, width - viewport()->width()));
+  horizontal->setPageStep(viewport()->width());
+  horizontal->setSingleStep(charWidth());
 }
 
 } // namespace dispar
@@ -3,14 +3,21 @@
 
 #include "CpuType.h"
 
-#include <QPlainTextEdit>
+#include <QAbstractScrollArea>
+#include <QByteArray>
+
+#include <memory>
 
 namespace dispar {
 
 class Section;
 class BinaryObject;
+class MappedFile;
 
-class HexEdit : public QPlainTextEdit {
+/// Hex view of a section, or of a whole file as raw data.
+/** Only the visible rows are rendered, directly from the data, so memory use doesn't depend on the
+    size of the data. */
+class HexEdit : public QAbstractScrollArea {
   Q_OBJECT
 
   enum class Copy { ADDRESS, HEX_LOW, HEX_HIGH, HEX_BOTH, ASCII };
@@ -20,14 +27,21 @@ public:
 
   void decode(Section *section, BinaryObject *object);
 
+  /// Shows all of \p file as raw data addressed by file offset, which can't be edited.
+  void decode(std::shared_ptr<const MappedFile> file);
+
 signals:
   void edited();
 
 protected:
+  void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
+  void scrollContentsBy(int dx, int dy) override;
+  void keyPressEvent(QKeyEvent *event) override;
+  void mousePressEvent(QMouseEvent *event) override;
   void mouseDoubleClickEvent(QMouseEvent *event) override;
 
 private slots:
-  void cursorPositionChanged();
   void customContextMenuRequested(const QPoint &pos);
   void editAtCursor();
   void findAddress();
@@ -36,23 +50,49 @@ private slots:
   void showConversionHelper();
 
 private:
-  struct Block {
+  struct Row {
     quint64 addr = 0;
-    QString hexLow, hexHigh, ascii, line;
+    int offset = 0;
+    QByteArray bytes;
 
     [[nodiscard]] QString addrStr() const;
     [[nodiscard]] QString addrEndStr() const;
+    [[nodiscard]] QString hexLow() const;
+    [[nodiscard]] QString hexHigh() const;
     [[nodiscard]] QString hex() const;
+    [[nodiscard]] QString ascii() const;
     [[nodiscard]] bool hasHexHigh() const;
   };
 
-  [[nodiscard]] static Block cursorBlock(const QTextBlock &block);
-  [[nodiscard]] Block currentBlock() const;
-  void markModifiedRegions();
+  [[nodiscard]] const QByteArray &data() const;
+  [[nodiscard]] quint64 address() const;
+  [[nodiscard]] int rowCount() const;
+  [[nodiscard]] int visibleRows() const;
+  [[nodiscard]] int lineHeight() const;
+  [[nodiscard]] int charWidth() const;
+
+  /// Row at \p pos of the viewport, or -1 if there is none.
+  [[nodiscard]] int rowAt(const QPoint &pos) const;
+  [[nodiscard]] Row row(int index) const;
+  [[nodiscard]] Row currentRow() const;
+
+  /// Whether any modified region of the section overlaps row \p index.
+  [[nodiscard]] bool isModified(int index) const;
+
+  /// Makes \p index the current row and scrolls to it, centering it if \p center.
+  void setCurrentRow(int index, bool center = false);
+
+  /// Resets view to show the data from the beginning.
+  void reset();
+  void updateScrollBars();
 
   Section *section = nullptr;
   BinaryObject *object = nullptr;
-  QList<QTextEdit::ExtraSelection> modSelections, curLineSelection;
+
+  std::shared_ptr<const MappedFile> file;
+  QByteArray fileData;
+
+  int curRow = 0;
 };
 
 } // namespace dispar
@@ -1,6 +1,8 @@
 #include "widgets/HexEditor.h"
 #include "Constants.h"
 #include "Context.h"
+#include "DisassemblerPool.h"
+#include "MappedFile.h"
 #include "Util.h"
 #include "widgets/HexEdit.h"
 
@@ -30,6 +32,15 @@ HexEditor::HexEditor(Section *section_, BinaryObject *object_, QWidget *parent)
   createLayout();
 }
 
+HexEditor::HexEditor(std::shared_ptr<const MappedFile> file_, QWidget *parent)
+  : QDialog(parent), file(std::move(file_))
+{
+  assert(file);
+
+  setWindowTitle(tr("Hex View: %1").arg(file->fileName()));
+  createLayout();
+}
+
 HexEditor::~HexEditor()
 {
   Context::get().setValue("HexEditor.geometry", Util::byteArrayString(saveGeometry()));
@@ -50,7 +61,7 @@ void HexEditor::showEvent(QShowEvent *event)
       Util::centerWidget(this);
     }
   }
-  else if (section->isModified()) {
+  else if (section != nullptr && section->isModified()) {
     const auto mod = section->modifiedWhen();
     if (sectionModified.isNull() || mod != sectionModified) {
       sectionModified = mod;
@@ -63,7 +74,7 @@ void HexEditor::showEvent(QShowEvent *event)
 void HexEditor::updateDisassembly()
 {
   // Only update if section has a disassembly!
-  if (section->disassembly() == nullptr) {
+  if (section == nullptr || section->disassembly() == nullptr) {
     return;
   }
 
@@ -72,8 +83,9 @@ void HexEditor::updateDisassembly()
 
   qDebug() << "Re-dissassembling..";
 
-  Disassembler dis(*object, Context::get().disassemblerSyntax());
-  auto result = dis.disassemble(section->data());
+  auto &ctx = Context::get();
+  const auto dis = ctx.disassemblerPool().acquire(*object, ctx.disassemblerSyntax());
+  auto result = dis->disassemble(section->data());
   if (!result) {
     QMessageBox::critical(this, "", tr("Could not disassemble machine code!"));
     return;
@@ -112,13 +124,20 @@ void HexEditor::setup()
 
   createEntries();
 
-  int padSize = object->systemBits() / 8;
-  const auto addr = section->address();
-  const auto len = section->data().size();
-  label->setText(tr("Section size: %1, address %2 to %3")
-                   .arg(Util::formatSize(len))
-                   .arg(Util::padString(QString::number(addr, 16).toUpper(), padSize))
-                   .arg(Util::padString(QString::number(addr + len, 16).toUpper(), padSize)));
+  if (file) {
+    label->setText(tr("File size: %1, offset 0 to %2")
+                     .arg(Util::formatSize(file->size()))
+                     .arg(QString::number(file->size(), 16).toUpper()));
+  }
+  else {
+    int padSize = object->systemBits() / 8;
+    const auto addr = section->address();
+    const auto len = section->data().size();
+    label->setText(tr("Section size: %1, address %2 to %3")
+                     .arg(Util::formatSize(len))
+                     .arg(Util::padString(QString::number(addr, 16).toUpper(), padSize))
+                     .arg(Util::padString(QString::number(addr + len, 16).toUpper(), padSize)));
+  }
 
   // Remove dialog when all events related to the adding and drawing of text edit items have been
   // processed. This is when this additional event is processed.
@@ -138,8 +157,7 @@ void HexEditor::createEntries()
 
   qDebug() << "Generating UI for hex editor..";
 
-  const auto &sectionData = section->data();
-  int len = sectionData.size();
+  const qint64 len = file ? file->size() : section->data().size();
 
   if (len == 0) {
     label->setText(tr("Defined but empty."));
@@ -153,7 +171,12 @@ void HexEditor::createEntries()
   }
 
   textEdit->setFocus();
-  textEdit->decode(section, object);
+  if (file) {
+    textEdit->decode(file);
+  }
+  else {
+    textEdit->decode(section, object);
+  }
 
   qDebug() << ">" << elapsedTimer.restart() << "ms";
 }
@@ -169,7 +192,7 @@ void HexEditor::updateModified()
 void HexEditor::done(int result)
 {
   // Update disassembly if changed before closing dialog.
-  if (section->isModified() && sectionModified != lastModified) {
+  if (section != nullptr && section->isModified() && sectionModified != lastModified) {
     lastModified = sectionModified;
     updateDisassembly();
   }
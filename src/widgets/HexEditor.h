@@ -5,6 +5,8 @@
 #include <QDialog>
 #include <QPointer>
 
+#include <memory>
+
 #include "BinaryObject.h"
 #include "Section.h"
 
@@ -14,10 +16,14 @@ class QProgressDialog;
 namespace dispar {
 
 class HexEdit;
+class MappedFile;
 
 class HexEditor : public QDialog {
 public:
   HexEditor(Section *section, BinaryObject *object, QWidget *parent = nullptr);
+
+  /// Shows all of \p file as raw data addressed by file offset, which can't be edited.
+  HexEditor(std::shared_ptr<const MappedFile> file, QWidget *parent = nullptr);
   ~HexEditor() override;
 
   HexEditor(const HexEditor &other) = delete;
@@ -42,8 +48,9 @@ private:
   void setup();
   void createEntries();
 
-  Section *section;
-  BinaryObject *object;
+  Section *section = nullptr;
+  BinaryObject *object = nullptr;
+  std::shared_ptr<const MappedFile> file;
   QDateTime sectionModified, lastModified;
 
   bool shown = false;
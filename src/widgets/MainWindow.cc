@@ -1,9 +1,15 @@
 #include "widgets/MainWindow.h"
+#include "AnalysisCache.h"
 #include "BinaryObject.h"
+#include "Constants.h"
 #include "Context.h"
+#include "DisassemblerPool.h"
+#include "LazyDisassembly.h"
+#include "MappedFile.h"
 #include "Project.h"
 #include "Util.h"
 #include "Version.h"
+#include "cxx.h"
 #include "formats/Format.h"
 #include "formats/FormatLoader.h"
 #include "widgets/AboutDialog.h"
@@ -11,11 +17,14 @@
 #include "widgets/CenterLabel.h"
 #include "widgets/ConversionHelper.h"
 #include "widgets/DisassemblerDialog.h"
+#include "widgets/HexEditor.h"
 #include "widgets/LogDialog.h"
 #include "widgets/OmniSearchDialog.h"
 #include "widgets/OptionsDialog.h"
 
 #include <cassert>
+#include <iterator>
+#include <vector>
 
 #include <QApplication>
 #include <QCloseEvent>
@@ -37,6 +46,14 @@ MainWindow::MainWindow(const QString &file) : startupFile(file)
   setTitle();
   createLayout();
   createMenu();
+
+  // Build systems tend to write binaries in several steps, so wait for writing to settle down
+  // before reloading.
+  binaryChangedTimer.setSingleShot(true);
+  binaryChangedTimer.setInterval(500);
+  connect(&binaryChangedTimer, &QTimer::timeout, this, &MainWindow::onBinaryFileChanged);
+  connect(&binaryWatcher, &QFileSystemWatcher::fileChanged, this,
+          &MainWindow::onBinaryFileWritten);
 }
 
 MainWindow::~MainWindow()
@@ -159,9 +176,9 @@ bool MainWindow::saveProject()
     }
   }
 
-  // Attach all modified regions before saving.
+  // Attach all modified regions before saving. Only parsed objects can have been modified.
   project->clearModifiedRegions();
-  for (const auto *object : format->objects()) {
+  for (const auto *object : format->parsedObjects()) {
     for (const auto *section : object->sections()) {
       if (!section->isModified()) {
         continue;
@@ -202,12 +219,17 @@ void MainWindow::closeProject()
   saveBinaryAction->setEnabled(false);
   reloadBinaryAction->setEnabled(false);
   reloadBinaryUiAction->setEnabled(false);
+  hexViewBinaryAction->setEnabled(false);
   omniSearchAction->setEnabled(false);
 
   if (binaryWidget != nullptr) {
     binaryWidget->deleteLater();
   }
 
+  if (!binaryWatcher.files().isEmpty()) {
+    binaryWatcher.removePaths(binaryWatcher.files());
+  }
+
   if (omniSearchDialog != nullptr) {
     delete omniSearchDialog;
   }
@@ -241,7 +263,12 @@ bool MainWindow::saveBinary()
   }
 
   qDebug() << "Committing modified regions to binary:" << format->file();
+
+  // Don't reload from writing the binary ourselves.
+  binaryWatcher.removePath(format->file());
   format->write(f);
+  f.close();
+  binaryWatcher.addPath(format->file());
 
   binaryModified = false;
   saveBinaryAction->setEnabled(false);
@@ -263,6 +290,18 @@ void MainWindow::reloadBinaryUi()
   }
 }
 
+void MainWindow::hexViewBinary()
+{
+  if (format == nullptr || loader != nullptr) return;
+
+  // Reading the mapping beyond the end of a truncated file faults.
+  const auto file = format->mappedFile();
+  if (!file || file->currentSize() < file->size()) return;
+
+  HexEditor editor(file, this);
+  editor.exec();
+}
+
 void MainWindow::omniSearch()
 {
   if (binaryWidget == nullptr) return;
@@ -360,96 +399,279 @@ void MainWindow::onLoadSuccess(const std::shared_ptr<Format> &fmt)
     // Add recent file.
     Context::get().addRecentBinary(file);
 
-    auto objects = fmt->objects();
-    BinaryObject *object = nullptr;
-    if (objects.size() == 1) {
-      object = objects.first();
-    }
-    else {
+    // Only the headers have been read so far, so let the user choose from the summaries and then
+    // parse that object alone.
+    const auto summaries = fmt->summaries();
+    int idx = 0;
+    if (summaries.size() > 1) {
       auto currentCpu = Util::currentCpuType();
       qDebug() << "Current ARCH:" << cpuTypeName(currentCpu);
 
       QStringList items;
       int current = 0;
-      for (int i = 0; i < objects.size(); i++) {
-        auto *obj = objects[i];
+      for (int i = 0; i < summaries.size(); i++) {
+        const auto &summary = summaries[i];
         items << QString("%1, %2 (%3-bit)")
-                   .arg(cpuTypeName(obj->cpuType()))
-                   .arg(cpuTypeName(obj->cpuSubType()))
-                   .arg(obj->systemBits());
+                   .arg(cpuTypeName(summary.cpuType))
+                   .arg(cpuTypeName(summary.cpuSubType))
+                   .arg(summary.systemBits);
 
-        if (obj->cpuType() == currentCpu && obj->systemBits() == sizeof(void *) * 8) {
+        if (summary.cpuType == currentCpu && summary.systemBits == sizeof(void *) * 8) {
           current = i;
         }
       }
 
       bool ok = false;
-      auto choice = QInputDialog::getItem(this, tr("%1 binary objects in file").arg(objects.size()),
-                                          tr("Choose:"), items, current, false, &ok);
+      auto choice =
+        QInputDialog::getItem(this, tr("%1 binary objects in file").arg(summaries.size()),
+                              tr("Choose:"), items, current, false, &ok);
 
       if (!ok || choice.isEmpty()) {
         return;
       }
 
-      int idx = items.indexOf(choice);
+      idx = items.indexOf(choice);
       assert(idx != -1);
-      object = objects[idx];
     }
-    assert(object);
 
+    auto *object = fmt->object(idx);
+    if (object == nullptr) {
+      QMessageBox::critical(this, "dispar", tr("Could not parse binary object!"));
+      return;
+    }
+
+    objectIndex = idx;
     applyModifiedRegions(object);
+    disassembleSections(object);
+    showBinaryObject(fmt, object, summaries[idx].offset);
+  });
+}
+
+void MainWindow::onBinaryFileWritten()
+{
+  // Sections of all parsed objects, hex views, and anything else holding views of the mapped
+  // binary fault when reading beyond the end of the file if truncated, so guard the mapping itself
+  // right away instead of each holder. Hashing is waited for such that the hashes are of the binary
+  // as it was loaded.
+  if (format != nullptr && loader == nullptr) {
+    hashPool.waitForDone();
+    cachePool.waitForDone();
+    if (binaryWidget != nullptr) {
+      binaryWidget->stopStringExtraction();
+    }
+    if (const auto file = format->mappedFile(); file) {
+      file->guardTruncation();
+    }
+  }
+
+  binaryChangedTimer.start();
+}
+
+void MainWindow::onBinaryFileChanged()
+{
+  if (format == nullptr || binaryWidget == nullptr || loader != nullptr) return;
+
+  // Files replaced by renaming are no longer watched.
+  const auto file = format->file();
+  if (!QFile::exists(file)) return;
+  if (!binaryWatcher.files().contains(file)) {
+    binaryWatcher.addPath(file);
+  }
+
+  if (binaryModified) {
+    const auto answer = QMessageBox::question(
+      this, "dispar",
+      tr("The binary changed on disk. Reload it and discard unsaved modifications?"));
+    if (answer != QMessageBox::Yes) return;
+  }
+
+  if (!reloadChangedBinary()) {
+    qWarning() << "Could not reload changed sections, reloading all of binary instead";
+    loadBinary(file);
+  }
+}
+
+bool MainWindow::reloadChangedBinary()
+{
+  QElapsedTimer elapsedTimer;
+  elapsedTimer.start();
+
+  const auto file = format->file();
+  qDebug() << "Reloading changed binary:" << file;
+
+  auto *previous = format->object(objectIndex);
+  if (previous == nullptr) return false;
+
+  auto fmt = Format::detect(file);
+  if (fmt == nullptr) return false;
+
+  fmt->setCache(Context::get().analysisCache());
+  if (!fmt->parse()) return false;
+
+  // Find the object of the same architecture as before.
+  const auto summaries = fmt->summaries();
+  const auto it = cxx::find_if(summaries, [previous](const auto &summary) {
+    return summary.cpuType == previous->cpuType() && summary.cpuSubType == previous->cpuSubType() &&
+           summary.systemBits == previous->systemBits();
+  });
+  if (it == summaries.cend()) return false;
+
+  const auto idx = static_cast<int>(std::distance(summaries.cbegin(), it));
+  auto *object = fmt->object(idx);
+  if (object == nullptr) return false;
+
+  applyModifiedRegions(object);
+
+  // Disassembly is taken from the previous object, so it must no longer be stored.
+  cachePool.waitForDone();
 
-    QElapsedTimer elapsedTimer;
-    elapsedTimer.start();
-
-    QProgressDialog disDiag(this);
-    disDiag.setLabelText(tr("Disassembling code sections.."));
-    disDiag.setCancelButton(nullptr);
-    disDiag.setRange(0, 0);
-    disDiag.show();
-    qApp->processEvents();
-    qDebug() << qPrintable(disDiag.labelText());
-
-    Disassembler dis(*object, Context::get().disassemblerSyntax());
-    if (dis.valid()) {
-      for (auto &sec : object->sections()) {
-        switch (sec->type()) {
-        case Section::Type::TEXT:
-        case Section::Type::SYMBOL_STUBS: {
-          auto res = dis.disassemble(sec->data());
-          if (res) {
-            sec->setDisassembly(std::move(res));
-          }
+  // Only disassemble sections that changed.
+  const auto changed = object->reuseAnalysis(*previous);
+  qDebug() << changed.size() << "of" << object->sections().size() << "sections changed";
+
+  const auto address = binaryWidget->currentAddress();
+
+  format = fmt;
+  objectIndex = idx;
+  binaryModified = false;
+  saveBinaryAction->setEnabled(false);
+  setTitle(Context::get().project()->file());
+
+  disassembleSections(object);
+  showBinaryObject(fmt, object, it->offset, address);
+
+  qDebug() << "Reloaded in" << elapsedTimer.elapsed() << "ms";
+  return true;
+}
+
+void MainWindow::disassembleSections(BinaryObject *object)
+{
+  QElapsedTimer elapsedTimer;
+  elapsedTimer.start();
+
+  QProgressDialog disDiag(this);
+  disDiag.setLabelText(tr("Disassembling code sections.."));
+  disDiag.setCancelButton(nullptr);
+  disDiag.setRange(0, 0);
+  disDiag.show();
+  qApp->processEvents();
+  qDebug() << qPrintable(disDiag.labelText());
+
+  // Symbols and function starts are known to start instructions, so large sections can be split at
+  // them and disassembled concurrently.
+  const auto addressIndex = object->addressIndex();
+
+  auto &ctx = Context::get();
+  const auto dis = ctx.disassemblerPool().acquire(*object, ctx.disassemblerSyntax());
+  if (dis->valid()) {
+    for (auto &sec : object->sections()) {
+      // Disassembly might have been kept from before reloading.
+      if (sec->disassembly() != nullptr) {
+        continue;
+      }
+
+      switch (sec->type()) {
+      case Section::Type::TEXT:
+      case Section::Type::SYMBOL_STUBS: {
+        // The binary widget disassembles large sections, and those with cached instruction offsets,
+        // while scrolling instead.
+        if (Context::get().lazyDisassembly() && LazyDisassembly::suits(*sec)) {
           break;
         }
 
-        default:
-          break;
+        auto boundaries = addressIndex->starts(sec->address(), sec->address() + sec->size());
+        for (auto &boundary : boundaries) {
+          boundary -= sec->address();
+        }
+
+        // Cached instruction offsets are all boundaries, but a few suffice to split at.
+        constexpr std::size_t stride = 4096;
+        const auto &offsets = sec->instructionOffsets();
+        for (std::size_t i = 0; i < offsets.size(); i += stride) {
+          boundaries.push_back(offsets[i]);
         }
+        auto res = dis->disassembleConcurrently(sec->data(), std::move(boundaries),
+                                                ctx.disassemblerPool(), *object);
+        if (res) {
+          sec->setDisassembly(std::move(res));
+        }
+        break;
+      }
+
+      default:
+        break;
       }
     }
+  }
 
-    disDiag.close();
-    qDebug() << ">" << elapsedTimer.restart() << "ms";
+  disDiag.close();
+  qDebug() << ">" << elapsedTimer.restart() << "ms";
+}
 
-    if (centralWidget() != nullptr) {
-      centralWidget()->deleteLater();
+void MainWindow::showBinaryObject(const std::shared_ptr<Format> &fmt, BinaryObject *object,
+                                  quint64 offset, quint64 address)
+{
+  if (centralWidget() != nullptr) {
+    centralWidget()->deleteLater();
+  }
+
+  // Hash disassembled sections off the GUI thread while the binary is as loaded, so their disassembly
+  // can be reused when reloading if they didn't change. The format keeps the object alive.
+  QList<const Section *> disassembled;
+  for (const auto *sec : object->sections()) {
+    if (sec->disassembly() != nullptr) {
+      disassembled << sec;
     }
+  }
+  if (!disassembled.isEmpty()) {
+    hashPool.start([fmt, disassembled] {
+      for (const auto *sec : disassembled) {
+        (void) sec->hash();
+      }
+    });
+  }
 
-    binaryWidget = new BinaryWidget(object);
-    connect(binaryWidget, &BinaryWidget::modified, this, &MainWindow::onBinaryModified);
-    connect(binaryWidget, &BinaryWidget::loaded, this,
-            [this] { omniSearchAction->setEnabled(true); });
+  binaryWidget = new BinaryWidget(object);
+  binaryWidget->setStartAddress(address);
 
-    // Clear active omni search.
-    if (omniSearchDialog != nullptr) {
-      delete omniSearchDialog;
+  // Strings can be extracted from all of the object as mapped from the file.
+  const auto summaries = fmt->summaries();
+  const auto it = cxx::find_if(
+    summaries, [offset](const auto &summary) { return summary.offset == offset; });
+  if (it != summaries.cend()) {
+    binaryWidget->setMappedFile(fmt->mappedFile(), it->offset, it->size);
+  }
+
+  connect(binaryWidget, &BinaryWidget::modified, this, &MainWindow::onBinaryModified);
+  connect(binaryWidget, &BinaryWidget::loaded, this, [this, fmt, object, offset] {
+    omniSearchAction->setEnabled(true);
+
+    // Store analysis for faster loading next time, off the GUI thread since it serializes all of
+    // the object. The format keeps the object alive.
+    const auto cache = Context::get().analysisCache();
+    const auto fingerprint = fmt->fingerprint();
+    if (cache && !cache->contains(fingerprint, offset)) {
+      cachePool.start([cache, fingerprint, offset, fmt, object] {
+        cache->store(fingerprint, offset, *object);
+      });
     }
+  });
 
-    setCentralWidget(binaryWidget);
+  // Clear active omni search.
+  if (omniSearchDialog != nullptr) {
+    delete omniSearchDialog;
+  }
 
-    reloadBinaryUiAction->setEnabled(true);
-  });
+  setCentralWidget(binaryWidget);
+
+  reloadBinaryUiAction->setEnabled(true);
+  hexViewBinaryAction->setEnabled(true);
+
+  // Watch for changes to reload changed sections.
+  if (!binaryWatcher.files().isEmpty()) {
+    binaryWatcher.removePaths(binaryWatcher.files());
+  }
+  binaryWatcher.addPath(fmt->file());
 }
 
 void MainWindow::onProjectModified()
@@ -543,6 +765,10 @@ void MainWindow::createMenu()
     viewMenu->addAction(tr("Reload binary UI"), this, &MainWindow::reloadBinaryUi);
   reloadBinaryUiAction->setEnabled(false);
 
+  hexViewBinaryAction =
+    viewMenu->addAction(tr("Hex view of binary file"), this, &MainWindow::hexViewBinary);
+  hexViewBinaryAction->setEnabled(false);
+
   omniSearchAction = viewMenu->addAction(tr("Omni Search"), this, &MainWindow::omniSearch,
                                          QKeySequence(Qt::SHIFT + Qt::CTRL + Qt::Key_F));
   omniSearchAction->setEnabled(false);
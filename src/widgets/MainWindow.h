@@ -1,9 +1,12 @@
 #ifndef DISPAR_MAIN_WINDOW_H
 #define DISPAR_MAIN_WINDOW_H
 
+#include <QFileSystemWatcher>
 #include <QList>
 #include <QMainWindow>
 #include <QPointer>
+#include <QThreadPool>
+#include <QTimer>
 
 #include <memory>
 
@@ -54,6 +57,9 @@ private slots:
   void reloadBinary();
   void reloadBinaryUi();
 
+  /// Shows all of the binary file as raw data.
+  void hexViewBinary();
+
   void loadFile(const QString &file);
 
   void omniSearch();
@@ -69,6 +75,13 @@ private slots:
   void onProjectModified();
   void onBinaryModified();
 
+  /// Detaches the shown object from the binary file, which is being written, and reloads it once
+  /// writing settles.
+  void onBinaryFileWritten();
+
+  /// Reloads the binary when it has changed on disk.
+  void onBinaryFileChanged();
+
 private:
   void setTitle(const QString &file = QString());
   void createLayout();
@@ -87,15 +100,37 @@ private:
   /// Apply any saved modified regions from project to \p object.
   void applyModifiedRegions(BinaryObject *object);
 
+  /// Reparses the changed binary and only disassembles sections that changed.
+  /** The project, including tags, and cursor position are kept. Returns false if the binary no
+      longer contains an object like the current one. */
+  bool reloadChangedBinary();
+
+  /// Disassemble code sections of \p object that aren't already.
+  void disassembleSections(BinaryObject *object);
+
+  void showBinaryObject(const std::shared_ptr<Format> &fmt, BinaryObject *object, quint64 offset,
+                        quint64 address = 0);
+
   bool modified = false, binaryModified = false;
   QString startupFile;
 
   QAction *newProjectAction = nullptr, *saveProjectAction = nullptr, *saveAsProjectAction = nullptr,
           *closeProjectAction = nullptr, *saveBinaryAction = nullptr, *reloadBinaryAction = nullptr,
-          *reloadBinaryUiAction = nullptr, *omniSearchAction = nullptr;
+          *reloadBinaryUiAction = nullptr, *hexViewBinaryAction = nullptr,
+          *omniSearchAction = nullptr;
 
   std::unique_ptr<FormatLoader> loader;
   std::shared_ptr<Format> format;
+  int objectIndex = -1;
+
+  QFileSystemWatcher binaryWatcher;
+  QTimer binaryChangedTimer;
+
+  /// Hashes sections of the shown object in the background.
+  QThreadPool hashPool;
+
+  /// Stores analysis of the shown object in the cache in the background.
+  QThreadPool cachePool;
 
   QPointer<BinaryWidget> binaryWidget;
   QPointer<OmniSearchDialog> omniSearchDialog;
@@ -1,8 +1,10 @@
 #include "widgets/OptionsDialog.h"
+#include "AnalysisCache.h"
 #include "BinaryObject.h"
 #include "Constants.h"
 #include "Context.h"
 #include "Disassembler.h"
+#include "DisassemblerPool.h"
 #include "cxx.h"
 
 #include <QCheckBox>
@@ -78,14 +80,16 @@ void OptionsDialog::onAccept()
 
   auto &ctx = Context::get();
   ctx.setShowMachineCode(showMachineCode->checkState() == Qt::Checked);
+  ctx.setLazyDisassembly(lazyDisassembly->checkState() == Qt::Checked);
+
+  ctx.setStringsMinLength(stringsMinLength->value());
+  auto encodings = ctx.stringsEncodings();
+  encodings.setFlag(StringExtractor::Encoding::UTF16_LE, utf16LeStrings->isChecked());
+  encodings.setFlag(StringExtractor::Encoding::UTF16_BE, utf16BeStrings->isChecked());
+  ctx.setStringsEncodings(encodings);
+  ctx.setStringsScanFile(scanFileStrings->isChecked());
 
   auto syntax = static_cast<Disassembler::Syntax>(disAsmSyntax->currentData().toInt());
-  static bool disWarnOnce = false;
-  if (!disWarnOnce && syntax != ctx.disassemblerSyntax()) {
-    disWarnOnce = true;
-    QMessageBox::warning(
-      this, "dispar", tr("Disassembler syntax won't change until the program has been restarted!"));
-  }
   ctx.setDisassemblerSyntax(syntax);
 
   const auto newLevel = logLevelBox->currentData().toInt();
@@ -106,8 +110,8 @@ void OptionsDialog::onSyntaxChanged(int index)
   // Using 32-bit because it makes the instructions span two lines, yielding a better example.
   const BinaryObject obj(CpuType::X86);
 
-  Disassembler dis(obj, syntax);
-  const auto res = dis.disassemble(QString("48 83 EC 70"), 0x2b9a);
+  const auto dis = Context::get().disassemblerPool().acquire(obj, syntax);
+  const auto res = dis->disassemble(QString("48 83 EC 70"), 0x2b9a);
   if (res) {
     disAsmExample->setText(res->toString());
   }
@@ -125,6 +129,10 @@ void OptionsDialog::createLayout()
   showMachineCode = new QCheckBox(tr("Show Machine Code"));
   showMachineCode->setChecked(ctx.showMachineCode());
 
+  lazyDisassembly = new QCheckBox(tr("Disassemble Large Code Sections While Scrolling"));
+  lazyDisassembly->setChecked(ctx.lazyDisassembly());
+  lazyDisassembly->setToolTip(tr("Shows huge binaries faster but decodes more when scrolling."));
+
   auto *disAsmLabel = new QLabel(tr("Disassembly Syntax:"));
 
   disAsmSyntax = new QComboBox;
@@ -161,11 +169,41 @@ void OptionsDialog::createLayout()
   omniLayout->addWidget(omniLimitSpin);
   omniLayout->addStretch();
 
+  stringsMinLength = new QSpinBox;
+  stringsMinLength->setRange(Constants::Strings::MIN_MIN_LENGTH,
+                             Constants::Strings::MAX_MIN_LENGTH);
+  stringsMinLength->setValue(ctx.stringsMinLength());
+  stringsMinLength->setToolTip(
+    tr("Characters needed to show data outside of string sections as strings."));
+
+  utf16LeStrings = new QCheckBox(tr("UTF-16 LE"));
+  utf16LeStrings->setChecked(ctx.stringsEncodings().testFlag(StringExtractor::Encoding::UTF16_LE));
+
+  utf16BeStrings = new QCheckBox(tr("UTF-16 BE"));
+  utf16BeStrings->setChecked(ctx.stringsEncodings().testFlag(StringExtractor::Encoding::UTF16_BE));
+
+  scanFileStrings = new QCheckBox(tr("Extract Strings From Whole Binary File"));
+  scanFileStrings->setChecked(ctx.stringsScanFile());
+  scanFileStrings->setToolTip(
+    tr("Finds strings in all sections and segments of the binary object as mapped from the file "
+       "instead of only in data sections. Strings outside of sections have no address and are "
+       "left out."));
+
+  auto *stringsLayout = new QHBoxLayout;
+  stringsLayout->addWidget(new QLabel(tr("Minimum string length:")));
+  stringsLayout->addWidget(stringsMinLength);
+  stringsLayout->addWidget(utf16LeStrings);
+  stringsLayout->addWidget(utf16BeStrings);
+  stringsLayout->addStretch();
+
   auto *mainLayout = new QVBoxLayout;
   mainLayout->addWidget(showMachineCode);
+  mainLayout->addWidget(lazyDisassembly);
   mainLayout->addLayout(disAsmSyntaxLayout);
   mainLayout->addWidget(disAsmExample);
   mainLayout->addLayout(omniLayout);
+  mainLayout->addLayout(stringsLayout);
+  mainLayout->addWidget(scanFileStrings);
 
   auto *mainGroup = new QGroupBox(tr("Main View"));
   mainGroup->setLayout(mainLayout);
@@ -239,6 +277,37 @@ void OptionsDialog::createLayout()
   backupGroup->setLayout(backupLayout);
   connect(backupGroup, &QGroupBox::toggled, this, [&ctx](bool on) { ctx.setBackupEnabled(on); });
 
+  ///// Analysis Cache
+
+  auto *cacheLabel = new QLabel(tr("Analysis of binaries is saved in \"%1\" so they load faster "
+                                   "when opened again. The least recently used are removed when "
+                                   "the cache grows beyond its maximum size.")
+                                  .arg(AnalysisCache::defaultDir()));
+  cacheLabel->setWordWrap(true);
+
+  auto *cacheSizeSpin = new QSpinBox;
+  cacheSizeSpin->setRange(Constants::Cache::MIN_MAX_SIZE, Constants::Cache::MAX_MAX_SIZE);
+  cacheSizeSpin->setValue(ctx.analysisCacheMaxSize());
+  cacheSizeSpin->setSuffix(" MB");
+  connect(cacheSizeSpin, &QSpinBox::editingFinished, this,
+          [&ctx, cacheSizeSpin] { ctx.setAnalysisCacheMaxSize(cacheSizeSpin->value()); });
+
+  auto *cacheSizeLayout = new QHBoxLayout;
+  cacheSizeLayout->addWidget(new QLabel(tr("Maximum size:")));
+  cacheSizeLayout->addWidget(cacheSizeSpin);
+  cacheSizeLayout->addStretch();
+
+  auto *cacheLayout = new QVBoxLayout;
+  cacheLayout->addWidget(cacheLabel);
+  cacheLayout->addLayout(cacheSizeLayout);
+
+  auto *cacheGroup = new QGroupBox(tr("Analysis Cache"));
+  cacheGroup->setCheckable(true);
+  cacheGroup->setChecked(ctx.analysisCacheEnabled());
+  cacheGroup->setLayout(cacheLayout);
+  connect(cacheGroup, &QGroupBox::toggled, this,
+          [&ctx](bool on) { ctx.setAnalysisCacheEnabled(on); });
+
   ///// Debugger
 
   debuggerEdit = new QLineEdit;
@@ -300,6 +369,7 @@ void OptionsDialog::createLayout()
   layout->addWidget(mainGroup);
   layout->addWidget(logGroup);
   layout->addWidget(backupGroup);
+  layout->addWidget(cacheGroup);
   layout->addWidget(debuggerGroup);
   layout->addStretch();
   layout->addWidget(buttonBox);
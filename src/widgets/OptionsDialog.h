@@ -9,6 +9,7 @@ class QLabel;
 class QCheckBox;
 class QComboBox;
 class QLineEdit;
+class QSpinBox;
 
 namespace dispar {
 
@@ -30,7 +31,9 @@ private:
   /// Returns instance of debugger from values in UI.
   [[nodiscard]] Debugger currentDebugger() const;
 
-  QCheckBox *showMachineCode = nullptr;
+  QCheckBox *showMachineCode = nullptr, *lazyDisassembly = nullptr, *utf16LeStrings = nullptr,
+            *utf16BeStrings = nullptr, *scanFileStrings = nullptr;
+  QSpinBox *stringsMinLength = nullptr;
   QComboBox *disAsmSyntax = nullptr, *logLevelBox = nullptr;
   QLineEdit *debuggerEdit = nullptr, *launchPatternEdit = nullptr, *versionArgumentEdit = nullptr;
   QLabel *disAsmExample = nullptr;
@@ -209,30 +209,48 @@ void TreeWidget::findAddress()
     return;
   }
 
-  int cnt = topLevelItemCount();
-  for (int i = 0; i < cnt; i++) {
-    auto *item = topLevelItem(i);
-    quint64 n = item->text(addrColumn).toULongLong(&ok, 16);
-    if (!ok) continue;
-    if (n == num) {
-      setCurrentItem(item);
-      scrollToItem(item, QAbstractItemView::PositionAtCenter);
-      return;
+  // Binary search for the last item at or before the address, since items are in address order.
+  const auto count = topLevelItemCount();
+  int first = 0, last = count, found = -1;
+  while (first < last) {
+    const auto mid = first + (last - first) / 2;
+    const auto row = itemWithAddress(mid, last);
+    if (row == -1) {
+      last = mid;
+      continue;
     }
 
-    if (i < cnt - 1) {
-      auto *item2 = topLevelItem(i + 1);
-      quint64 n2 = item2->text(addrColumn).toULongLong(&ok, 16);
-      if (!ok) continue;
-      if (num >= n && num < n2) {
-        setCurrentItem(item);
-        scrollToItem(item, QAbstractItemView::PositionAtCenter);
-        return;
-      }
+    if (topLevelItem(row)->text(addrColumn).toULongLong(nullptr, 16) <= num) {
+      found = row;
+      first = row + 1;
     }
+    else {
+      last = mid;
+    }
+  }
+
+  // The address must be inside the item found, which is only known for the last item if equal.
+  if (found == -1 || (itemWithAddress(found + 1, count) == -1 &&
+                      topLevelItem(found)->text(addrColumn).toULongLong(nullptr, 16) != num)) {
+    QMessageBox::information(this, "dispar", tr("Did not find anything."));
+    return;
   }
 
-  QMessageBox::information(this, "dispar", tr("Did not find anything."));
+  auto *item = topLevelItem(found);
+  setCurrentItem(item);
+  scrollToItem(item, QAbstractItemView::PositionAtCenter);
+}
+
+int TreeWidget::itemWithAddress(int first, int last) const
+{
+  for (int row = first; row < last; row++) {
+    bool ok = false;
+    (void) topLevelItem(row)->text(addrColumn).toULongLong(&ok, 16);
+    if (ok) {
+      return row;
+    }
+  }
+  return -1;
 }
 
 void TreeWidget::showConversionHelper()
@@ -48,6 +48,9 @@ private slots:
 
 private:
   void resetSearch();
+
+  /// First row in [\p first, \p last) with an address, or -1 if none.
+  [[nodiscard]] int itemWithAddress(int first, int last) const;
   void selectSearchResult(int col, int item);
   void showSearchText(const QString &text);
 
@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include "AddressIndex.h"
+#include "BinaryObject.h"
+#include "Section.h"
+#include "SymbolTable.h"
+#include "formats/MachO.h"
+using namespace dispar;
+
+TEST(AddressIndex, sections)
+{
+  BinaryObject object;
+  object.addSection(std::make_unique<Section>(Section::Type::SEGMENT, "seg", 0x1000, 0x100));
+  object.addSection(std::make_unique<Section>(Section::Type::TEXT, "text", 0x1010, 0x20));
+  object.addSection(std::make_unique<Section>(Section::Type::CSTRING, "cstring", 0x1030, 0x10));
+  object.addSection(std::make_unique<Section>(Section::Type::OTHER, "empty", 0x1050, 0));
+  object.addSection(std::make_unique<Section>(Section::Type::OTHER, "data", 0x2000, 0x10));
+  const auto sections = object.sections();
+
+  const AddressIndex index(object);
+  EXPECT_EQ(index.section(0xfff), nullptr);
+  EXPECT_EQ(index.section(0x1000), sections[0]);
+  EXPECT_EQ(index.section(0x1010), sections[1]);
+  EXPECT_EQ(index.section(0x102f), sections[1]);
+  EXPECT_EQ(index.section(0x1030), sections[2]);
+  EXPECT_EQ(index.section(0x1040), sections[0]);
+  EXPECT_EQ(index.section(0x1050), sections[0]);
+  EXPECT_EQ(index.section(0x10ff), sections[0]);
+  EXPECT_EQ(index.section(0x1100), nullptr);
+  EXPECT_EQ(index.section(0x2008), sections[4]);
+  EXPECT_EQ(index.section(0x2010), nullptr);
+}
+
+TEST(AddressIndex, symbols)
+{
+  BinaryObject object;
+
+  SymbolTable symbols;
+  symbols.addSymbol(SymbolEntry(0, 0x1020, "_b"));
+  symbols.addSymbol(SymbolEntry(1, 0x1000, "_a"));
+  symbols.addSymbol(SymbolEntry(2, 0x1030));
+  object.setSymbolTable(symbols);
+
+  SymbolTable dynSymbols;
+  dynSymbols.addSymbol(SymbolEntry(0, 0x1020, "_dyn_b"));
+  dynSymbols.addSymbol(SymbolEntry(1, 0x1040, "_dyn_c"));
+  object.setDynSymbolTable(dynSymbols);
+
+  const AddressIndex index(object);
+  EXPECT_EQ(index.symbol(0x1000), QString("_a"));
+  EXPECT_EQ(index.symbol(0x1020), QString("_b"));
+  EXPECT_EQ(index.symbol(0x1040), QString("_dyn_c"));
+  EXPECT_FALSE(index.symbol(0x1010));
+  EXPECT_FALSE(index.symbol(0x1030));
+
+  EXPECT_FALSE(index.symbolAtOrBefore(0xfff));
+  EXPECT_EQ(index.symbolAtOrBefore(0x1000), quint64(0x1000));
+  EXPECT_EQ(index.symbolAtOrBefore(0x101f), quint64(0x1000));
+  EXPECT_EQ(index.symbolAtOrBefore(0x1035), quint64(0x1020));
+  EXPECT_EQ(index.symbolAtOrBefore(0x9000), quint64(0x1040));
+}
+
+TEST(AddressIndex, starts)
+{
+  BinaryObject object;
+
+  SymbolTable symbols;
+  symbols.addSymbol(SymbolEntry(0, 0x1000, "_a"));
+  symbols.addSymbol(SymbolEntry(1, 0x1020, "_b"));
+  symbols.addSymbol(SymbolEntry(2, 0x2000, "_data"));
+  object.setSymbolTable(symbols);
+  object.setFunctionStarts({0x1000, 0x1010, 0x1030});
+
+  const AddressIndex index(object);
+  EXPECT_EQ(index.starts(0x1000, 0x1100), (std::vector<quint64>{0x1000, 0x1010, 0x1020, 0x1030}));
+  EXPECT_EQ(index.starts(0x1001, 0x1030), (std::vector<quint64>{0x1010, 0x1020}));
+  EXPECT_TRUE(index.starts(0x1100, 0x2000).empty());
+
+  EXPECT_FALSE(index.functionStart(0xfff));
+  EXPECT_EQ(index.functionStart(0x101f), quint64(0x1010));
+}
+
+TEST(AddressIndex, binaryObject)
+{
+  BinaryObject object;
+  const auto index = object.addressIndex();
+  ASSERT_NE(index, nullptr);
+  EXPECT_EQ(object.addressIndex(), index);
+  EXPECT_EQ(index->section(0x1000), nullptr);
+
+  // Changes give a new index and leave the old one as it was.
+  object.addSection(std::make_unique<Section>(Section::Type::TEXT, "text", 0x1000, 0x10));
+  const auto index2 = object.addressIndex();
+  EXPECT_NE(index2, index);
+  EXPECT_EQ(index2->section(0x1000), object.sections()[0]);
+  EXPECT_EQ(index->section(0x1000), nullptr);
+}
+
+TEST(AddressIndex, macho)
+{
+  MachO fmt(":macho_main");
+  ASSERT_TRUE(fmt.parse());
+  auto *object = fmt.object(0);
+  ASSERT_NE(object, nullptr);
+
+  const auto index = object->addressIndex();
+  const auto *text = object->section(Section::Type::TEXT);
+  ASSERT_NE(text, nullptr);
+  EXPECT_EQ(index->section(text->address()), text);
+  EXPECT_EQ(index->section(text->address() + text->size() - 1), text);
+
+  // Every named symbol is found at its address.
+  for (const auto &symbol : object->symbolTable().symbols()) {
+    if (!symbol.string().isEmpty()) {
+      EXPECT_TRUE(index->symbol(symbol.value())) << symbol.string();
+    }
+  }
+}
@@ -0,0 +1,227 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "AnalysisCache.h"
+#include "BinaryObject.h"
+#include "MappedFile.h"
+#include "formats/MachO.h"
+using namespace dispar;
+
+TEST(AnalysisCache, path)
+{
+  AnalysisCache cache("/tmp/cache");
+  EXPECT_EQ(cache.dir(), "/tmp/cache");
+  EXPECT_EQ(cache.path("abc", 0x1000), "/tmp/cache/abc-1000.cache");
+  EXPECT_FALSE(cache.contains("abc", 0x1000));
+  EXPECT_FALSE(cache.contains({}, 0));
+}
+
+TEST(AnalysisCache, loadUnknown)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  AnalysisCache cache(dir.path());
+  EXPECT_EQ(cache.load("abc", 0, nullptr), nullptr);
+}
+
+TEST(AnalysisCache, loadInvalid)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  AnalysisCache cache(dir.path());
+
+  QFile f(cache.path("abc", 0));
+  ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+  f.write("not a cache file");
+  f.close();
+
+  EXPECT_TRUE(cache.contains("abc", 0));
+  EXPECT_EQ(cache.load("abc", 0, nullptr), nullptr);
+}
+
+TEST(AnalysisCache, storeLoad)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  AnalysisCache cache(dir.path());
+
+  MachO fmt(":macho_main");
+  ASSERT_TRUE(fmt.parse());
+  auto *object = fmt.object(0);
+  ASSERT_NE(object, nullptr);
+  object->setDemangledNames({{"__Z3foov", "foo()"}});
+
+  const auto fingerprint = fmt.fingerprint();
+  ASSERT_FALSE(fingerprint.isEmpty());
+
+  const auto offset = fmt.summaries()[0].offset;
+  ASSERT_TRUE(cache.store(fingerprint, offset, *object));
+  EXPECT_TRUE(cache.contains(fingerprint, offset));
+
+  auto mapping = MappedFile::open(":macho_main");
+  ASSERT_NE(mapping, nullptr);
+
+  auto cached = cache.load(fingerprint, offset, mapping);
+  ASSERT_NE(cached, nullptr);
+
+  EXPECT_EQ(cached->cpuType(), object->cpuType());
+  EXPECT_EQ(cached->cpuSubType(), object->cpuSubType());
+  EXPECT_EQ(cached->endianness(), object->endianness());
+  EXPECT_EQ(cached->systemBits(), object->systemBits());
+  EXPECT_EQ(cached->fileType(), object->fileType());
+
+  const auto sections = object->sections();
+  const auto cachedSections = cached->sections();
+  ASSERT_EQ(cachedSections.size(), sections.size());
+  for (int i = 0; i < sections.size(); i++) {
+    const auto *section = sections[i];
+    const auto *cachedSection = cachedSections[i];
+    EXPECT_EQ(cachedSection->type(), section->type());
+    EXPECT_EQ(cachedSection->name(), section->name());
+    EXPECT_EQ(cachedSection->address(), section->address());
+    EXPECT_EQ(cachedSection->size(), section->size());
+    EXPECT_EQ(cachedSection->offset(), section->offset());
+    EXPECT_EQ(cachedSection->isMapped(), section->isMapped());
+    EXPECT_EQ(cachedSection->data(), section->data());
+  }
+
+  const auto &symbols = object->symbolTable().symbols();
+  const auto &cachedSymbols = cached->symbolTable().symbols();
+  ASSERT_EQ(cachedSymbols.size(), symbols.size());
+  for (std::size_t i = 0; i < symbols.size(); i++) {
+    EXPECT_EQ(cachedSymbols[i].index(), symbols[i].index());
+    EXPECT_EQ(cachedSymbols[i].value(), symbols[i].value());
+    EXPECT_EQ(cachedSymbols[i].string(), symbols[i].string());
+  }
+
+  EXPECT_EQ(cached->dynSymbolTable().symbols().size(), object->dynSymbolTable().symbols().size());
+  EXPECT_EQ(cached->demangledNames(), object->demangledNames());
+}
+
+TEST(AnalysisCache, storeModified)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  AnalysisCache cache(dir.path());
+
+  MachO fmt(":macho_main");
+  ASSERT_TRUE(fmt.parse());
+  auto *object = fmt.object(0);
+  ASSERT_NE(object, nullptr);
+
+  auto sections = object->sections();
+  ASSERT_FALSE(sections.isEmpty());
+  sections.first()->setSubData("x", 0);
+
+  EXPECT_FALSE(cache.store(fmt.fingerprint(), 0, *object));
+}
+
+TEST(AnalysisCache, loadOutOfRange)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  AnalysisCache cache(dir.path());
+
+  MachO fmt(":macho_main");
+  ASSERT_TRUE(fmt.parse());
+  auto *object = fmt.object(0);
+  ASSERT_NE(object, nullptr);
+
+  const auto fingerprint = fmt.fingerprint();
+  ASSERT_TRUE(cache.store(fingerprint, 0, *object));
+
+  QFile f(cache.path(fingerprint, 0));
+  ASSERT_TRUE(f.open(QIODevice::ReadOnly));
+  const auto stored = f.readAll();
+  f.close();
+
+  auto mapping = MappedFile::open(":macho_main");
+  ASSERT_NE(mapping, nullptr);
+  ASSERT_NE(cache.load(fingerprint, 0, mapping), nullptr);
+
+  // File type of the header, type of the first section, and size of the first section.
+  for (const int pos : {28, 64, 64 + 16}) {
+    auto data = stored;
+    data.replace(pos, 4, QByteArray(4, '\x7f'));
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+    f.write(data);
+    f.close();
+    EXPECT_EQ(cache.load(fingerprint, 0, mapping), nullptr) << pos;
+  }
+}
+
+TEST(AnalysisCache, parseFromCache)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  auto cache = std::make_shared<AnalysisCache>(dir.path());
+
+  QByteArray fingerprint;
+  {
+    MachO fmt(":macho_main");
+    ASSERT_TRUE(fmt.parse());
+    auto *object = fmt.object(0);
+    ASSERT_NE(object, nullptr);
+    fingerprint = fmt.fingerprint();
+    ASSERT_TRUE(cache->store(fingerprint, 0, *object));
+  }
+
+  MachO fmt(":macho_main");
+  fmt.setCache(cache);
+  ASSERT_TRUE(fmt.parse());
+  EXPECT_EQ(fmt.fingerprint(), fingerprint);
+  auto *object = fmt.object(0);
+  ASSERT_NE(object, nullptr);
+  EXPECT_FALSE(object->sections().isEmpty());
+}
+
+TEST(AnalysisCache, evict)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  AnalysisCache cache(dir.path(), 250);
+  EXPECT_EQ(cache.maxSize(), 250);
+
+  // Files of 100 bytes used a minute apart, where "a" is the least recently used.
+  const auto now = QDateTime::currentDateTime();
+  int minutes = 3;
+  for (const auto *name : {"a", "b", "c"}) {
+    QFile f(cache.path(name, 0));
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+    f.write(QByteArray(100, 'x'));
+    ASSERT_TRUE(f.setFileTime(now.addSecs(-60 * minutes--), QFileDevice::FileModificationTime));
+  }
+
+  cache.evict();
+  EXPECT_FALSE(cache.contains("a", 0));
+  EXPECT_TRUE(cache.contains("b", 0));
+  EXPECT_TRUE(cache.contains("c", 0));
+}
+
+TEST(AnalysisCache, storeEvicts)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  MachO fmt(":macho_main");
+  ASSERT_TRUE(fmt.parse());
+  auto *object = fmt.object(0);
+  ASSERT_NE(object, nullptr);
+
+  // Too small for anything.
+  AnalysisCache cache(dir.path(), 1);
+  EXPECT_TRUE(cache.store(fmt.fingerprint(), 0, *object));
+  EXPECT_FALSE(cache.contains(fmt.fingerprint(), 0));
+}
@@ -1,7 +1,12 @@
 #include "gtest/gtest.h"
 
+#include "testutils.h"
+
 #include "BinaryObject.h"
 #include "Constants.h"
+#include "Disassembler.h"
+#include "MappedFile.h"
+#include "Util.h"
 using namespace dispar;
 
 TEST(BinaryObject, instantiate)
@@ -165,3 +170,134 @@ TEST(BinaryObject, cpuTypeX8664SystemBits64)
   EXPECT_EQ(b.cpuType(), CpuType::X86_64);
   EXPECT_EQ(b.systemBits(), 64);
 }
+
+TEST(BinaryObject, reuseAnalysis)
+{
+  BinaryObject previous(CpuType::X86_64);
+  Disassembler disasm(previous);
+  ASSERT_TRUE(disasm.valid());
+
+  const QList<QByteArray> oldData{"\x90\x90", "\x90\x90\x90", "abc"};
+  for (int i = 0; i < oldData.size(); i++) {
+    auto section = std::make_unique<Section>(Section::Type::TEXT, QString("sec%1").arg(i), 0,
+                                             oldData[i].size());
+    section->setData(oldData[i]);
+    section->setDisassembly(disasm.disassemble(oldData[i]));
+    (void) section->hash();
+    previous.addSection(std::move(section));
+  }
+  previous.setDemangledNames({{"__Z3foov", "foo()"}});
+
+  // Same first section, changed second section, and a new one.
+  BinaryObject object(CpuType::X86_64);
+  const QList<QByteArray> newData{"\x90\x90", "\xc3\x90\x90", "def", "xyz"};
+  for (int i = 0; i < newData.size(); i++) {
+    auto section = std::make_unique<Section>(Section::Type::TEXT, QString("sec%1").arg(i), 0,
+                                             newData[i].size());
+    section->setData(newData[i]);
+    object.addSection(std::move(section));
+  }
+
+  const auto sections = object.sections();
+  const auto changed = object.reuseAnalysis(previous);
+  EXPECT_EQ(changed, sections.mid(1));
+
+  ASSERT_NE(sections[0]->disassembly(), nullptr);
+  EXPECT_EQ(sections[0]->disassembly()->count(), std::size_t(2));
+  EXPECT_EQ(previous.sections()[0]->disassembly(), nullptr);
+
+  EXPECT_EQ(sections[1]->disassembly(), nullptr);
+  EXPECT_NE(previous.sections()[1]->disassembly(), nullptr);
+
+  EXPECT_EQ(object.demangledNames(), previous.demangledNames());
+}
+
+TEST(BinaryObject, reuseAnalysisModified)
+{
+  auto file = tempFile("\x90\x90\x90");
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+
+  // Mapped sections are hashed as in the file even when modified, but the disassembly is of the
+  // modified data.
+  BinaryObject previous(CpuType::X86_64);
+  Disassembler disasm(previous);
+  ASSERT_TRUE(disasm.valid());
+  auto section = std::make_unique<Section>(Section::Type::TEXT, "sec", 0, 3);
+  section->mapData(mapping);
+  section->setSubData("\xc3", 0);
+  section->setDisassembly(disasm.disassemble(section->data()));
+  previous.addSection(std::move(section));
+
+  BinaryObject object(CpuType::X86_64);
+  section = std::make_unique<Section>(Section::Type::TEXT, "sec", 0, 3);
+  section->mapData(mapping);
+  object.addSection(std::move(section));
+
+  const auto changed = object.reuseAnalysis(previous);
+  EXPECT_EQ(changed, object.sections());
+  EXPECT_EQ(object.sections()[0]->disassembly(), nullptr);
+}
+
+TEST(BinaryObject, reuseAnalysisWithoutDisassembly)
+{
+  BinaryObject previous(CpuType::X86_64);
+  auto section = std::make_unique<Section>(Section::Type::CSTRING, "sec", 0, 3);
+  section->setData("abc");
+  previous.addSection(std::move(section));
+
+  BinaryObject object(CpuType::X86_64);
+  section = std::make_unique<Section>(Section::Type::CSTRING, "sec", 0, 3);
+  section->setData("abc");
+  object.addSection(std::move(section));
+
+  // Nothing to reuse, so it isn't even hashed.
+  const auto changed = object.reuseAnalysis(previous);
+  EXPECT_EQ(changed, object.sections());
+}
+
+TEST(BinaryObject, functionStarts)
+{
+  BinaryObject object;
+  EXPECT_TRUE(object.functionStarts().empty());
+  EXPECT_FALSE(object.functionStart(0x1000));
+
+  object.setFunctionStarts({0x1020, 0x1000, 0x1010, 0x1020});
+  EXPECT_EQ(object.functionStarts(), (std::vector<quint64>{0x1000, 0x1010, 0x1020}));
+
+  EXPECT_FALSE(object.functionStart(0xfff));
+  EXPECT_EQ(object.functionStart(0x1000), quint64(0x1000));
+  EXPECT_EQ(object.functionStart(0x100f), quint64(0x1000));
+  EXPECT_EQ(object.functionStart(0x1010), quint64(0x1010));
+  EXPECT_EQ(object.functionStart(0x2000), quint64(0x1020));
+}
+
+// Demangling doesn't work on Windows right now..
+#ifndef WIN32
+TEST(BinaryObject, demangleSymbols)
+{
+  BinaryObject object;
+
+  SymbolTable symbols;
+  symbols.addSymbol(SymbolEntry(0, 0x1000, "__ZSt9terminatev"));
+  symbols.addSymbol(SymbolEntry(1, 0x1010, "__ZdlPv"));
+  symbols.addSymbol(SymbolEntry(2, 0x1020));
+  object.setSymbolTable(symbols);
+
+  SymbolTable dynSymbols;
+  dynSymbols.addSymbol(SymbolEntry(0, 0x1000, "__ZSt9terminatev"));
+  object.setDynSymbolTable(dynSymbols);
+
+  // Names known from before are kept.
+  object.setDemangledNames({{"__ZdlPv", "delete"}});
+
+  object.demangleSymbols();
+  const auto &names = object.demangledNames();
+  EXPECT_EQ(names.size(), 2);
+  EXPECT_EQ(names.value("__ZSt9terminatev"), QString("std::terminate()"));
+  EXPECT_EQ(names.value("__ZdlPv"), QString("delete"));
+
+  EXPECT_EQ(object.demangledName("__ZdlPv"), QString("delete"));
+  EXPECT_EQ(object.demangledName("__Znam"), Util::demangle("__Znam"));
+}
+#endif
@@ -119,3 +119,56 @@ TEST(CStringReader, dataWithConsecutiveNullBytes)
     EXPECT_EQ(strings[3], "_Ox3496");
   }
 }
+
+TEST(CStringReader, offsetAfterConsecutiveNullBytes)
+{
+  const QByteArray data("\0\0one\0\0\0two\0", 12);
+  CStringReader reader(data);
+  ASSERT_TRUE(reader.next());
+  EXPECT_EQ(reader.string(), "one");
+  EXPECT_EQ(reader.offset(), static_cast<quint64>(2));
+  ASSERT_TRUE(reader.next());
+  EXPECT_EQ(reader.string(), "two");
+  EXPECT_EQ(reader.offset(), static_cast<quint64>(8));
+  ASSERT_FALSE(reader.next());
+  ASSERT_FALSE(reader.next());
+}
+
+TEST(CStringReader, scan)
+{
+  const QByteArray data("\0one\0\0two\0three", 15);
+  const auto entries = CStringReader::scan(data);
+  ASSERT_EQ(entries.size(), std::size_t(3));
+  EXPECT_EQ(entries[0], (CStringReader::Entry{1, 3}));
+  EXPECT_EQ(entries[1], (CStringReader::Entry{6, 3}));
+  EXPECT_EQ(entries[2], (CStringReader::Entry{10, 5}));
+  EXPECT_EQ(CStringReader::string(data, entries[2]), "three");
+
+  EXPECT_TRUE(CStringReader::scan(QByteArray()).empty());
+  EXPECT_TRUE(CStringReader::scan(QByteArray(10, '\0')).empty());
+}
+
+TEST(CStringReader, scanChunks)
+{
+  // Large enough to be split into chunks, with strings of varying lengths and runs of null bytes.
+  QByteArray data;
+  int n = 0;
+  while (data.size() < 8 * CStringReader::minChunkSize) {
+    data.append(QByteArray(n % 7 + 1, 'a' + n % 26));
+    data.append(QByteArray(n % 3 + 1, '\0'));
+    n++;
+  }
+  data.append("last");
+
+  CStringReader reader(data);
+  std::vector<CStringReader::Entry> expected;
+  while (reader.next()) {
+    expected.push_back({static_cast<quint32>(reader.offset()),
+                        static_cast<quint32>(reader.string().size())});
+  }
+  ASSERT_EQ(expected.size(), std::size_t(n + 1));
+
+  const auto entries = CStringReader::scan(data);
+  ASSERT_EQ(entries.size(), expected.size());
+  EXPECT_TRUE(entries == expected);
+}
@@ -2,10 +2,13 @@
 
 #include "testutils.h"
 
+#include <QThread>
+
 #include "BinaryObject.h"
 #include "Constants.h"
 #include "CpuType.h"
 #include "Disassembler.h"
+#include "DisassemblerPool.h"
 using namespace dispar;
 
 TEST(Disassembler, instantiate)
@@ -45,15 +48,13 @@ TEST(Disassembler, disassembleData_Intel_32_x86)
   ASSERT_NE(res, nullptr);
   EXPECT_EQ(res->count(), std::size_t(2));
 
-  auto *instr = res->instructions(0);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("dec")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("eax")) << instr->op_str;
+  auto instr = res->instruction(0);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("dec")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("eax")) << instr.operands;
 
-  instr = res->instructions(1);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("sub")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("esp, 0x70")) << instr->op_str;
+  instr = res->instruction(1);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("sub")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("esp, 0x70")) << instr.operands;
 }
 
 TEST(Disassembler, disassembleData_Intel_64_x86)
@@ -70,10 +71,9 @@ TEST(Disassembler, disassembleData_Intel_64_x86)
   ASSERT_NE(res, nullptr);
   EXPECT_EQ(res->count(), std::size_t(1));
 
-  auto *instr = res->instructions(0);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("sub")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("rsp, 0x70")) << instr->op_str;
+  auto instr = res->instruction(0);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("sub")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("rsp, 0x70")) << instr.operands;
 }
 
 TEST(Disassembler, disassembleData_IntelMasm_32_x86)
@@ -91,15 +91,13 @@ TEST(Disassembler, disassembleData_IntelMasm_32_x86)
   ASSERT_NE(res, nullptr);
   EXPECT_EQ(res->count(), std::size_t(2));
 
-  auto *instr = res->instructions(0);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("dec")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("eax")) << instr->op_str;
+  auto instr = res->instruction(0);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("dec")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("eax")) << instr.operands;
 
-  instr = res->instructions(1);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("sub")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("esp, 70h")) << instr->op_str;
+  instr = res->instruction(1);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("sub")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("esp, 70h")) << instr.operands;
 }
 
 TEST(Disassembler, disassembleData_IntelMasm_64_x86)
@@ -116,10 +114,9 @@ TEST(Disassembler, disassembleData_IntelMasm_64_x86)
   ASSERT_NE(res, nullptr);
   EXPECT_EQ(res->count(), std::size_t(1));
 
-  auto *instr = res->instructions(0);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("sub")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("rsp, 70h")) << instr->op_str;
+  auto instr = res->instruction(0);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("sub")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("rsp, 70h")) << instr.operands;
 }
 
 TEST(Disassembler, disassembleData_Att_32_x86)
@@ -137,15 +134,13 @@ TEST(Disassembler, disassembleData_Att_32_x86)
   ASSERT_NE(res, nullptr);
   EXPECT_EQ(res->count(), std::size_t(2));
 
-  auto *instr = res->instructions(0);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("decl")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("%eax")) << instr->op_str;
+  auto instr = res->instruction(0);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("decl")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("%eax")) << instr.operands;
 
-  instr = res->instructions(1);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("subl")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("$0x70, %esp")) << instr->op_str;
+  instr = res->instruction(1);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("subl")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("$0x70, %esp")) << instr.operands;
 }
 
 TEST(Disassembler, disassembleData_Att_64_x86)
@@ -162,10 +157,9 @@ TEST(Disassembler, disassembleData_Att_64_x86)
   ASSERT_NE(res, nullptr);
   EXPECT_EQ(res->count(), std::size_t(1));
 
-  auto *instr = res->instructions(0);
-  ASSERT_NE(instr, nullptr);
-  EXPECT_EQ(std::string(instr->mnemonic), std::string("subq")) << instr->mnemonic;
-  EXPECT_EQ(std::string(instr->op_str), std::string("$0x70, %rsp")) << instr->op_str;
+  auto instr = res->instruction(0);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("subq")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("$0x70, %rsp")) << instr.operands;
 }
 
 TEST(Disassembler, disassembleNoData)
@@ -189,9 +183,8 @@ TEST(Disassembler, disassembleText)
   ASSERT_EQ(res->count(), std::size_t(3));
 
   for (std::size_t i = 0; i < res->count(); i++) {
-    auto *instr = res->instructions(i);
-    ASSERT_NE(instr, nullptr);
-    EXPECT_EQ(std::string(instr->mnemonic), std::string("nop")) << instr->mnemonic;
+    auto instr = res->instruction(i);
+      EXPECT_EQ(std::string(instr.mnemonic), std::string("nop")) << instr.mnemonic;
   }
 }
 
@@ -216,3 +209,330 @@ TEST(Disassembler, resultToString)
 2b: sub esp, 0x70)***");
   EXPECT_EQ(expected2, str) << str;
 }
+
+TEST(Disassembler, resultInstruction)
+{
+  auto obj = std::make_unique<BinaryObject>();
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  // dec eax
+  // sub esp, 0x70
+  // nop
+  auto res = dis.disassemble(QString("48 83 EC 70 90"), 0x1000);
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(res->count(), std::size_t(3));
+  EXPECT_EQ(res->baseAddress(), quint64(0x1000));
+
+  const auto instr = res->instruction(1);
+  EXPECT_EQ(instr.address, quint64(0x1001));
+  EXPECT_EQ(res->offset(1), quint32(1));
+  ASSERT_EQ(instr.size, 3);
+  EXPECT_EQ(QByteArray(reinterpret_cast<const char *>(instr.bytes), instr.size), // NOLINT
+            QByteArray("\x83\xec\x70"));
+
+  const auto nop = res->instruction(2);
+  EXPECT_EQ(nop.address, quint64(0x1004));
+  EXPECT_EQ(std::string(nop.mnemonic), std::string("nop"));
+  EXPECT_EQ(std::string(nop.operands), std::string());
+}
+
+TEST(Disassembler, resultMemoryUsage)
+{
+  auto obj = std::make_unique<BinaryObject>();
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  QByteArray code;
+  for (int i = 0; i < 1000; i++) {
+    code.append("\x83\xec\x70", 3); // sub esp, 0x70
+  }
+
+  auto res = dis.disassemble(code);
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(res->count(), std::size_t(1000));
+
+  // Far less than the size of all cs_insn.
+  EXPECT_LT(res->memoryUsage() * 8, res->count() * sizeof(cs_insn));
+}
+
+TEST(Disassembler, disassembleConcurrently)
+{
+  auto obj = std::make_unique<BinaryObject>(CpuType::X86_64, CpuType::I386,
+                                            Constants::Endianness::Little, 64);
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  // Functions of "sub rsp, 0x70; ret" at every 5 bytes.
+  QByteArray code;
+  std::vector<quint64> boundaries;
+  for (int i = 0; i < 100000; i++) {
+    boundaries.push_back(code.size());
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+
+  const auto expected = dis.disassemble(code, 0x1000);
+  ASSERT_NE(expected, nullptr);
+
+  const auto res = dis.disassembleConcurrently(code, boundaries, 0x1000);
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(res->count(), expected->count());
+  EXPECT_EQ(res->toString(), expected->toString());
+}
+
+TEST(Disassembler, disassembleConcurrentlyPooled)
+{
+  auto obj = std::make_unique<BinaryObject>(CpuType::X86_64, CpuType::I386,
+                                            Constants::Endianness::Little, 64);
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  QByteArray code;
+  std::vector<quint64> boundaries;
+  for (int i = 0; i < 100000; i++) {
+    boundaries.push_back(code.size());
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+
+  const auto expected = dis.disassemble(code, 0x1000);
+  ASSERT_NE(expected, nullptr);
+
+  // Disassemblers of the workers are returned to the pool.
+  DisassemblerPool pool;
+  const auto res = dis.disassembleConcurrently(code, boundaries, pool, *obj, 0x1000);
+  ASSERT_NE(res, nullptr);
+  EXPECT_EQ(res->toString(), expected->toString());
+  if (QThread::idealThreadCount() > 1) {
+    EXPECT_GT(pool.idle(), 0);
+  }
+}
+
+TEST(Disassembler, disassembleConcurrentlyMisaligned)
+{
+  auto obj = std::make_unique<BinaryObject>(CpuType::X86_64, CpuType::I386,
+                                            Constants::Endianness::Little, 64);
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  // Boundaries in the middle of "sub rsp, 0x70" such that chunks don't decode up to the next.
+  QByteArray code;
+  std::vector<quint64> boundaries;
+  for (int i = 0; i < 100000; i++) {
+    boundaries.push_back(code.size() + 2);
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+
+  const auto expected = dis.disassemble(code, 0x1000);
+  ASSERT_NE(expected, nullptr);
+
+  const auto res = dis.disassembleConcurrently(code, boundaries, 0x1000);
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(res->count(), expected->count());
+  EXPECT_EQ(res->endAddress(), expected->endAddress());
+  EXPECT_EQ(res->toString(), expected->toString());
+}
+
+TEST(Disassembler, disassembleConcurrentlyWithoutBoundaries)
+{
+  auto obj = std::make_unique<BinaryObject>();
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  auto res = dis.disassembleConcurrently(QByteArray("\x90\x90\x90"), {});
+  ASSERT_NE(res, nullptr);
+  EXPECT_EQ(res->count(), std::size_t(3));
+}
+
+TEST(Disassembler, disassembleCallback)
+{
+  auto obj = std::make_unique<BinaryObject>();
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  // dec eax
+  // sub esp, 0x70
+  QStringList lines;
+  const auto count =
+    dis.disassemble(QByteArray("\x48\x83\xec\x70"), 0x2a, [&lines](const auto &instr) {
+      lines << QString("%1: %2 %3")
+                 .arg(instr.address, 0, 16)
+                 .arg(instr.mnemonic)
+                 .arg(instr.operands);
+      return true;
+    });
+  EXPECT_EQ(count, std::size_t(2));
+  EXPECT_EQ(lines, QStringList({"2a: dec eax", "2b: sub esp, 0x70"}));
+}
+
+TEST(Disassembler, disassembleCallbackStop)
+{
+  auto obj = std::make_unique<BinaryObject>();
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  std::size_t visited = 0;
+  const auto count = dis.disassemble(QByteArray("\x90\x90\x90"), 0, [&visited](const auto &) {
+    visited++;
+    return visited < 2;
+  });
+  EXPECT_EQ(count, std::size_t(2));
+  EXPECT_EQ(visited, std::size_t(2));
+}
+
+namespace {
+
+/// Functions of "sub rsp, 0x70; ret" at every 5 bytes.
+QByteArray functions(int count)
+{
+  QByteArray code;
+  for (int i = 0; i < count; i++) {
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+  return code;
+}
+
+} // namespace
+
+TEST(Disassembler, redisassemble)
+{
+  auto obj = std::make_unique<BinaryObject>(CpuType::X86_64, CpuType::I386,
+                                            Constants::Endianness::Little, 64);
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  auto code = functions(1000);
+  auto res = dis.disassemble(code, 0x1000);
+  ASSERT_NE(res, nullptr);
+  EXPECT_FALSE(res->isPatched());
+
+  // Same length: nop x5 instead of one function.
+  const QByteArray nops(5, '\x90');
+  res->patch(0x1000 + 2000, nops);
+  code.replace(2000, nops.size(), nops);
+  EXPECT_TRUE(res->isPatched());
+
+  // Different length: "rex.w nop; in al, dx; jo" until the next function lines up again.
+  res->patch(0x1000 + 3001, QByteArray("\x90", 1));
+  code[3001] = '\x90';
+
+  dis.redisassemble(*res);
+  EXPECT_FALSE(res->isPatched());
+
+  const auto expected = dis.disassemble(code, 0x1000);
+  ASSERT_NE(expected, nullptr);
+  ASSERT_EQ(res->count(), expected->count());
+  EXPECT_EQ(res->toString(), expected->toString());
+
+  const auto ranges = res->takeRedecodedRanges();
+  ASSERT_EQ(ranges.size(), std::size_t(2));
+  EXPECT_EQ(ranges[0], Disassembler::Result::Range(0x1000 + 2000, 0x1000 + 2005));
+  EXPECT_EQ(ranges[1], Disassembler::Result::Range(0x1000 + 3000, 0x1000 + 3005));
+  EXPECT_TRUE(res->takeRedecodedRanges().empty());
+}
+
+TEST(Disassembler, redisassembleAdjacentPatches)
+{
+  auto obj = std::make_unique<BinaryObject>(CpuType::X86_64, CpuType::I386,
+                                            Constants::Endianness::Little, 64);
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  auto code = functions(100);
+  auto res = dis.disassemble(code);
+  ASSERT_NE(res, nullptr);
+
+  // Overlapping patches are merged, and a patch is included when decoding runs into it: the
+  // instruction at 56 is 7 bytes long and covers the one at 57.
+  for (int pos : {52, 50, 57}) {
+    res->patch(pos, QByteArray(4, '\x90'));
+    code.replace(pos, 4, QByteArray(4, '\x90'));
+  }
+  dis.redisassemble(*res);
+
+  const auto expected = dis.disassemble(code);
+  ASSERT_NE(expected, nullptr);
+  EXPECT_EQ(res->toString(), expected->toString());
+
+  const auto ranges = res->takeRedecodedRanges();
+  ASSERT_EQ(ranges.size(), std::size_t(1));
+  EXPECT_EQ(ranges[0], Disassembler::Result::Range(50, 65));
+}
+
+TEST(Disassembler, redisassembleInvalid)
+{
+  auto obj = std::make_unique<BinaryObject>(CpuType::X86_64, CpuType::I386,
+                                            Constants::Endianness::Little, 64);
+  Disassembler dis(*obj.get());
+  ASSERT_TRUE(dis.valid());
+
+  auto res = dis.disassemble(functions(1000));
+  ASSERT_NE(res, nullptr);
+
+  // Push es is invalid in 64-bit mode, so the sub is left out but the following ret is kept.
+  res->patch(2000, QByteArray("\x06", 1));
+  dis.redisassemble(*res);
+  EXPECT_EQ(res->count(), std::size_t(1999));
+
+  const auto pos = res->position(2000);
+  EXPECT_EQ(res->instruction(pos).address, quint64(2004));
+  EXPECT_EQ(std::string(res->instruction(pos).mnemonic), "ret");
+  EXPECT_EQ(res->instruction(pos - 1).address, quint64(1999));
+
+  const auto ranges = res->takeRedecodedRanges();
+  ASSERT_EQ(ranges.size(), std::size_t(1));
+  EXPECT_EQ(ranges[0], Disassembler::Result::Range(2000, 2004));
+}
+
+TEST(Disassembler, setSyntax)
+{
+  auto obj = std::make_unique<BinaryObject>();
+  obj->setCpuType(CpuType::X86);
+
+  Disassembler dis(*obj.get(), Disassembler::Syntax::INTEL);
+  ASSERT_TRUE(dis.valid());
+
+  // dec eax
+  // sub esp, 0x70
+  auto res = dis.disassemble(QByteArray("\x48\x83\xec\x70"));
+  ASSERT_NE(res, nullptr);
+  EXPECT_EQ(res->syntax(), Disassembler::Syntax::INTEL);
+
+  ASSERT_TRUE(dis.setSyntax(Disassembler::Syntax::ATT));
+  EXPECT_EQ(dis.syntax(), Disassembler::Syntax::ATT);
+
+  // Printed again from the bytes while the result keeps its text.
+  auto instr = dis.instruction(*res, 1);
+  EXPECT_EQ(instr.address, quint64(1));
+  EXPECT_EQ(instr.size, 3);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("subl")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("$0x70, %esp")) << instr.operands;
+  EXPECT_EQ(std::string(res->instruction(1).mnemonic), std::string("sub"));
+
+  // Patched instructions are decoded in the syntax of the result.
+  res->patch(0, QByteArray("\x40", 1));
+  dis.redisassemble(*res);
+  EXPECT_EQ(res->toString(), QString("0: inc eax\n1: sub esp, 0x70"));
+
+  EXPECT_EQ(dis.disassemble(QByteArray("\x48"))->syntax(), Disassembler::Syntax::ATT);
+}
+
+TEST(Disassembler, print)
+{
+  auto obj = std::make_unique<BinaryObject>();
+  obj->setCpuType(CpuType::X86);
+
+  Disassembler dis(*obj.get(), Disassembler::Syntax::INTEL);
+  ASSERT_TRUE(dis.valid());
+
+  // Only the first instruction is printed.
+  const unsigned char code[] = {0x83, 0xec, 0x70, 0x48};
+  auto instr = dis.print(code, sizeof(code), 0x2a);
+  EXPECT_EQ(instr.address, quint64(0x2a));
+  EXPECT_EQ(instr.size, 3);
+  EXPECT_EQ(std::string(instr.mnemonic), std::string("sub")) << instr.mnemonic;
+  EXPECT_EQ(std::string(instr.operands), std::string("esp, 0x70")) << instr.operands;
+
+  // Truncated.
+  instr = dis.print(code, 2, 0);
+  EXPECT_EQ(instr.size, 0);
+}
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include <QThread>
+
+#include <vector>
+
+#include "BinaryObject.h"
+#include "DisassemblerPool.h"
+using namespace dispar;
+
+TEST(DisassemblerPool, reuse)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  DisassemblerPool pool;
+  EXPECT_EQ(pool.idle(), 0);
+
+  const Disassembler *first = nullptr;
+  {
+    const auto dis = pool.acquire(object, Disassembler::Syntax::INTEL);
+    ASSERT_NE(dis, nullptr);
+    ASSERT_TRUE(dis->valid());
+    first = dis.get();
+    EXPECT_EQ(pool.idle(), 0);
+  }
+  EXPECT_EQ(pool.idle(), 1);
+
+  const auto dis = pool.acquire(object, Disassembler::Syntax::INTEL);
+  EXPECT_EQ(dis.get(), first);
+  EXPECT_EQ(pool.idle(), 0);
+
+  // Other keys don't share disassemblers.
+  const auto att = pool.acquire(object, Disassembler::Syntax::ATT);
+  EXPECT_NE(att.get(), first);
+  EXPECT_EQ(att->syntax(), Disassembler::Syntax::ATT);
+
+  const BinaryObject object32(CpuType::X86);
+  const auto dis32 = pool.acquire(object32, Disassembler::Syntax::INTEL);
+  EXPECT_NE(dis32.get(), first);
+  ASSERT_NE(dis32->disassemble(QByteArray("\x48", 1)), nullptr);
+  EXPECT_EQ(std::string(dis32->disassemble(QByteArray("\x48", 1))->instruction(0).mnemonic),
+            std::string("dec"));
+}
+
+TEST(DisassemblerPool, changedSyntax)
+{
+  const BinaryObject object(CpuType::X86);
+  DisassemblerPool pool;
+
+  const Disassembler *first = nullptr;
+  {
+    const auto dis = pool.acquire(object, Disassembler::Syntax::INTEL);
+    first = dis.get();
+    ASSERT_TRUE(dis->setSyntax(Disassembler::Syntax::ATT));
+  }
+
+  // Returned under the syntax it had when released.
+  EXPECT_NE(pool.acquire(object, Disassembler::Syntax::INTEL).get(), first);
+  EXPECT_EQ(pool.acquire(object, Disassembler::Syntax::ATT).get(), first);
+}
+
+TEST(DisassemblerPool, maxIdle)
+{
+  const BinaryObject object(CpuType::X86);
+  DisassemblerPool pool(2);
+
+  {
+    std::vector<DisassemblerPool::Handle> handles;
+    for (int i = 0; i < 4; i++) {
+      handles.push_back(pool.acquire(object, Disassembler::Syntax::INTEL));
+    }
+  }
+  EXPECT_EQ(pool.idle(), 2);
+
+  pool.clear();
+  EXPECT_EQ(pool.idle(), 0);
+}
+
+TEST(DisassemblerPool, invalidNotKept)
+{
+  const BinaryObject object(CpuType::HPPA);
+  DisassemblerPool pool;
+
+  {
+    const auto dis = pool.acquire(object, Disassembler::Syntax::INTEL);
+    ASSERT_NE(dis, nullptr);
+    EXPECT_FALSE(dis->valid());
+  }
+  EXPECT_EQ(pool.idle(), 0);
+}
+
+TEST(DisassemblerPool, outlivesPool)
+{
+  const BinaryObject object(CpuType::X86);
+  auto pool = std::make_unique<DisassemblerPool>();
+  auto dis = pool->acquire(object, Disassembler::Syntax::INTEL);
+  pool.reset();
+
+  // Deleted when released since the pool is gone.
+  EXPECT_TRUE(dis->valid());
+  dis.reset();
+}
+
+TEST(DisassemblerPool, threads)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  DisassemblerPool pool(4);
+
+  std::vector<std::unique_ptr<QThread>> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back(QThread::create([&pool, &object] {
+      for (int j = 0; j < 100; j++) {
+        const auto dis = pool.acquire(object, Disassembler::Syntax::INTEL);
+        EXPECT_EQ(dis->disassemble(QByteArray("\x90\x90", 2), 0, [](const auto &) { return true; }),
+                  std::size_t(2));
+      }
+    }));
+    threads.back()->start();
+  }
+  for (auto &thread : threads) {
+    thread->wait();
+  }
+  EXPECT_GE(pool.idle(), 1);
+  EXPECT_LE(pool.idle(), 4);
+}
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "HexDump.h"
+using namespace dispar;
+
+TEST(HexDump, empty)
+{
+  HexDump dump(QByteArray(), 0x1000);
+  EXPECT_EQ(dump.text(), "1000: ");
+  ASSERT_EQ(dump.lines().size(), static_cast<size_t>(1));
+
+  const auto &line = dump.lines().front();
+  EXPECT_EQ(line.address, static_cast<quint64>(0x1000));
+  EXPECT_EQ(line.offset, static_cast<quint64>(0));
+  EXPECT_EQ(dump.line(line), "1000: ");
+  EXPECT_EQ(HexDump::textLength(0, 0x1000), dump.text().size());
+}
+
+TEST(HexDump, lines)
+{
+  QByteArray data;
+  for (int i = 32; i < 32 * 3 - 7; ++i) {
+    data.append(char(i));
+  }
+  HexDump dump(data, 0xFF0);
+  EXPECT_EQ(dump.text(), R"***(FF0: 20 21 22 23 24 25 26 27  28 29 2A 2B 2C 2D 2E 2F   .!"#$%&'()*+,-./
+1000: 30 31 32 33 34 35 36 37  38 39 3A 3B 3C 3D 3E 3F   0123456789:;<=>?
+1010: 40 41 42 43 44 45 46 47  48 49 4A 4B 4C 4D 4E 4F   @ABCDEFGHIJKLMNO
+1020: 50 51 52 53 54 55 56 57  58                        PQRSTUVWX)***")
+    << dump.text();
+
+  const auto texts = dump.text().split("\n");
+  const auto &lines = dump.lines();
+  ASSERT_EQ(lines.size(), static_cast<size_t>(texts.size()));
+  for (size_t i = 0; i < lines.size(); i++) {
+    EXPECT_EQ(lines[i].address, 0xFF0 + i * HexDump::bytesPerLine);
+    EXPECT_EQ(lines[i].offset, i * HexDump::bytesPerLine);
+    EXPECT_EQ(dump.line(lines[i]), texts[i]);
+  }
+  EXPECT_EQ(HexDump::textLength(data.size(), 0xFF0), dump.text().size());
+}
+
+TEST(HexDump, nonGraphical)
+{
+  HexDump dump(QByteArray("\x00 \x7F\x80\xFF", 5), 0);
+  EXPECT_EQ(dump.text(), "0: 00 20 7F 80 FF                                     .....")
+    << dump.text();
+}
+
+TEST(HexDump, chunks)
+{
+  // Enough lines to be rendered in several chunks.
+  const int size = HexDump::minChunkLines * HexDump::bytesPerLine * 3 + 5;
+  QByteArray data(size, 0);
+  for (int i = 0; i < size; i++) {
+    data[i] = char(i * 7);
+  }
+
+  const quint64 address = 0xFFF00;
+  HexDump dump(data, address);
+  const auto &lines = dump.lines();
+  ASSERT_EQ(lines.size(), static_cast<size_t>(size / HexDump::bytesPerLine + 1));
+
+  QString expected;
+  for (const auto &line : lines) {
+    const auto lineSize = std::min<int>(HexDump::bytesPerLine, size - int(line.offset));
+    QString text(HexDump::lineLength(line.address, lineSize), Qt::Uninitialized);
+    HexDump::writeLine(text.data(), line.address,
+                       reinterpret_cast<const uchar *>(data.constData()) + line.offset, lineSize);
+    EXPECT_EQ(dump.line(line), text);
+    if (!expected.isEmpty()) {
+      expected += "\n";
+    }
+    expected += text;
+  }
+  EXPECT_EQ(dump.text(), expected);
+  EXPECT_EQ(HexDump::textLength(size, address), dump.text().size());
+}
+
+TEST(HexDump, textLength)
+{
+  // Lines grow by a digit where addresses reach the next power of 16.
+  for (const quint64 address : {0x0ULL, 0x8ULL, 0xFF8ULL, 0xFFFF0ULL, 0xFFFFFFFFAULL}) {
+    for (const int size : {1, 15, 16, 17, 33, 1000}) {
+      const HexDump dump(QByteArray(size, 'a'), address);
+      EXPECT_EQ(HexDump::textLength(size, address), dump.text().size()) << address << size;
+    }
+  }
+}
+
+TEST(HexDump, tooLarge)
+{
+  // Too large data isn't rendered since the text couldn't be allocated.
+  EXPECT_GT(HexDump::textLength(std::numeric_limits<int>::max(), 0), HexDump::maxTextLength);
+  EXPECT_LE(HexDump::textLength(64 * 1024 * 1024, 0), HexDump::maxTextLength);
+
+  const HexDump dump(QByteArray(16, 0), 0);
+  EXPECT_FALSE(dump.isTooLarge());
+}
@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include "BinaryObject.h"
+#include "Disassembler.h"
+#include "InstructionIndex.h"
+#include "Section.h"
+#include "formats/MachO.h"
+using namespace dispar;
+
+TEST(InstructionIndex, boundaries)
+{
+  // push rbp; mov rbp, rsp; sub rsp, 0x70; ret
+  const QByteArray code("\x55\x48\x89\xe5\x48\x83\xec\x70\xc3", 9);
+  const InstructionIndex index(code, true);
+  EXPECT_EQ(index.size(), quint32(9));
+  EXPECT_EQ(index.count(), quint32(4));
+
+  for (quint32 offset : {0, 1, 4, 8}) {
+    EXPECT_TRUE(index.contains(offset)) << offset;
+  }
+  for (quint32 offset : {2, 3, 5, 6, 7, 9}) {
+    EXPECT_FALSE(index.contains(offset)) << offset;
+  }
+
+  EXPECT_EQ(index.boundaryAtOrBefore(0), quint32(0));
+  EXPECT_EQ(index.boundaryAtOrBefore(3), quint32(1));
+  EXPECT_EQ(index.boundaryAtOrBefore(100), quint32(8));
+  EXPECT_EQ(index.boundaryAtOrAfter(2), quint32(4));
+  EXPECT_EQ(index.boundaryAtOrAfter(8), quint32(8));
+  EXPECT_FALSE(index.boundaryAtOrAfter(9));
+
+  EXPECT_EQ(index.rank(0), quint32(0));
+  EXPECT_EQ(index.rank(4), quint32(2));
+  EXPECT_EQ(index.rank(5), quint32(3));
+  EXPECT_EQ(index.rank(100), quint32(4));
+}
+
+TEST(InstructionIndex, pages)
+{
+  // "sub rsp, 0x70; ret" crossing many pages and words.
+  QByteArray code;
+  for (int i = 0; i < 10000; i++) {
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+  const InstructionIndex index(code, true);
+  EXPECT_EQ(index.count(), quint32(20000));
+  EXPECT_GT(index.memoryUsage(), std::size_t(0));
+  EXPECT_LT(index.memoryUsage(), std::size_t(code.size()));
+
+  for (quint32 offset = 0; offset < index.size(); offset += 997) {
+    const auto before = *index.boundaryAtOrBefore(offset);
+    const auto start = offset - offset % 5;
+    EXPECT_EQ(before, offset % 5 < 4 ? start : start + 4) << offset;
+    EXPECT_EQ(index.rank(offset), start / 5 * 2 + (offset % 5 > 0 ? 1 : 0)) << offset;
+  }
+}
+
+TEST(InstructionIndex, skipsInvalid)
+{
+  // push es (invalid in 64-bit mode); ret
+  const InstructionIndex index(QByteArray("\x06\xc3", 2), true);
+  EXPECT_EQ(index.count(), quint32(1));
+  EXPECT_FALSE(index.contains(0));
+  EXPECT_TRUE(index.contains(1));
+  EXPECT_FALSE(index.boundaryAtOrBefore(0));
+}
+
+TEST(InstructionIndex, fromOffsets)
+{
+  // "sub rsp, 0x70; ret" crossing many pages and words.
+  QByteArray code;
+  for (int i = 0; i < 10000; i++) {
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+  const InstructionIndex swept(code, true);
+
+  std::vector<quint32> offsets;
+  for (quint32 offset = 0; offset < quint32(code.size()); offset += 5) {
+    offsets.push_back(offset);
+    offsets.push_back(offset + 4);
+  }
+
+  // Offsets outside the section are ignored.
+  offsets.push_back(quint32(code.size()));
+  offsets.push_back(quint32(code.size()) + 100);
+
+  const InstructionIndex index(quint32(code.size()), offsets);
+  EXPECT_EQ(index.size(), swept.size());
+  EXPECT_EQ(index.count(), swept.count());
+  for (quint32 offset = 0; offset < index.size(); offset += 997) {
+    EXPECT_EQ(index.contains(offset), swept.contains(offset)) << offset;
+    EXPECT_EQ(index.boundaryAtOrBefore(offset), swept.boundaryAtOrBefore(offset)) << offset;
+    EXPECT_EQ(index.rank(offset), swept.rank(offset)) << offset;
+  }
+}
+
+TEST(InstructionIndex, matchesCapstone)
+{
+  for (const auto &file : {":macho_main", ":macho_main_32", ":macho_main_32_64", ":macho_func",
+                           ":macho_lib.dylib", ":macho_main_objc", ":macho_strings"}) {
+    MachO fmt(file);
+    ASSERT_TRUE(fmt.parse()) << file;
+
+    for (auto *object : fmt.objects()) {
+      Disassembler dis(*object);
+      ASSERT_TRUE(dis.valid()) << file;
+
+      for (const auto *section :
+           object->sectionsByTypes({Section::Type::TEXT, Section::Type::SYMBOL_STUBS})) {
+        const auto &data = section->data();
+        const auto index = dis.index(data);
+        ASSERT_NE(index, nullptr);
+
+        // Every instruction decoded by capstone must start at a boundary with none in between.
+        quint32 count = 0, decodedEnd = 0;
+        dis.disassemble(data, 0, [&](const auto &instr) {
+          const auto offset = static_cast<quint32>(instr.address);
+          EXPECT_EQ(index->boundaryAtOrAfter(decodedEnd), offset)
+            << file << " " << section->toString() << offset;
+          count++;
+          decodedEnd = offset + static_cast<quint32>(instr.size);
+          return true;
+        });
+        EXPECT_EQ(index->rank(decodedEnd), count) << file << " " << section->toString();
+      }
+    }
+  }
+}
+
+TEST(InstructionIndex, disassembleRange)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  Disassembler dis(object);
+  ASSERT_TRUE(dis.valid());
+
+  // Functions of "sub rsp, 0x70; ret" (5 bytes each).
+  QByteArray code;
+  for (int i = 0; i < 1000; i++) {
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+  const auto index = dis.index(code);
+  ASSERT_NE(index, nullptr);
+
+  // Starting in the middle of an instruction includes it.
+  auto res = dis.disassemble(code, *index, 2002, 8, 0x1000);
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(res->count(), std::size_t(4));
+  EXPECT_EQ(res->instruction(0).address, quint64(0x1000 + 2000));
+  EXPECT_EQ(std::string(res->instruction(0).mnemonic), "sub");
+  EXPECT_EQ(res->instruction(3).address, quint64(0x1000 + 2009));
+  EXPECT_EQ(std::string(res->instruction(3).mnemonic), "ret");
+
+  // Same as decoding everything.
+  const auto full = dis.disassemble(code, 0x1000);
+  ASSERT_NE(full, nullptr);
+  res = dis.disassemble(code, *index, 0, code.size(), 0x1000);
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(res->count(), full->count());
+  EXPECT_EQ(res->toString(), full->toString());
+
+  EXPECT_EQ(dis.disassemble(code, *index, code.size(), 10), nullptr);
+}
+
+TEST(InstructionIndex, disassembleRangeSkipsInvalid)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  Disassembler dis(object);
+  ASSERT_TRUE(dis.valid());
+
+  // ret; push es (invalid in 64-bit mode); ret
+  const QByteArray code("\xc3\x06\xc3", 3);
+  const auto index = dis.index(code);
+  ASSERT_NE(index, nullptr);
+
+  const auto res = dis.disassemble(code, *index, 0, code.size());
+  ASSERT_NE(res, nullptr);
+  ASSERT_EQ(res->count(), std::size_t(2));
+  EXPECT_EQ(res->instruction(0).address, quint64(0));
+  EXPECT_EQ(res->instruction(1).address, quint64(2));
+}
@@ -0,0 +1,202 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include "BinaryObject.h"
+#include "Disassembler.h"
+#include "DisassemblerPool.h"
+#include "LazyDisassembly.h"
+#include "Section.h"
+using namespace dispar;
+
+namespace {
+
+/// Functions of "sub rsp, 0x70; ret" (5 bytes each).
+std::unique_ptr<Section> codeSection(int functions)
+{
+  QByteArray code;
+  for (int i = 0; i < functions; i++) {
+    code.append("\x48\x83\xec\x70\xc3", 5);
+  }
+  auto section = std::make_unique<Section>(Section::Type::TEXT, "__text", 0, code.size());
+  section->setData(code);
+  return section;
+}
+
+} // namespace
+
+TEST(LazyDisassembly, window)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  const auto section = codeSection(100);
+
+  DisassemblerPool pool;
+  LazyDisassembly lazy(pool, object, *section, Disassembler::Syntax::INTEL, 50);
+  ASSERT_TRUE(lazy.valid());
+  EXPECT_EQ(lazy.cachedWindows(), 0);
+
+  auto window = lazy.window(0);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(0));
+  EXPECT_EQ(window->endAddress(), quint64(50));
+  EXPECT_EQ(window->count(), std::size_t(20));
+  EXPECT_EQ(std::string(window->instruction(0).mnemonic), std::string("sub"));
+  EXPECT_EQ(std::string(window->instruction(1).mnemonic), std::string("ret"));
+  EXPECT_EQ(lazy.cachedWindows(), 1);
+
+  // Same window is returned from the cache.
+  EXPECT_EQ(lazy.window(49), window);
+  EXPECT_EQ(lazy.cachedWindows(), 1);
+
+  // The window after a known boundary is decoded from it.
+  window = lazy.window(60);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(50));
+  EXPECT_EQ(lazy.cachedWindows(), 2);
+
+  // Offsets far from known boundaries are decoded from where the instruction index says.
+  window = lazy.window(262);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(260));
+  EXPECT_EQ(lazy.cachedWindows(), 3);
+
+  EXPECT_EQ(lazy.window(500), nullptr);
+}
+
+TEST(LazyDisassembly, matchesFullDisassembly)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  const auto section = codeSection(1000);
+
+  Disassembler dis(object);
+  const auto full = dis.disassemble(section->data());
+  ASSERT_NE(full, nullptr);
+
+  // Window size that doesn't align with instructions.
+  DisassemblerPool pool;
+  LazyDisassembly lazy(pool, object, *section, Disassembler::Syntax::INTEL, 63, 2);
+
+  std::size_t i = 0;
+  for (auto window = lazy.window(0); window; window = lazy.next(*window)) {
+    for (std::size_t j = 0; j < window->count(); j++, i++) {
+      ASSERT_LT(i, full->count());
+      EXPECT_EQ(window->instruction(j).address, full->instruction(i).address);
+      EXPECT_EQ(window->instruction(j).size, full->instruction(i).size);
+    }
+  }
+  EXPECT_EQ(i, full->count());
+
+  // Only the most recently used windows are kept.
+  EXPECT_EQ(lazy.cachedWindows(), 2);
+
+  // Evicted windows are decoded the same again.
+  const auto window = lazy.window(0);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(0));
+  EXPECT_EQ(window->endAddress(), quint64(64));
+}
+
+TEST(LazyDisassembly, boundaries)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  const auto section = codeSection(100);
+
+  DisassemblerPool pool;
+  LazyDisassembly lazy(pool, object, *section, Disassembler::Syntax::INTEL, 50);
+  lazy.addBoundaries({400});
+
+  // Decoding starts at the known boundary instead of the start of the section.
+  const auto window = lazy.window(420);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(400));
+  EXPECT_EQ(lazy.cachedWindows(), 1);
+
+  // Windows before the boundary stop at it.
+  const auto before = lazy.window(399);
+  ASSERT_NE(before, nullptr);
+  EXPECT_LE(before->endAddress(), quint64(400));
+}
+
+TEST(LazyDisassembly, misalignedBoundary)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  const auto section = codeSection(100);
+
+  // In the middle of "sub rsp, 0x70" at 400.
+  DisassemblerPool pool;
+  LazyDisassembly lazy(pool, object, *section, Disassembler::Syntax::INTEL, 50);
+  lazy.addBoundaries({402});
+  auto window = lazy.window(420);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(402));
+
+  // The window before ends inside it, so it is dropped instead of overlapping.
+  const auto before = lazy.window(399);
+  ASSERT_NE(before, nullptr);
+  EXPECT_EQ(before->endAddress(), quint64(404));
+  EXPECT_EQ(lazy.cachedWindows(), 1);
+
+  window = lazy.window(420);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(404));
+  EXPECT_EQ(std::string(window->instruction(0).mnemonic), std::string("ret"));
+}
+
+TEST(LazyDisassembly, cachedInstructionOffsets)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  const auto section = codeSection(100);
+
+  // Only every other function is known, so the index can't be the result of a sweep.
+  std::vector<quint32> offsets;
+  for (quint32 offset = 0; offset < 500; offset += 10) {
+    offsets.push_back(offset);
+  }
+  section->setInstructionOffsets(offsets);
+
+  DisassemblerPool pool;
+  LazyDisassembly lazy(pool, object, *section, Disassembler::Syntax::INTEL, 50);
+  ASSERT_TRUE(lazy.valid());
+
+  const auto window = lazy.window(267);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(window->baseAddress(), quint64(260));
+}
+
+TEST(LazyDisassembly, suits)
+{
+  auto section = codeSection(100);
+  EXPECT_FALSE(LazyDisassembly::suits(*section));
+
+  section->setInstructionOffsets({0, 4});
+  EXPECT_TRUE(LazyDisassembly::suits(*section));
+
+  Section data(Section::Type::CSTRING, "__cstring", 0, 100);
+  data.setInstructionOffsets({0, 4});
+  EXPECT_FALSE(LazyDisassembly::suits(data));
+}
+
+TEST(LazyDisassembly, setSyntax)
+{
+  const BinaryObject object(CpuType::X86_64, CpuType::I386, Constants::Endianness::Little, 64);
+  const auto section = codeSection(100);
+
+  DisassemblerPool pool;
+  LazyDisassembly lazy(pool, object, *section, Disassembler::Syntax::INTEL, 50);
+  ASSERT_TRUE(lazy.valid());
+
+  const auto intel = lazy.window(0);
+  ASSERT_NE(intel, nullptr);
+  EXPECT_EQ(intel->syntax(), Disassembler::Syntax::INTEL);
+  EXPECT_EQ(std::string(intel->instruction(0).mnemonic), std::string("sub"));
+
+  lazy.setSyntax(Disassembler::Syntax::ATT);
+  EXPECT_EQ(lazy.cachedWindows(), 0);
+
+  // Same extent as before.
+  const auto att = lazy.window(0);
+  ASSERT_NE(att, nullptr);
+  EXPECT_EQ(att->syntax(), Disassembler::Syntax::ATT);
+  EXPECT_EQ(att->endAddress(), intel->endAddress());
+  EXPECT_EQ(std::string(att->instruction(0).mnemonic), std::string("subq"));
+}
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include "MappedFile.h"
+#include "Reader.h"
+using namespace dispar;
+
+TEST(MappedFile, open)
+{
+  EXPECT_EQ(MappedFile::open("_/something_that_does_not_exist"), nullptr);
+
+  const QByteArray data("hello there, man");
+  auto file = tempFile(data);
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+  EXPECT_TRUE(mapping->valid());
+  EXPECT_TRUE(mapping->isMapped());
+  EXPECT_EQ(mapping->fileName(), file->fileName());
+  EXPECT_EQ(mapping->size(), data.size());
+  EXPECT_EQ(QByteArray(mapping->data(), mapping->size()), data);
+}
+
+TEST(MappedFile, openEmpty)
+{
+  auto file = tempFile();
+  ASSERT_TRUE(file->open(QIODevice::WriteOnly));
+  file->close();
+
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+  EXPECT_EQ(mapping->size(), 0);
+  EXPECT_TRUE(mapping->view(0, 10).isEmpty());
+}
+
+TEST(MappedFile, resource)
+{
+  // Resources might be compressed and can then only be read into memory.
+  auto mapping = MappedFile::open(":macho_main");
+  ASSERT_NE(mapping, nullptr);
+  EXPECT_GT(mapping->size(), 0);
+
+  QFile f(":macho_main");
+  ASSERT_TRUE(f.open(QIODevice::ReadOnly));
+  EXPECT_EQ(QByteArray(mapping->data(), mapping->size()), f.readAll());
+}
+
+TEST(MappedFile, currentSize)
+{
+  auto file = tempFile("0123456789");
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+  EXPECT_EQ(mapping->currentSize(), 10);
+
+  ASSERT_TRUE(file->resize(4));
+  EXPECT_EQ(mapping->currentSize(), 4);
+  EXPECT_EQ(mapping->size(), 10);
+
+  // Never more than was mapped.
+  ASSERT_TRUE(file->resize(20));
+  EXPECT_EQ(mapping->currentSize(), 10);
+}
+
+TEST(MappedFile, guardTruncation)
+{
+  auto file = tempFile(QByteArray(3 * 4096, 'x'));
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+  const auto view = mapping->view(0, mapping->size());
+
+  // Nothing to do while not truncated.
+  mapping->guardTruncation();
+  EXPECT_EQ(view, QByteArray(3 * 4096, 'x'));
+
+  // Reading past the end of the file no longer faults.
+  ASSERT_TRUE(file->resize(10));
+  mapping->guardTruncation();
+  EXPECT_EQ(mapping->size(), 3 * 4096);
+  EXPECT_EQ(view.left(10), QByteArray(10, 'x'));
+  EXPECT_EQ(view.mid(10), QByteArray(3 * 4096 - 10, '\0'));
+}
+
+TEST(MappedFile, contains)
+{
+  auto file = tempFile("0123456789");
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+
+  EXPECT_TRUE(mapping->contains(0, 10));
+  EXPECT_TRUE(mapping->contains(10, 0));
+  EXPECT_TRUE(mapping->contains(5, 5));
+  EXPECT_FALSE(mapping->contains(5, 6));
+  EXPECT_FALSE(mapping->contains(-1, 1));
+  EXPECT_FALSE(mapping->contains(11, 0));
+}
+
+TEST(MappedFile, view)
+{
+  auto file = tempFile("0123456789");
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+
+  auto view = mapping->view(2, 3);
+  EXPECT_EQ(view, QByteArray("234"));
+
+  // No copy was made.
+  EXPECT_EQ(view.constData(), mapping->data() + 2);
+
+  // Clamped to the end.
+  EXPECT_EQ(mapping->view(8, 100), QByteArray("89"));
+
+  EXPECT_TRUE(mapping->view(10, 1).isEmpty());
+  EXPECT_TRUE(mapping->view(-1, 1).isEmpty());
+  EXPECT_TRUE(mapping->view(0, 0).isEmpty());
+
+  // Modifying a view detaches it from the mapping.
+  view[0] = 'x';
+  EXPECT_EQ(view, QByteArray("x34"));
+  EXPECT_EQ(mapping->view(2, 3), QByteArray("234"));
+}
+
+TEST(MappedFile, reader)
+{
+  auto file = tempFile(QByteArray("\x01\x02\x03\x04", 4));
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+
+  Reader reader(*mapping);
+  bool ok;
+  EXPECT_EQ(reader.getUInt32(&ok), quint32(67305985));
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(reader.atEnd());
+}
+
+TEST(MappedFile, fingerprint)
+{
+  auto file = tempFile("0123456789");
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+
+  const auto fingerprint = mapping->fingerprint();
+  EXPECT_EQ(fingerprint.size(), 40); // Hex SHA-1.
+  EXPECT_EQ(mapping->fingerprint(), fingerprint);
+
+  auto other = tempFile("0123456780");
+  auto otherMapping = MappedFile::open(other->fileName());
+  ASSERT_NE(otherMapping, nullptr);
+  EXPECT_NE(otherMapping->fingerprint(), fingerprint);
+}
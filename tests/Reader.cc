@@ -278,3 +278,171 @@ TEST_F(ReaderTest, getUInt64BigEndian)
   tmp = reader->getUInt64(&ok);
   EXPECT_FALSE(ok);
 }
+
+TEST(Reader, span)
+{
+  const QByteArray data("\x01\x02\x03\x04\x05\x06\x07\x08", 8);
+  Reader reader(data.constData(), data.size());
+  EXPECT_EQ(reader.pos(), 0);
+  EXPECT_FALSE(reader.atEnd());
+
+  bool ok;
+  EXPECT_EQ(reader.getUInt16(&ok), 513);
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(reader.pos(), 2);
+
+  EXPECT_TRUE(reader.peekList({3, 4}));
+  EXPECT_EQ(reader.peekChar(&ok), 3);
+  EXPECT_TRUE(ok);
+
+  reader.setEndianness(Constants::Endianness::Big);
+  EXPECT_EQ(reader.getUInt32(&ok), quint32(0x03040506));
+  EXPECT_TRUE(ok);
+
+  // Only two bytes are left so reading four must fail.
+  reader.getUInt32(&ok);
+  EXPECT_FALSE(ok);
+
+  EXPECT_EQ(reader.read(10), QByteArray("\x07\x08", 2));
+  EXPECT_TRUE(reader.atEnd());
+
+  reader.getChar(&ok);
+  EXPECT_FALSE(ok);
+
+  EXPECT_FALSE(reader.seek(-1));
+  EXPECT_FALSE(reader.seek(9));
+  EXPECT_TRUE(reader.seek(8));
+  EXPECT_TRUE(reader.seek(0));
+  EXPECT_EQ(reader.getUChar(&ok), 1);
+  EXPECT_TRUE(ok);
+}
+
+TEST(Reader, spanReadView)
+{
+  const QByteArray data("abcdef");
+  Reader reader(data.constData(), data.size());
+
+  // The view points directly into the span without copying.
+  const auto view = reader.readView(3);
+  EXPECT_EQ(view, QByteArray("abc"));
+  EXPECT_EQ(view.constData(), data.constData());
+  EXPECT_EQ(reader.pos(), 3);
+
+  EXPECT_EQ(reader.readView(100), QByteArray("def"));
+  EXPECT_TRUE(reader.readView(1).isEmpty());
+}
+
+TEST(Reader, spanEmpty)
+{
+  Reader reader(nullptr, 10);
+  EXPECT_TRUE(reader.atEnd());
+
+  bool ok;
+  reader.getUInt16(&ok);
+  EXPECT_FALSE(ok);
+  EXPECT_TRUE(reader.read(1).isEmpty());
+}
+
+TEST(Reader, getRecord)
+{
+  const QByteArray data("\x01\x02\x03\x04\x05\x06\x07\x08XYZ", 11);
+  Reader reader(data.constData(), data.size());
+
+  Reader::LittleRecord little;
+  ASSERT_TRUE(reader.getRecord(8, little));
+  EXPECT_EQ(little.size(), 8);
+  EXPECT_EQ(little.get<quint16>(0), 0x0201);
+  EXPECT_EQ(little.get<quint32>(4), quint32(0x08070605));
+  EXPECT_EQ(reader.pos(), 8);
+
+  ASSERT_TRUE(reader.seek(0));
+  Reader::BigRecord big;
+  ASSERT_TRUE(reader.getRecord(11, big));
+  EXPECT_EQ(big.get<quint16>(0), 0x0102);
+  EXPECT_EQ(big.get<quint64>(0), quint64(0x0102030405060708));
+  EXPECT_EQ(big.bytes(8, 3), QByteArray("XYZ"));
+
+  // Not enough bytes left.
+  ASSERT_TRUE(reader.seek(4));
+  EXPECT_FALSE(reader.getRecord(8, big));
+}
+
+TEST_F(ReaderTest, getRecord)
+{
+  array.append("\x00\x00\x00\x2A\x01\x00", 6);
+
+  Reader::BigRecord rec;
+  ASSERT_TRUE(reader->getRecord(4, rec));
+  EXPECT_EQ(rec.get<quint32>(0), 42);
+
+  EXPECT_FALSE(reader->getRecord(4, rec));
+
+  Reader::LittleRecord empty;
+  EXPECT_TRUE(reader->getRecord(0, empty));
+  EXPECT_EQ(empty.size(), 0);
+}
+
+TEST(Reader, getUInt32Array)
+{
+  const QByteArray data("\x01\x00\x00\x00\x02\x00\x00\x00\x03\x00\x00\x00", 12);
+  Reader reader(data.constData(), data.size());
+
+  bool ok;
+  auto res = reader.getUInt32Array(3, &ok);
+  ASSERT_TRUE(ok);
+  EXPECT_EQ(res, (std::vector<quint32>{1, 2, 3}));
+  EXPECT_TRUE(reader.atEnd());
+
+  res = reader.getUInt32Array(0, &ok);
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(res.empty());
+
+  ASSERT_TRUE(reader.seek(4));
+  res = reader.getUInt32Array(3, &ok);
+  EXPECT_FALSE(ok);
+  EXPECT_TRUE(res.empty());
+  EXPECT_EQ(reader.pos(), 4);
+}
+
+TEST_F(ReaderTest, getUInt32Array)
+{
+  array.append("\x00\x00\x00\x01\x00\x00\x01\x00", 8);
+  reader->setEndianness(Constants::Endianness::Big);
+
+  bool ok;
+  auto res = reader->getUInt32Array(2, &ok);
+  ASSERT_TRUE(ok);
+  EXPECT_EQ(res, (std::vector<quint32>{1, 256}));
+
+  res = reader->getUInt32Array(1, &ok);
+  EXPECT_FALSE(ok);
+}
+
+TEST(Reader, getUInt16Array)
+{
+  const QByteArray data("\x01\x00\x00\x01", 4);
+  Reader reader(data.constData(), data.size());
+
+  bool ok;
+  EXPECT_EQ(reader.getUInt16Array(2, &ok), (std::vector<quint16>{1, 256}));
+  EXPECT_TRUE(ok);
+
+  ASSERT_TRUE(reader.seek(0));
+  reader.setEndianness(Constants::Endianness::Big);
+  EXPECT_EQ(reader.getUInt16Array(2, &ok), (std::vector<quint16>{256, 1}));
+  EXPECT_TRUE(ok);
+}
+
+TEST(Reader, getUInt64Array)
+{
+  const QByteArray data("\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x02", 16);
+  Reader reader(data.constData(), data.size());
+
+  bool ok;
+  EXPECT_EQ(reader.getUInt64Array(2, &ok),
+            (std::vector<quint64>{1, quint64(0x0200000000000000)}));
+  EXPECT_TRUE(ok);
+
+  reader.getUInt64Array(1, &ok);
+  EXPECT_FALSE(ok);
+}
@@ -2,8 +2,11 @@
 
 #include "testutils.h"
 
+#include <QCryptographicHash>
+
 #include "BinaryObject.h"
 #include "Disassembler.h"
+#include "MappedFile.h"
 #include "Section.h"
 using namespace dispar;
 
@@ -27,6 +30,8 @@ TEST(Section, types)
   EXPECT_EQ((int) Section::Type::LC_VERSION_MIN_IPHONEOS, 9);
   EXPECT_EQ((int) Section::Type::LC_VERSION_MIN_WATCHOS, 10);
   EXPECT_EQ((int) Section::Type::LC_VERSION_MIN_TVOS, 11);
+  EXPECT_EQ((int) Section::Type::OTHER, 12);
+  EXPECT_EQ((int) Section::Type::SEGMENT, 13);
 }
 
 TEST(Section, typeNames)
@@ -43,6 +48,8 @@ TEST(Section, typeNames)
   EXPECT_EQ(Section::typeName(Section::Type::LC_VERSION_MIN_IPHONEOS), "LC_VERSION_MIN_IPHONEOS");
   EXPECT_EQ(Section::typeName(Section::Type::LC_VERSION_MIN_WATCHOS), "LC_VERSION_MIN_WATCHOS");
   EXPECT_EQ(Section::typeName(Section::Type::LC_VERSION_MIN_TVOS), "LC_VERSION_MIN_TVOS");
+  EXPECT_EQ(Section::typeName(Section::Type::OTHER), "Other");
+  EXPECT_EQ(Section::typeName(Section::Type::SEGMENT), "Segment");
 
   // Empty string for unknown type.
   EXPECT_EQ(Section::typeName(Section::Type(-1)), "");
@@ -87,6 +94,50 @@ TEST(Section, data)
   EXPECT_EQ(s.data(), "hello");
 }
 
+TEST(Section, mapData)
+{
+  auto file = tempFile("0123456789");
+  std::weak_ptr<const MappedFile> weak;
+
+  {
+    Section s(Section::Type::TEXT, "test", 0x1, 4, 3);
+
+    {
+      auto mapping = MappedFile::open(file->fileName());
+      ASSERT_NE(mapping, nullptr);
+      weak = mapping;
+      s.mapData(mapping);
+    }
+
+    // The section keeps the mapping alive but doesn't read anything before accessed.
+    ASSERT_FALSE(weak.expired());
+    EXPECT_FALSE(s.isDataLoaded());
+    EXPECT_EQ(s.data(), "3456");
+    EXPECT_TRUE(s.isDataLoaded());
+
+    s.setSubData("x", 1);
+    EXPECT_EQ(s.data(), "3x56");
+    EXPECT_EQ(weak.lock()->view(3, 4), "3456");
+  }
+
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(Section, mapDataSetSubData)
+{
+  auto file = tempFile("0123456789");
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+
+  // Modifying deferred data materializes it first.
+  Section s(Section::Type::TEXT, "test", 0x1, 4, 3);
+  s.mapData(mapping);
+  s.setSubData("x", 0);
+  EXPECT_TRUE(s.isDataLoaded());
+  EXPECT_EQ(s.data(), "x456");
+  EXPECT_TRUE(s.isModified());
+}
+
 TEST(Section, isModified)
 {
   Section s(Section::Type::TEXT, "test", 0x1, 1);
@@ -213,6 +264,17 @@ TEST(Section, setSubData)
   }
 }
 
+TEST(Section, setSubDataClearsInstructionOffsets)
+{
+  Section s(Section::Type::TEXT, "test", 0x1, 4);
+  s.setData("ABCD");
+  s.setInstructionOffsets({0, 2});
+  EXPECT_EQ(s.instructionOffsets().size(), std::size_t(2));
+
+  s.setSubData("X", 1);
+  EXPECT_TRUE(s.instructionOffsets().empty());
+}
+
 TEST(Section, hasAddress)
 {
   Section s(Section::Type::TEXT, "test", 1, 10, 10);
@@ -252,6 +314,72 @@ TEST(Section, setGetDisassembly)
   EXPECT_EQ(count, s.disassembly()->count());
 }
 
+TEST(Section, takeDisassembly)
+{
+  BinaryObject obj(CpuType::X86_64);
+  Disassembler disasm(obj);
+  ASSERT_TRUE(disasm.valid());
+
+  Section s(Section::Type::TEXT, "test", 1, 10, 10);
+  EXPECT_EQ(nullptr, s.takeDisassembly());
+
+  s.setDisassembly(disasm.disassemble(QString("90 90")));
+  auto res = s.takeDisassembly();
+  ASSERT_NE(nullptr, res);
+  EXPECT_EQ(res->count(), std::size_t(2));
+  EXPECT_EQ(nullptr, s.disassembly());
+}
+
+TEST(Section, setSubDataPatchesDisassembly)
+{
+  BinaryObject obj(CpuType::X86_64);
+  Disassembler disasm(obj);
+  ASSERT_TRUE(disasm.valid());
+
+  Section s(Section::Type::TEXT, "test", 0, 3);
+  s.setData(QByteArray("\x90\x90\x90", 3));
+  s.setDisassembly(disasm.disassemble(s.data()));
+  ASSERT_NE(nullptr, s.disassembly());
+  EXPECT_FALSE(s.disassembly()->isPatched());
+
+  // push rbp; ret
+  s.setSubData(QByteArray("\x55\xc3", 2), 1);
+  EXPECT_TRUE(s.disassembly()->isPatched());
+
+  disasm.redisassemble(*s.disassembly());
+  EXPECT_EQ(s.disassembly()->toString(), disasm.disassemble(s.data())->toString());
+}
+
+TEST(Section, hash)
+{
+  Section s(Section::Type::TEXT, "test", 0, 3);
+  s.setData("abc");
+
+  const auto hash = s.hash();
+  EXPECT_EQ(hash, QCryptographicHash::hash("abc", QCryptographicHash::Sha1));
+  EXPECT_EQ(s.hash(), hash);
+
+  s.setSubData("x", 1);
+  EXPECT_EQ(s.hash(), QCryptographicHash::hash("axc", QCryptographicHash::Sha1));
+
+  s.setData("abc");
+  EXPECT_EQ(s.hash(), hash);
+}
+
+TEST(Section, hashMapped)
+{
+  auto file = tempFile("0123456789");
+  auto mapping = MappedFile::open(file->fileName());
+  ASSERT_NE(mapping, nullptr);
+
+  // Mapped data is hashed as in the file, regardless of modifications.
+  Section s(Section::Type::TEXT, "test", 0x1, 4, 3);
+  s.mapData(mapping);
+  s.setSubData("x", 1);
+  const auto hash = QCryptographicHash::hash("3456", QCryptographicHash::Sha1);
+  EXPECT_EQ(s.hash(), hash);
+}
+
 TEST(SectionModifiedRegion, operatorEquals)
 {
   const Section::ModifiedRegion r{0, "x"}, r2{20, "xyz"}, r3{0, "y"};
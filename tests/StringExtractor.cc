@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include "StringExtractor.h"
+using namespace dispar;
+
+namespace {
+
+using Encoding = StringExtractor::Encoding;
+
+std::vector<QString> strings(const QByteArray &data,
+                             const std::vector<StringExtractor::Entry> &entries)
+{
+  std::vector<QString> res;
+  for (const auto &entry : entries) {
+    res.push_back(StringExtractor::string(data, entry));
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(StringExtractor, ascii)
+{
+  const QByteArray data("\x01hello\xff\0ab\0\0tab\there\x7f", 21);
+  const StringExtractor extractor(4, Encoding::ASCII);
+  const auto entries = extractor.extract(data);
+  ASSERT_EQ(entries.size(), std::size_t(2));
+  EXPECT_EQ(entries[0], (StringExtractor::Entry{1, 5, Encoding::ASCII}));
+  EXPECT_EQ(entries[1], (StringExtractor::Entry{12, 8, Encoding::ASCII}));
+  EXPECT_EQ(strings(data, entries), (std::vector<QString>{"hello", "tab\there"}));
+
+  // Shorter strings with a lower minimum length.
+  EXPECT_EQ(strings(data, StringExtractor(2, Encoding::ASCII).extract(data)),
+            (std::vector<QString>{"hello", "ab", "tab\there"}));
+
+  EXPECT_TRUE(extractor.extract(QByteArray()).empty());
+}
+
+TEST(StringExtractor, utf16)
+{
+  // "text" in little-endian at an odd offset and "word" in big-endian.
+  const QByteArray data("\x01t\0e\0x\0t\0\x01\0w\0o\0r\0d\x01", 19);
+
+  const auto le = StringExtractor(4, Encoding::UTF16_LE).extract(data);
+  ASSERT_EQ(le.size(), std::size_t(1));
+  EXPECT_EQ(le[0], (StringExtractor::Entry{1, 4, Encoding::UTF16_LE}));
+  EXPECT_EQ(StringExtractor::string(data, le[0]), "text");
+
+  // Read as big-endian, "text" is only "ext" which is too short.
+  const auto be = StringExtractor(4, Encoding::UTF16_BE).extract(data);
+  ASSERT_EQ(be.size(), std::size_t(1));
+  EXPECT_EQ(be[0], (StringExtractor::Entry{10, 4, Encoding::UTF16_BE}));
+  EXPECT_EQ(StringExtractor::string(data, be[0]), "word");
+
+  // Not ASCII strings since every other byte is zero.
+  EXPECT_TRUE(StringExtractor(4, Encoding::ASCII).extract(data).empty());
+}
+
+TEST(StringExtractor, chunks)
+{
+  // Large enough to be split into chunks, with strings crossing chunk boundaries.
+  QByteArray data;
+  std::vector<QString> expected;
+  for (int i = 0; data.size() < 4 * StringExtractor::minChunkSize; i++) {
+    const QString string(i % 50 + 1, QChar('a' + i % 26));
+    data.append(string.toLatin1());
+    data.append(QByteArray(i % 5 + 1, '\x80'));
+    if (string.size() >= 4) {
+      expected.push_back(string);
+    }
+  }
+
+  const auto entries = StringExtractor(4, Encoding::ASCII).extract(data);
+  EXPECT_EQ(strings(data, entries), expected);
+  for (std::size_t i = 1; i < entries.size(); i++) {
+    EXPECT_LT(entries[i - 1].offset, entries[i].offset);
+  }
+}
+
+TEST(StringExtractor, canceled)
+{
+  const QByteArray data(4 * StringExtractor::minChunkSize, 'a');
+  const StringExtractor extractor(4, Encoding::ASCII);
+
+  std::atomic_bool canceled{false};
+  EXPECT_EQ(extractor.extract(data, &canceled).size(), std::size_t(1));
+
+  canceled = true;
+  EXPECT_TRUE(extractor.extract(data, &canceled).empty());
+}
@@ -88,6 +88,24 @@ TEST(Util, demangle)
   res = Util::demangle(".__Znam");
   EXPECT_EQ("operator new[](unsigned long)", res) << res;
 }
+
+TEST(Util, demangleAll)
+{
+  const std::vector<QString> some{"__ZSt9terminatev", "", "_main", "__ZdlPv", "$__Znam"};
+
+  // Enough names to be split among threads.
+  std::vector<QString> names;
+  for (int i = 0; i < 5000; i++) {
+    names.push_back(some[i % some.size()]);
+  }
+
+  const auto res = Util::demangleAll(names);
+  ASSERT_EQ(res.size(), names.size());
+  for (std::size_t i = 0; i < names.size(); i++) {
+    EXPECT_EQ(res[i], Util::demangle(names[i])) << i;
+  }
+  EXPECT_TRUE(Util::demangleAll({}).empty());
+}
 #endif
 
 TEST(Util, convertAddress)
@@ -323,6 +341,38 @@ TEST(Util, hexToData)
   EXPECT_EQ(QByteArray(), data) << data;
 }
 
+TEST(Util, hexToDataEdgeCases)
+{
+  EXPECT_EQ(QByteArray(), Util::hexToData(""));
+  EXPECT_EQ(QByteArray("\xAB\xCD"), Util::hexToData("AbcD"));
+
+  // A lone trailing digit is a byte of its own.
+  EXPECT_EQ(QByteArray("\xAB\x0C"), Util::hexToData("abc"));
+
+  // Whitespace and characters beyond Latin-1 aren't hex digits.
+  EXPECT_EQ(QByteArray(), Util::hexToData("01 23"));
+  EXPECT_EQ(QByteArray(), Util::hexToData(QString("01") + QChar(0x0130)));
+  EXPECT_EQ(QByteArray(), Util::hexToData(QString("0") + QChar(0x00FF)));
+}
+
+TEST(Util, hexRoundTrip)
+{
+  QByteArray all(256, 0);
+  for (int i = 0; i < all.size(); i++) {
+    all[i] = char(i);
+  }
+  const auto *bytes = reinterpret_cast<const unsigned char *>(all.constData());
+
+  for (const bool uppercase : {false, true}) {
+    const auto hex = Util::bytesToHex(bytes, all.size(), 0, uppercase);
+    EXPECT_EQ(QString::fromLatin1(uppercase ? all.toHex().toUpper() : all.toHex()), hex);
+    EXPECT_EQ(all, Util::hexToData(hex));
+  }
+
+  EXPECT_EQ(QString::fromLatin1(all.toHex()), Util::byteArrayString(all));
+  EXPECT_EQ(all, Util::byteArray(Util::byteArrayString(all)));
+}
+
 TEST(Util, hexToString)
 {
   auto data = Util::hexToString("0123456789abcdef");
@@ -342,4 +392,41 @@ TEST(Util, bytesToHex)
   EXPECT_EQ(QString("01 23"), data) << data;
   data = Util::bytesToHex(input, 3);
   EXPECT_EQ(QString("01 23 45"), data) << data;
+
+  EXPECT_EQ(QString(), Util::bytesToHex(input, 0));
+  EXPECT_EQ(QString("012345"), Util::bytesToHex(input, 3, 0));
+
+  const auto *input2 = (unsigned char*) "\xAB\xCD\xEF";
+  EXPECT_EQ(QString("ab:cd:ef"), Util::bytesToHex(input2, 3, ':'));
+  EXPECT_EQ(QString("AB CD EF"), Util::bytesToHex(input2, 3, ' ', true));
+}
+
+TEST(Util, decodeUleb128)
+{
+  bool ok = false;
+  auto values = Util::decodeUleb128(QByteArray("\x02\x7f\x80\x01\xe5\x8e\x26", 7), &ok);
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(values, (std::vector<quint64>{2, 127, 128, 624485}));
+
+  // More values than fit in a word.
+  QByteArray data;
+  std::vector<quint64> expected;
+  for (quint64 i = 0; i < 20; i++) {
+    data.append(static_cast<char>(i));
+    expected.push_back(i);
+  }
+  data.append("\xff\xff\xff\xff\x0f", 5);
+  expected.push_back(0xffffffff);
+  values = Util::decodeUleb128(data, &ok);
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(values, expected);
+
+  // Truncated.
+  values = Util::decodeUleb128(QByteArray("\x01\x80", 2), &ok);
+  EXPECT_FALSE(ok);
+  EXPECT_EQ(values, (std::vector<quint64>{1}));
+
+  values = Util::decodeUleb128(QByteArray(), &ok);
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(values.empty());
 }
@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "testutils.h"
+
+#include <QByteArray>
+
+#include "X86LengthDecoder.h"
+using namespace dispar;
+
+namespace {
+
+int length(const X86LengthDecoder &decoder, const QByteArray &code)
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return decoder.length(reinterpret_cast<const unsigned char *>(code.constData()), code.size());
+}
+
+} // namespace
+
+TEST(X86LengthDecoder, x64)
+{
+  const X86LengthDecoder decoder(true);
+
+  EXPECT_EQ(length(decoder, QByteArray("\x55", 1)), 1);                     // push rbp
+  EXPECT_EQ(length(decoder, QByteArray("\x48\x89\xe5", 3)), 3);             // mov rbp, rsp
+  EXPECT_EQ(length(decoder, QByteArray("\x48\x83\xec\x70", 4)), 4);         // sub rsp, 0x70
+  EXPECT_EQ(length(decoder, QByteArray("\xc7\x45\xfc\x00\x00\x00\x00", 7)), 7); // mov [rbp-4], 0
+  EXPECT_EQ(length(decoder, QByteArray("\xe8\x00\x00\x00\x00", 5)), 5);     // call
+  EXPECT_EQ(length(decoder, QByteArray("\x0f\x84\x10\x00\x00\x00", 6)), 6); // je
+  EXPECT_EQ(length(decoder, QByteArray("\x48\xb8\1\2\3\4\5\6\7\x08", 10)), 10); // movabs rax
+  EXPECT_EQ(length(decoder, QByteArray("\x48\x8b\x05\0\0\0\0", 7)), 7); // mov rax, [rip]
+  EXPECT_EQ(length(decoder, QByteArray("\x8b\x44\x24\x08", 4)), 4);     // mov eax, [rsp+8]
+  EXPECT_EQ(length(decoder, QByteArray("\x66\x0f\x1f\x44\x00\x00", 6)), 6); // nop word
+  EXPECT_EQ(length(decoder, QByteArray("\xf3\x0f\x1e\xfa", 4)), 4);         // endbr64
+  EXPECT_EQ(length(decoder, QByteArray("\xf6\x40\x08\x01", 4)), 4);     // test byte [rax+8], 1
+  EXPECT_EQ(length(decoder, QByteArray("\xc5\xf8\x77", 3)), 3);         // vzeroupper
+  EXPECT_EQ(length(decoder, QByteArray("\xc4\xe3\x79\x14\xc0\x01", 6)), 6); // vpextrb eax, xmm0, 1
+  EXPECT_EQ(length(decoder, QByteArray("\x62\xf1\x7c\x48\x10\x00", 6)), 6); // vmovups zmm0, [rax]
+
+  // Invalid in 64-bit mode and truncated.
+  EXPECT_EQ(length(decoder, QByteArray("\x06", 1)), 0);
+  EXPECT_EQ(length(decoder, QByteArray("\x48\x83\xec", 3)), 0);
+  EXPECT_EQ(length(decoder, QByteArray()), 0);
+
+  // Longer than the maximum.
+  EXPECT_EQ(length(decoder, QByteArray(15, '\x66') + QByteArray("\x90", 1)), 0);
+}
+
+TEST(X86LengthDecoder, x86)
+{
+  const X86LengthDecoder decoder(false);
+
+  EXPECT_EQ(length(decoder, QByteArray("\x48", 1)), 1);                 // dec eax
+  EXPECT_EQ(length(decoder, QByteArray("\x83\xec\x70", 3)), 3);         // sub esp, 0x70
+  EXPECT_EQ(length(decoder, QByteArray("\x06", 1)), 1);                 // push es
+  EXPECT_EQ(length(decoder, QByteArray("\xa1\0\0\0\0", 5)), 5);         // mov eax, [moffs32]
+  EXPECT_EQ(length(decoder, QByteArray("\x66\xb8\1\2", 4)), 4);         // mov ax, imm16
+  EXPECT_EQ(length(decoder, QByteArray("\x67\x8b\x46\x02", 4)), 4);     // mov eax, [bp+2]
+  EXPECT_EQ(length(decoder, QByteArray("\xc4\x02", 2)), 2);             // les eax, [edx]
+  EXPECT_EQ(length(decoder, QByteArray("\x9a\0\0\0\0\0\0", 7)), 7);     // call far
+}
@@ -30,6 +30,31 @@ TEST(Format, detect)
   EXPECT_EQ(fmt->type(), Format::Type::MACH_O);
 }
 
+TEST(Format, detectParse)
+{
+  // The detected format parses without opening the file again.
+  auto fmt = Format::detect(":macho_main_32_64");
+  ASSERT_NE(fmt, nullptr);
+  ASSERT_TRUE(fmt->parse());
+  EXPECT_EQ(fmt->summaries().size(), 2);
+
+  auto file = tempFile("hello there, man");
+  EXPECT_EQ(Format::detect(file->fileName()), nullptr);
+
+  file = tempFile("h");
+  EXPECT_EQ(Format::detect(file->fileName()), nullptr);
+}
+
+TEST(Format, typeFromMagic)
+{
+  for (const quint32 magic :
+       {0xFEEDFACE, 0xFEEDFACF, 0xECAFDEEF, 0xFCAFDEEF, 0xCAFEBABE, 0xBEBAFECA}) {
+    EXPECT_EQ(Format::typeFromMagic(magic), Format::Type::MACH_O);
+  }
+  EXPECT_FALSE(Format::typeFromMagic(0));
+  EXPECT_FALSE(Format::typeFromMagic(0x464C457F));
+}
+
 TEST(Format, write)
 {
   auto format = std::make_shared<MachO>(":macho_main");
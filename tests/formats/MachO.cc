@@ -106,12 +106,14 @@ TEST(MachO, parse)
     EXPECT_EQ(objs[0]->cpuType(), CpuType::X86_64);
     EXPECT_EQ(objs[0]->fileType(), FileType::EXECUTE);
     const auto secs = objs[0]->sections();
-    ASSERT_EQ(5, secs.size());
+    ASSERT_EQ(7, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[1]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[2]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[3]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[4]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[1]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[2]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[3]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[4]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[5]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[6]->type());
   }
 
   {
@@ -122,11 +124,13 @@ TEST(MachO, parse)
     EXPECT_EQ(objs[0]->cpuType(), CpuType::X86_64);
     EXPECT_EQ(objs[0]->fileType(), FileType::OBJECT);
     const auto secs = objs[0]->sections();
-    ASSERT_EQ(4, secs.size());
+    ASSERT_EQ(6, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[1]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[2]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[3]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[1]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[2]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[3]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[4]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[5]->type());
   }
 
   {
@@ -137,12 +141,14 @@ TEST(MachO, parse)
     EXPECT_EQ(objs[0]->cpuType(), CpuType::X86);
     EXPECT_EQ(objs[0]->fileType(), FileType::EXECUTE);
     const auto secs = objs[0]->sections();
-    ASSERT_EQ(5, secs.size());
+    ASSERT_EQ(7, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[1]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[2]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[3]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[4]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[1]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[2]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[3]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[4]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[5]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[6]->type());
   }
 
   {
@@ -168,22 +174,26 @@ TEST(MachO, parse)
     EXPECT_EQ(objs[0]->cpuType(), CpuType::X86);
     EXPECT_EQ(objs[0]->fileType(), FileType::EXECUTE);
     auto secs = objs[0]->sections();
-    ASSERT_EQ(5, secs.size());
+    ASSERT_EQ(7, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[1]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[2]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[3]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[4]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[1]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[2]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[3]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[4]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[5]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[6]->type());
 
     EXPECT_EQ(objs[1]->cpuType(), CpuType::X86_64);
     EXPECT_EQ(objs[1]->fileType(), FileType::EXECUTE);
     secs = objs[1]->sections();
-    ASSERT_EQ(5, secs.size());
+    ASSERT_EQ(7, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[1]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[2]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[3]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[4]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[1]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[2]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[3]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[4]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[5]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[6]->type());
   }
 
   {
@@ -194,12 +204,14 @@ TEST(MachO, parse)
     EXPECT_EQ(objs[0]->cpuType(), CpuType::X86_64);
     EXPECT_EQ(objs[0]->fileType(), FileType::EXECUTE);
     const auto secs = objs[0]->sections();
-    ASSERT_EQ(5, secs.size());
+    ASSERT_EQ(7, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[1]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[2]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[3]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[4]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[1]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[2]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[3]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[4]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[5]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[6]->type());
   }
 
   {
@@ -220,15 +232,21 @@ TEST(MachO, parse)
     EXPECT_EQ(strings[1], "second");
 
     const auto secs = objs[0]->sections();
-    ASSERT_EQ(8, secs.size());
+    ASSERT_EQ(14, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
     EXPECT_EQ(Section::Type::SYMBOL_STUBS, secs[1]->type());
-    EXPECT_EQ(Section::Type::CSTRING, secs[2]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[3]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[4]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[5]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[6]->type());
-    EXPECT_EQ(Section::Type::DYN_SYMBOLS, secs[7]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[2]->type());
+    EXPECT_EQ(Section::Type::CSTRING, secs[3]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[4]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[5]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[6]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[7]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[8]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[9]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[10]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[11]->type());
+    EXPECT_EQ(Section::Type::DYN_SYMBOLS, secs[12]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[13]->type());
   }
 
   {
@@ -239,16 +257,30 @@ TEST(MachO, parse)
     EXPECT_EQ(objs[0]->cpuType(), CpuType::X86_64);
     EXPECT_EQ(objs[0]->fileType(), FileType::EXECUTE);
     const auto secs = objs[0]->sections();
-    ASSERT_EQ(9, secs.size());
+    ASSERT_EQ(23, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
     EXPECT_EQ(Section::Type::SYMBOL_STUBS, secs[1]->type());
-    EXPECT_EQ(Section::Type::CSTRING, secs[2]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[2]->type());
     EXPECT_EQ(Section::Type::CSTRING, secs[3]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[4]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[5]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[6]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[7]->type());
-    EXPECT_EQ(Section::Type::DYN_SYMBOLS, secs[8]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[4]->type());
+    EXPECT_EQ(Section::Type::CSTRING, secs[5]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[6]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[7]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[8]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[9]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[10]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[11]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[12]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[13]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[14]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[15]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[16]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[17]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[18]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[19]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[20]->type());
+    EXPECT_EQ(Section::Type::DYN_SYMBOLS, secs[21]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[22]->type());
   }
 
   {
@@ -259,11 +291,158 @@ TEST(MachO, parse)
     EXPECT_EQ(objs[0]->cpuType(), CpuType::X86_64);
     EXPECT_EQ(objs[0]->fileType(), FileType::DYLIB);
     const auto secs = objs[0]->sections();
-    ASSERT_EQ(5, secs.size());
+    ASSERT_EQ(7, secs.size());
     EXPECT_EQ(Section::Type::TEXT, secs[0]->type());
-    EXPECT_EQ(Section::Type::STRING, secs[1]->type());
-    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[2]->type());
-    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[3]->type());
-    EXPECT_EQ(Section::Type::SYMBOLS, secs[4]->type());
+    EXPECT_EQ(Section::Type::OTHER, secs[1]->type());
+    EXPECT_EQ(Section::Type::STRING, secs[2]->type());
+    EXPECT_EQ(Section::Type::LC_VERSION_MIN_MACOSX, secs[3]->type());
+    EXPECT_EQ(Section::Type::FUNC_STARTS, secs[4]->type());
+    EXPECT_EQ(Section::Type::SYMBOLS, secs[5]->type());
+    EXPECT_EQ(Section::Type::SEGMENT, secs[6]->type());
+  }
+}
+
+TEST(MachO, parseFatSymbols)
+{
+  // Symbol tables are relative to each object file of the universal binary.
+  MachO fmt(":macho_main_32_64");
+  ASSERT_TRUE(fmt.parse());
+  const auto objs = fmt.objects();
+  ASSERT_EQ(objs.size(), 2);
+
+  for (const auto *obj : objs) {
+    const auto &symbols = obj->symbolTable().symbols();
+    ASSERT_EQ(symbols.size(), 3);
+    EXPECT_EQ(symbols[0].string(), "__mh_execute_header");
+    EXPECT_EQ(symbols[1].string(), "_main");
+    EXPECT_EQ(symbols[2].string(), "dyld_stub_binder");
+  }
+  EXPECT_EQ(objs[0]->systemBits(), 32);
+  EXPECT_EQ(objs[1]->systemBits(), 64);
+}
+
+TEST(MachO, summaries)
+{
+  MachO fmt(":macho_main_32_64");
+  ASSERT_TRUE(fmt.parse());
+
+  const auto summaries = fmt.summaries();
+  ASSERT_EQ(summaries.size(), 2);
+  EXPECT_EQ(summaries[0].cpuType, CpuType::X86);
+  EXPECT_EQ(summaries[0].systemBits, 32);
+  EXPECT_EQ(summaries[0].fileType, FileType::EXECUTE);
+  EXPECT_EQ(summaries[0].offset, 4096);
+  EXPECT_EQ(summaries[1].cpuType, CpuType::X86_64);
+  EXPECT_EQ(summaries[1].systemBits, 64);
+  EXPECT_EQ(summaries[1].fileType, FileType::EXECUTE);
+  EXPECT_EQ(summaries[1].offset, 12288);
+
+  // Nothing is parsed until accessed.
+  EXPECT_TRUE(fmt.parsedObjects().isEmpty());
+}
+
+TEST(MachO, object)
+{
+  MachO fmt(":macho_main_32_64");
+  ASSERT_TRUE(fmt.parse());
+
+  EXPECT_EQ(fmt.object(-1), nullptr);
+  EXPECT_EQ(fmt.object(2), nullptr);
+
+  // Only the requested object is parsed.
+  auto *obj = fmt.object(1);
+  ASSERT_NE(obj, nullptr);
+  EXPECT_EQ(obj->cpuType(), CpuType::X86_64);
+  EXPECT_EQ(obj->systemBits(), 64);
+  EXPECT_EQ(fmt.object(1), obj);
+
+  auto parsed = fmt.parsedObjects();
+  ASSERT_EQ(parsed.size(), 1);
+  EXPECT_EQ(parsed[0], obj);
+
+  // Accessing all objects parses the rest while keeping the order.
+  const auto objs = fmt.objects();
+  ASSERT_EQ(objs.size(), 2);
+  EXPECT_EQ(objs[0]->cpuType(), CpuType::X86);
+  EXPECT_EQ(objs[1], obj);
+  EXPECT_EQ(fmt.parsedObjects().size(), 2);
+}
+
+TEST(MachO, failedObjects)
+{
+  QFile res(":macho_main_32_64");
+  ASSERT_TRUE(res.open(QIODevice::ReadOnly));
+  auto data = res.readAll();
+
+  // Make the first load command of the 32-bit object, after its header of 28 bytes, obsolete.
+  const int cmd = 4096 + 28;
+  data[cmd] = 0x3;
+  data[cmd + 1] = data[cmd + 2] = data[cmd + 3] = 0;
+  auto file = tempFile(data);
+
+  // Only headers are read when parsing, so it still succeeds.
+  MachO fmt(file->fileName());
+  ASSERT_TRUE(fmt.parse());
+  EXPECT_TRUE(fmt.failedObjects().isEmpty());
+
+  const auto objs = fmt.objects();
+  ASSERT_EQ(objs.size(), 1);
+  EXPECT_EQ(objs[0]->systemBits(), 64);
+  EXPECT_EQ(fmt.failedObjects(), QList<int>{0});
+  EXPECT_TRUE(fmt.toString().contains("Object 0 failed to parse!"));
+}
+
+TEST(MachO, parseAllSections)
+{
+  MachO fmt(":macho_strings");
+  ASSERT_TRUE(fmt.parse());
+  auto *obj = fmt.object(0);
+  ASSERT_NE(obj, nullptr);
+
+  const auto others = obj->sectionsByType(Section::Type::OTHER);
+  ASSERT_EQ(others.size(), 5);
+  EXPECT_EQ(others[0]->name(), "__TEXT,__stub_helper");
+  EXPECT_EQ(others[1]->name(), "__TEXT,__unwind_info");
+  EXPECT_EQ(others[2]->name(), "__DATA,__nl_symbol_ptr");
+  EXPECT_EQ(others[3]->name(), "__DATA,__la_symbol_ptr");
+  EXPECT_EQ(others[4]->name(), "__DATA,__data");
+
+  // Only the part of __LINKEDIT that no other section covers, the dyld info, is exposed.
+  const auto *linkedit = obj->section(Section::Type::SEGMENT);
+  ASSERT_NE(linkedit, nullptr);
+  EXPECT_EQ(linkedit->name(), "__LINKEDIT");
+  EXPECT_EQ(linkedit->size(), 280);
+  for (const auto *sec : obj->sections()) {
+    if (sec == linkedit) continue;
+    EXPECT_FALSE(sec->offset() < linkedit->offset() + linkedit->size() &&
+                 linkedit->offset() < sec->offset() + sec->size())
+      << sec->toString().toStdString();
+  }
+
+  // Section data is only read on first access. The string table was read to name the symbols, and
+  // function starts were decoded.
+  for (const auto *sec : obj->sections()) {
+    if (sec->type() != Section::Type::STRING && sec->type() != Section::Type::FUNC_STARTS) {
+      EXPECT_FALSE(sec->isDataLoaded()) << sec->toString().toStdString();
+    }
+  }
+  EXPECT_EQ(others[4]->data().size(), others[4]->size());
+  EXPECT_TRUE(others[4]->isDataLoaded());
+}
+
+TEST(MachO, functionStarts)
+{
+  const QList<QPair<QString, std::vector<quint64>>> expected{
+    {":macho_func", {0x100000f70, 0x100000f90}},
+    {":macho_main", {0x100000fa0}},
+    {":macho_main_32", {0x1fa0}},
+    {":macho_lib.dylib", {0xfa0}},
+  };
+  for (const auto &pair : expected) {
+    MachO fmt(pair.first);
+    ASSERT_TRUE(fmt.parse()) << pair.first;
+    auto *obj = fmt.object(0);
+    ASSERT_NE(obj, nullptr);
+    EXPECT_EQ(obj->functionStarts(), pair.second) << pair.first;
   }
 }